@@ -1,9 +1,47 @@
 #!/usr/bin/env python3
 
+'''
+Generate the emoji tables of emoji::Provider.
+
+e.g ./emoji_codegen.py ../resources/emoji.json > ../src/emoji/Tables.cpp
+'''
+
 import sys
 import json
 
-from jinja2 import Template
+
+LICENSE = '''/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */'''
+
+CATEGORIES = [
+    'people',
+    'nature',
+    'food',
+    'activity',
+    'travel',
+    'objects',
+    'symbols',
+    'flags',
+]
+
+SKIN_TONES = ['1f3fb', '1f3fc', '1f3fd', '1f3fe', '1f3ff']
+
+# Number of shortname indices on each line of the generated file.
+INDICES_PER_LINE = 12
 
 
 class Emoji(object):
@@ -16,24 +54,60 @@ class Emoji(object):
 
 def code_to_bytes(codepoint):
     '''
-    Convert hex unicode codepoint to hex byte array.
-    '''
-    bytes = chr(int(codepoint, 16)).encode('utf-8')
-
-    return str(bytes)[1:].strip("'")
+    Convert hex unicode codepoint to escaped UTF-8 bytes.
 
+    Every byte is escaped, so that a plain character can't extend the
+    hex escape in front of it.
+    '''
+    return ''.join('\\x{:02x}'.format(b) for b in chr(int(codepoint, 16)).encode('utf-8'))
 
-def generate_code(emojis, category):
-    tmpl = Template('''
-const QList<Emoji> EmojiProvider::{{ category }} = {
-    {%- for e in emoji %}
-        Emoji{QString::fromUtf8("{{ e.code }}"), "{{ e.shortname }}"},
-    {%- endfor %}
-};
-    ''')
 
-    d = dict(category=category, emoji=emojis)
-    print(tmpl.render(d))
+def generate_code(emojis):
+    '''
+    The emoji are laid out by category in a single constexpr array, so the
+    tables are constant-initialized and cost nothing at startup.
+    '''
+    lines = [LICENSE, '']
+    lines.append('// Generated by scripts/emoji_codegen.py from resources/emoji.json.')
+    lines.append('')
+    lines.append('#include "emoji/Provider.h"')
+    lines.append('')
+    lines.append('using namespace emoji;')
+    lines.append('')
+    lines.append('namespace {')
+    lines.append('constexpr Emoji emojis[] = {')
+
+    for e in emojis:
+        lines.append('  Emoji{{"{}", "{}"}},'.format(e.code, e.shortname))
+
+    lines.append('};')
+    lines.append('}')
+    lines.append('')
+
+    start = 0
+    width = max(map(len, CATEGORIES))
+    for category in CATEGORIES:
+        count = len([e for e in emojis if e.category == category])
+        lines.append('const EmojiRange Provider::{} = {{emojis + {}, emojis + {}}};'.format(
+            category.ljust(width), start, start + count))
+        start += count
+
+    lines.append('')
+    lines.append('const EmojiRange Provider::all = {{emojis, emojis + {}}};'.format(len(emojis)))
+    lines.append('')
+
+    index = sorted(range(len(emojis)), key=lambda i: emojis[i].shortname)
+
+    lines.append('const std::uint16_t Provider::shortnameIndex[] = {')
+    for i in range(0, len(index), INDICES_PER_LINE):
+        chunk = index[i:i + INDICES_PER_LINE]
+        lines.append('  ' + ', '.join(map(str, chunk)) + ',')
+    lines.append('};')
+    lines.append('')
+    lines.append('const std::size_t Provider::shortnameIndexSize =')
+    lines.append('  sizeof(shortnameIndex) / sizeof(shortnameIndex[0]);')
+
+    print('\n'.join(lines))
 
 
 if __name__ == '__main__':
@@ -57,6 +131,13 @@ if __name__ == '__main__':
         if l > 1 and tmp['category'] == 'people':
             continue
 
+        # Skin tone variations.
+        if any(c in SKIN_TONES for c in tmp['unicode'].split('-')):
+            continue
+
+        if tmp['category'] not in CATEGORIES:
+            continue
+
         emojis.append(
             Emoji(
                 tmp['unicode'],
@@ -66,24 +147,9 @@ if __name__ == '__main__':
             )
         )
 
-    emojis.sort(key=lambda x: x.order)
-
-    people = list(filter(lambda x: x.category == "people", emojis))
-    nature = list(filter(lambda x: x.category == "nature", emojis))
-    food = list(filter(lambda x: x.category == "food", emojis))
-    activity = list(filter(lambda x: x.category == "activity", emojis))
-    travel = list(filter(lambda x: x.category == "travel", emojis))
-    objects = list(filter(lambda x: x.category == "objects", emojis))
-    symbols = list(filter(lambda x: x.category == "symbols", emojis))
-    flags = list(filter(lambda x: x.category == "flags", emojis))
-
-    # Use xclip to pipe the output to clipboard.
-    # e.g ./codegen.py emoji.json | xclip -sel clip
-    generate_code(people, 'people')
-    generate_code(nature, 'nature')
-    generate_code(food, 'food')
-    generate_code(activity, 'activity')
-    generate_code(travel, 'travel')
-    generate_code(objects, 'objects')
-    generate_code(symbols, 'symbols')
-    generate_code(flags, 'flags')
+    emojis.sort(key=lambda x: (CATEGORIES.index(x.category), x.order))
+
+    if len(emojis) > 0xffff:
+        sys.exit('too many emoji for the 16 bit shortname index')
+
+    generate_code(emojis)
@@ -0,0 +1,36 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AsyncCache.h"
+
+//! Reads are short, so a couple of threads keep the UI responsive
+//! without competing with the sync for the CPU.
+constexpr int MAX_READ_THREADS = 2;
+
+namespace cache {
+QThreadPool *
+readPool()
+{
+        static QThreadPool *pool = []() {
+                auto p = new QThreadPool;
+                p->setMaxThreadCount(MAX_READ_THREADS);
+                return p;
+        }();
+
+        return pool;
+}
+}
@@ -0,0 +1,75 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QtConcurrent>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+#include "Cache.h"
+#include "Logging.h"
+
+namespace cache {
+//! The executor that runs the cache reads issued by the UI.
+QThreadPool *
+readPool();
+
+//! Run `query` against the cache on the read pool and hand its result to `callback`
+//! on the thread of `receiver`.
+//!
+//! Nothing is delivered once the receiver is destroyed, and queries that haven't
+//! started by then are skipped.
+template<typename Query, typename Callback>
+auto
+read(QObject *receiver, Query query, Callback callback)
+  -> QFuture<typename std::result_of<Query(Cache *)>::type>
+{
+        using Result = typename std::result_of<Query(Cache *)>::type;
+
+        auto cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        // The watcher is owned by the receiver and doesn't outlive it.
+        auto watcher = new QFutureWatcher<Result>(receiver);
+        QObject::connect(watcher, &QObject::destroyed, [cancelled]() { *cancelled = true; });
+        QObject::connect(watcher, &QFutureWatcherBase::finished, receiver, [watcher, callback]() {
+                callback(watcher->result());
+                watcher->deleteLater();
+        });
+
+        auto future = QtConcurrent::run(readPool(), [cancelled, query]() -> Result {
+                if (*cancelled || !cache::client())
+                        return Result();
+
+                try {
+                        return query(cache::client());
+                } catch (const lmdb::error &e) {
+                        nhlog::db()->warn("failed to read from the cache: {}", e.what());
+                }
+
+                return Result();
+        });
+
+        watcher->setFuture(future);
+
+        return future;
+}
+}
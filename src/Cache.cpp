@@ -15,6 +15,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
 
@@ -23,6 +24,7 @@
 #include <QHash>
 #include <QSettings>
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 #include <boost/variant.hpp>
 #include <mtx/responses/common.hpp>
@@ -32,7 +34,9 @@
 
 //! Should be changed when a breaking change occurs in the cache format.
 //! This will reset client's data.
-static const std::string CURRENT_CACHE_FORMAT_VERSION("2018.09.21");
+static const std::string CURRENT_CACHE_FORMAT_VERSION("2018.10.14");
+//! The messages were keyed by their timestamp alone. That format is upgraded in place.
+static const std::string TIMESTAMP_KEYS_CACHE_FORMAT_VERSION("2018.09.21");
 static const std::string SECRET("secret");
 
 static const lmdb::val NEXT_BATCH_KEY("next_batch");
@@ -41,9 +45,41 @@ static const lmdb::val CACHE_FORMAT_VERSION_KEY("cache_format_version");
 
 constexpr size_t MAX_RESTORED_MESSAGES = 30;
 
+//! Default limit on the messages kept per room. They back the history of the timeline.
+constexpr size_t DEFAULT_MAX_STORED_MESSAGES = 5000;
+//! How long the markers of sent notifications are kept.
+constexpr std::chrono::hours NOTIFICATION_RETENTION(24 * 7);
+//! Amount of media downloaded before the media are checked against their budget.
+constexpr std::size_t MEDIA_SWEEP_THRESHOLD = 4UL * 1024UL * 1024UL; // 4 MB
+//! Budget of the media database. Orphaned media are dropped once it's exceeded.
+constexpr std::size_t MAX_MEDIA_BYTES = 64UL * 1024UL * 1024UL; // 64 MB
+//! Number of media entries dropped in a single transaction.
+constexpr std::size_t MEDIA_SWEEP_BATCH_SIZE = 500;
+
+//! Number of megolm sessions imported or exported at once.
+constexpr std::size_t SESSION_KEYS_CHUNK_SIZE = 1000;
+
+//! Bounds for the olm sessions kept unpickled in memory.
+constexpr size_t MAX_CACHED_OLM_SESSIONS_PER_KEY = 4;
+constexpr size_t MAX_CACHED_OLM_SESSION_KEYS     = 128;
+
 constexpr auto DB_SIZE = 512UL * 1024UL * 1024UL; // 512 MB
 constexpr auto MAX_DBS = 1024UL;
 
+//! Share of the map that the stored messages of all the rooms may take.
+constexpr std::size_t MESSAGES_BYTES = DB_SIZE / 2;
+//! Average size of a stored message, along with its share of the database pages.
+constexpr std::size_t STORED_MESSAGE_BYTES = 2UL * 1024UL; // 2 KB
+
+//! The longest time a queued write or an unsynced commit waits for the flusher.
+constexpr std::chrono::milliseconds FLUSH_INTERVAL(500);
+//! Amount of queued data that wakes up the flusher before its interval.
+constexpr std::size_t FLUSH_THRESHOLD = 1024UL * 1024UL; // 1 MB
+
+//! Reset read-only transactions kept around for reuse.
+//! It should stay well below the reader slots of the environment (126 by default).
+constexpr std::size_t MAX_POOLED_READ_TXNS = 16;
+
 //! Cache databases and their format.
 //!
 //! Contains UI information for the joined rooms. (i.e name, topic, avatar url etc).
@@ -57,13 +93,15 @@ constexpr auto MEDIA_DB("media");
 constexpr auto SYNC_STATE_DB("sync_state");
 //! Read receipts per room/event.
 constexpr auto READ_RECEIPTS_DB("read_receipts");
+//! Read receipts of our own that haven't been matched with a notification yet.
+constexpr auto PENDING_RECEIPTS_DB("pending_receipts");
 constexpr auto NOTIFICATIONS_DB("sent_notifications");
 
 //! Encryption related databases.
 
-//! user_id -> list of devices
+//! user_id -> list of device_ids with verified keys
 constexpr auto DEVICES_DB("devices");
-//! device_id -> device keys
+//! (user_id, device_id) -> DevicePublicKeys
 constexpr auto DEVICE_KEYS_DB("device_keys");
 //! room_ids that have encryption enabled.
 constexpr auto ENCRYPTED_ROOMS_DB("encrypted_rooms");
@@ -73,6 +111,14 @@ constexpr auto INBOUND_MEGOLM_SESSIONS_DB("inbound_megolm_sessions");
 //! MegolmSessionIndex -> pickled OlmOutboundGroupSession
 constexpr auto OUTBOUND_MEGOLM_SESSIONS_DB("outbound_megolm_sessions");
 
+//! room_id -> RetentionPolicy
+constexpr auto RETENTION_DB("retention");
+
+//! sequence number -> to_device message that hasn't been processed yet.
+constexpr auto PENDING_TO_DEVICE_DB("pending_to_device");
+//! owner -> url of media that's referenced outside the rooms' state.
+constexpr auto PINNED_MEDIA_DB("pinned_media");
+
 using CachedReceipts = std::multimap<uint64_t, std::string, std::greater<uint64_t>>;
 using Receipts       = std::map<std::string, std::map<std::string, uint64_t>>;
 
@@ -116,11 +162,169 @@ Cache::Cache(const QString &userId, QObject *parent)
   , deviceKeysDb_{0}
   , inboundMegolmSessionDb_{0}
   , outboundMegolmSessionDb_{0}
+  , retentionDb_{0}
+  , pendingToDeviceDb_{0}
+  , pinnedMediaDb_{0}
   , localUserId_{userId}
 {
         setup();
 }
 
+Cache::~Cache()
+{
+        retention_.waitForFinished();
+
+        stopFlusher();
+}
+
+static Durability
+durabilityFromSettings()
+{
+        QSettings settings;
+        const auto mode = settings.value("database/durability", "group").toString();
+
+        if (mode == "full")
+                return Durability::Full;
+        else if (mode == "nometasync")
+                return Durability::NoMetaSync;
+
+        return Durability::GroupCommit;
+}
+
+static RetentionPolicy
+retentionFromSettings()
+{
+        QSettings settings;
+
+        RetentionPolicy policy;
+        policy.max_messages =
+          settings.value("retention/max_messages", (qulonglong)DEFAULT_MAX_STORED_MESSAGES)
+            .toULongLong();
+        policy.max_age =
+          std::chrono::hours(24 * settings.value("retention/max_age_days", 0).toInt());
+        policy.max_bytes = settings.value("retention/max_bytes", 0).toULongLong();
+
+        return policy;
+}
+
+//! Position the cursor on the stored message with the given key or, if that
+//! event isn't stored, on the closest newer one.
+static bool
+seekMessage(lmdb::cursor &cursor, const std::string &message, lmdb::val &key, lmdb::val &msg)
+{
+        key = lmdb::val(message);
+        if (cursor.get(key, msg, MDB_SET_KEY))
+                return true;
+
+        // Messages are sorted from the newest to the oldest.
+        if (cursor.get(key, msg, MDB_SET_RANGE))
+                return cursor.get(key, msg, MDB_PREV);
+
+        return cursor.get(key, msg, MDB_LAST);
+}
+
+//! Update the pagination markers of a stored message.
+static void
+markMessage(lmdb::txn &txn, lmdb::dbi &db, const std::string &key, bool gap, bool start)
+{
+        lmdb::val value;
+        if (!lmdb::dbi_get(txn, db, lmdb::val(key), value))
+                return;
+
+        auto obj = json::parse(std::string(value.data(), value.size()));
+
+        if (gap)
+                obj["gap"] = true;
+        else
+                obj.erase("gap");
+
+        if (start)
+                obj["start"] = true;
+        else
+                obj.erase("start");
+
+        lmdb::dbi_put(txn, db, lmdb::val(key), lmdb::val(obj.dump()));
+}
+
+//! Drop the stored message with the given event id, like the timeline does with the
+//! redacted events. Its pagination markers are moved to the next newer message.
+static void
+redactMessage(lmdb::txn &txn, lmdb::dbi &db, const std::string &event_id)
+{
+        // Only the messages that mention the id are parsed.
+        const auto quoted = json(event_id).dump();
+
+        auto cursor = lmdb::cursor::open(txn, db);
+
+        std::string key, msg;
+        while (cursor.get(key, msg, MDB_NEXT)) {
+                if (msg.find(quoted) == std::string::npos)
+                        continue;
+
+                const auto obj = json::parse(msg);
+                if (obj.at("event").value("event_id", "") != event_id)
+                        continue;
+
+                std::string newer, newerMsg;
+                const bool hasNewer = cursor.get(newer, newerMsg, MDB_PREV);
+                cursor.close();
+
+                lmdb::dbi_del(txn, db, lmdb::val(key), nullptr);
+
+                if (!hasNewer)
+                        return;
+
+                // A newer message with a gap knows nothing about the redacted one.
+                auto newerObj = json::parse(newerMsg);
+                if (newerObj.value("gap", false))
+                        return;
+
+                newerObj["token"] = obj.value("token", "");
+                if (obj.value("gap", false))
+                        newerObj["gap"] = true;
+                if (obj.value("start", false))
+                        newerObj["start"] = true;
+
+                lmdb::dbi_put(txn, db, lmdb::val(newer), lmdb::val(newerObj.dump()));
+                return;
+        }
+
+        cursor.close();
+}
+
+//! Messages are sorted from the newest to the oldest.
+static void
+setComparison(lmdb::txn &txn, const lmdb::dbi &db, const std::string &name)
+{
+        const std::string suffix = "/messages";
+
+        if (name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+                lmdb::dbi_set_compare(txn, db, message_key_comparison);
+}
+
+//! Approximate size of a database from its page counts.
+static std::size_t
+databaseSize(MDB_txn *txn, const lmdb::dbi &db)
+{
+        const auto stat = db.stat(txn);
+        return stat.ms_psize * (stat.ms_branch_pages + stat.ms_leaf_pages + stat.ms_overflow_pages);
+}
+
+static unsigned int
+durabilityFlags(Durability durability)
+{
+        // Read-only transactions are pooled and may be renewed on any thread.
+        switch (durability) {
+        case Durability::NoMetaSync:
+                return MDB_NOTLS | MDB_NOMETASYNC;
+        case Durability::GroupCommit:
+                return MDB_NOTLS | MDB_NOSYNC | MDB_NOMETASYNC;
+        default:
+                return MDB_NOTLS;
+        }
+}
+
 void
 Cache::setup()
 {
@@ -136,6 +340,22 @@ Cache::setup()
 
         bool isInitial = !QFile::exists(statePath);
 
+        stopFlusher();
+
+        {
+                std::unique_lock<std::mutex> lock(readTxnsMtx_);
+                readTxns_.clear();
+        }
+
+        {
+                std::unique_lock<std::mutex> lock(dbisMtx_);
+                dbis_.clear();
+        }
+
+        durability_       = durabilityFromSettings();
+        defaultRetention_ = retentionFromSettings();
+        const auto flags  = durabilityFlags(durability_);
+
         env_ = lmdb::env::create();
         env_.set_mapsize(DB_SIZE);
         env_.set_max_dbs(MAX_DBS);
@@ -150,7 +370,7 @@ Cache::setup()
         }
 
         try {
-                env_.open(statePath.toStdString().c_str());
+                env_.open(statePath.toStdString().c_str(), flags);
         } catch (const lmdb::error &e) {
                 if (e.code() != MDB_VERSION_MISMATCH && e.code() != MDB_INVALID) {
                         throw std::runtime_error("LMDB initialization failed" +
@@ -167,7 +387,7 @@ Cache::setup()
                                   ("Unable to delete file " + file).toStdString().c_str());
                 }
 
-                env_.open(statePath.toStdString().c_str());
+                env_.open(statePath.toStdString().c_str(), flags);
         }
 
         auto txn         = lmdb::txn::begin(env_);
@@ -186,16 +406,277 @@ Cache::setup()
         inboundMegolmSessionDb_  = lmdb::dbi::open(txn, INBOUND_MEGOLM_SESSIONS_DB, MDB_CREATE);
         outboundMegolmSessionDb_ = lmdb::dbi::open(txn, OUTBOUND_MEGOLM_SESSIONS_DB, MDB_CREATE);
 
+        retentionDb_       = lmdb::dbi::open(txn, RETENTION_DB, MDB_CREATE);
+        pendingReceiptsDb_ = lmdb::dbi::open(txn, PENDING_RECEIPTS_DB, MDB_CREATE);
+        encryptedRoomsDb_  = lmdb::dbi::open(txn, ENCRYPTED_ROOMS_DB, MDB_CREATE);
+        pendingToDeviceDb_ = lmdb::dbi::open(txn, PENDING_TO_DEVICE_DB, MDB_CREATE);
+        pinnedMediaDb_     = lmdb::dbi::open(txn, PINNED_MEDIA_DB, MDB_CREATE);
+
         txn.commit();
+
+        startFlusher();
+}
+
+//
+// Group commit
+//
+
+void
+Cache::startFlusher()
+{
+        {
+                std::unique_lock<std::mutex> lock(writesMtx_);
+                stopFlusher_ = false;
+        }
+
+        flusher_ = std::thread(&Cache::runFlusher, this);
+}
+
+void
+Cache::stopFlusher()
+{
+        if (!flusher_.joinable())
+                return;
+
+        {
+                std::unique_lock<std::mutex> lock(writesMtx_);
+                stopFlusher_ = true;
+        }
+
+        writesCv_.notify_one();
+        flusher_.join();
+
+        flush();
+}
+
+void
+Cache::runFlusher()
+{
+        std::unique_lock<std::mutex> lock(writesMtx_);
+
+        while (!stopFlusher_) {
+                writesCv_.wait_for(lock, FLUSH_INTERVAL, [this]() {
+                        return stopFlusher_ || queuedBytes_ >= FLUSH_THRESHOLD;
+                });
+
+                if (stopFlusher_)
+                        break;
+
+                lock.unlock();
+
+                flush();
+
+                lock.lock();
+        }
+}
+
+void
+Cache::flush()
+{
+        try {
+                commitQueuedWrites();
+
+                if (durability_ != Durability::Full)
+                        env_.sync(true);
+        } catch (const lmdb::error &e) {
+                nhlog::db()->critical("failed to flush the cache: {}", e.what());
+        }
+}
+
+void
+Cache::queueWrite(const std::string &key, Write write, std::size_t bytes)
+{
+        bool wake = false;
+
+        {
+                std::unique_lock<std::mutex> lock(writesMtx_);
+
+                auto it = queuedWrites_.end();
+                if (!key.empty())
+                        it = std::find_if(queuedWrites_.begin(),
+                                          queuedWrites_.end(),
+                                          [&key](const QueuedWrite &w) { return w.key == key; });
+
+                if (it != queuedWrites_.end())
+                        it->write = std::move(write);
+                else
+                        queuedWrites_.push_back(QueuedWrite{key, std::move(write)});
+
+                queuedBytes_ += bytes;
+                wake = queuedBytes_ >= FLUSH_THRESHOLD;
+        }
+
+        if (wake)
+                writesCv_.notify_one();
+}
+
+void
+Cache::commitQueuedWrites()
+{
+        std::unique_lock<std::mutex> commitLock(commitMtx_);
+
+        std::vector<QueuedWrite> writes;
+        {
+                std::unique_lock<std::mutex> lock(writesMtx_);
+                std::swap(writes, queuedWrites_);
+                queuedBytes_ = 0;
+        }
+
+        if (writes.empty())
+                return;
+
+        auto txn = lmdb::txn::begin(env_);
+
+        for (const auto &w : writes) {
+                try {
+                        w.write(txn);
+                } catch (const lmdb::error &e) {
+                        nhlog::db()->critical("failed to apply queued write: {}", e.what());
+                }
+        }
+
+        txn.commit();
+
+        nhlog::db()->debug("committed {} queued writes", writes.size());
+}
+
+ReadTxn::ReadTxn(const Cache *cache, lmdb::txn txn)
+  : cache_{cache}
+  , txn_{std::move(txn)}
+{}
+
+ReadTxn::~ReadTxn()
+{
+        if (txn_.handle() != nullptr)
+                cache_->releaseReadTxn(std::move(txn_));
+}
+
+ReadTxn
+Cache::readTxn() const
+{
+        {
+                std::unique_lock<std::mutex> lock(readTxnsMtx_);
+
+                if (!readTxns_.empty()) {
+                        auto txn = std::move(readTxns_.back());
+                        readTxns_.pop_back();
+                        lock.unlock();
+
+                        txn.renew();
+                        return ReadTxn(this, std::move(txn));
+                }
+        }
+
+        return ReadTxn(this, lmdb::txn::begin(env_, nullptr, MDB_RDONLY));
+}
+
+void
+Cache::releaseReadTxn(lmdb::txn txn) const
+{
+        txn.reset();
+
+        std::unique_lock<std::mutex> lock(readTxnsMtx_);
+        if (readTxns_.size() < MAX_POOLED_READ_TXNS)
+                readTxns_.push_back(std::move(txn));
+}
+
+//
+// Databases opened on demand
+//
+
+lmdb::dbi
+Cache::openDb(const std::string &name)
+{
+        std::unique_lock<std::mutex> lock(dbisMtx_);
+
+        auto it = dbis_.find(name);
+        if (it != dbis_.end())
+                return lmdb::dbi(it->second);
+
+        // A handle is only handed over to the environment when the transaction that opened it
+        // commits. Read-only, so it can be opened while the thread holds the write lock.
+        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto db  = lmdb::dbi::open(txn, name.c_str());
+        setComparison(txn, db, name);
+        txn.commit();
+
+        dbis_.emplace(name, db.handle());
+
+        return db;
+}
+
+void
+Cache::createDbs(const std::vector<std::string> &names)
+{
+        auto isMissing = [this](const std::string &name) {
+                return dbis_.find(name) == dbis_.end();
+        };
+
+        {
+                std::unique_lock<std::mutex> lock(dbisMtx_);
+                if (std::none_of(names.begin(), names.end(), isMissing))
+                        return;
+        }
+
+        // The write lock comes first, a writer may be waiting for a handle.
+        auto txn = lmdb::txn::begin(env_);
+
+        std::unique_lock<std::mutex> lock(dbisMtx_);
+
+        std::vector<std::pair<std::string, MDB_dbi>> opened;
+        for (const auto &name : names) {
+                if (!isMissing(name))
+                        continue;
+
+                auto db = lmdb::dbi::open(txn, name.c_str(), MDB_CREATE);
+                setComparison(txn, db, name);
+                opened.emplace_back(name, db.handle());
+        }
+
+        txn.commit();
+
+        dbis_.insert(opened.begin(), opened.end());
+}
+
+void
+Cache::dropDb(lmdb::txn &txn, const std::string &name)
+{
+        std::unique_lock<std::mutex> lock(dbisMtx_);
+
+        MDB_dbi handle;
+
+        auto it = dbis_.find(name);
+        if (it != dbis_.end()) {
+                handle = it->second;
+        } else {
+                // A handle opened by another transaction after this one began isn't valid in it.
+                try {
+                        handle = lmdb::dbi::open(txn, name.c_str()).handle();
+                } catch (const lmdb::error &) {
+                        // Never created.
+                        return;
+                }
+        }
+
+        // Deleting a database closes its handle.
+        lmdb::dbi_drop(txn, handle, true);
+        dbis_.erase(name);
+}
+
+void
+Cache::syncToDisk()
+{
+        // Every commit is already synced otherwise.
+        if (durability_ != Durability::Full)
+                env_.sync(true);
 }
 
 void
-Cache::setEncryptedRoom(lmdb::txn &txn, const std::string &room_id)
+Cache::setEncryptedRoom(lmdb::txn &txn, const std::string &room_id, const json &content)
 {
         nhlog::db()->info("mark room {} as encrypted", room_id);
 
-        auto db = lmdb::dbi::open(txn, ENCRYPTED_ROOMS_DB, MDB_CREATE);
-        lmdb::dbi_put(txn, db, lmdb::val(room_id), lmdb::val("0"));
+        lmdb::dbi_put(txn, encryptedRoomsDb_, lmdb::val(room_id), lmdb::val(content.dump()));
 }
 
 bool
@@ -203,64 +684,185 @@ Cache::isRoomEncrypted(const std::string &room_id)
 {
         lmdb::val unused;
 
-        auto txn = lmdb::txn::begin(env_);
-        auto db  = lmdb::dbi::open(txn, ENCRYPTED_ROOMS_DB, MDB_CREATE);
-        auto res = lmdb::dbi_get(txn, db, lmdb::val(room_id), unused);
-        txn.commit();
+        auto txn = readTxn();
+        return lmdb::dbi_get(txn, encryptedRoomsDb_, lmdb::val(room_id), unused);
+}
 
-        return res;
+MegolmRotation
+Cache::megolmRotation(const std::string &room_id)
+{
+        MegolmRotation rotation;
+
+        auto txn = readTxn();
+
+        lmdb::val value;
+        if (!lmdb::dbi_get(txn, encryptedRoomsDb_, lmdb::val(room_id), value))
+                return rotation;
+
+        try {
+                // Rooms marked by older versions have no content.
+                const auto content = json::parse(std::string(value.data(), value.size()));
+                if (!content.is_object())
+                        return rotation;
+
+                rotation.period_ms   = content.value("rotation_period_ms", uint64_t(0));
+                rotation.period_msgs = content.value("rotation_period_msgs", uint64_t(0));
+        } catch (const json::exception &e) {
+                nhlog::db()->warn(
+                  "failed to parse encryption settings of {}: {}", room_id, e.what());
+        }
+
+        return rotation;
 }
 
 mtx::crypto::ExportedSessionKeys
-Cache::exportSessionKeys()
+Cache::exportSessionKeys(SessionKeysProgress progress)
 {
         using namespace mtx::crypto;
 
         ExportedSessionKeys keys;
 
-        auto txn    = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn    = readTxn();
         auto cursor = lmdb::cursor::open(txn, inboundMegolmSessionDb_);
 
-        std::string key, value;
-        while (cursor.get(key, value, MDB_NEXT)) {
+        const std::size_t total = inboundMegolmSessionDb_.size(txn);
+
+        // The pickled sessions of the current chunk, exported in parallel.
+        std::vector<std::pair<std::string, std::string>> pickled;
+        pickled.reserve(SESSION_KEYS_CHUNK_SIZE);
+
+        struct ExportingSession
+        {
+                const std::pair<std::string, std::string> *saved = nullptr;
                 ExportedSession exported;
-                MegolmSessionIndex index;
+        };
 
-                auto saved_session = unpickle<InboundSessionObject>(value, SECRET);
+        auto exportChunk = [&keys, &pickled]() {
+                std::vector<ExportingSession> chunk(pickled.size());
+                for (std::size_t i = 0; i < pickled.size(); ++i)
+                        chunk[i].saved = &pickled[i];
 
-                try {
-                        index = nlohmann::json::parse(key).get<MegolmSessionIndex>();
-                } catch (const nlohmann::json::exception &e) {
-                        nhlog::db()->critical("failed to export megolm session: {}", e.what());
-                        continue;
+                QtConcurrent::blockingMap(chunk, [](ExportingSession &s) {
+                        try {
+                                const auto index =
+                                  nlohmann::json::parse(s.saved->first).get<MegolmSessionIndex>();
+                                const auto session =
+                                  unpickle<InboundSessionObject>(s.saved->second, SECRET);
+
+                                s.exported.room_id     = index.room_id;
+                                s.exported.sender_key  = index.sender_key;
+                                s.exported.session_id  = index.session_id;
+                                s.exported.session_key = export_session(session.get());
+                        } catch (const nlohmann::json::exception &e) {
+                                nhlog::db()->critical("failed to export megolm session: {}",
+                                                      e.what());
+                        } catch (const olm_exception &e) {
+                                nhlog::crypto()->critical("failed to export megolm session: {}",
+                                                          e.what());
+                        }
+                });
+
+                for (auto &s : chunk) {
+                        if (!s.exported.session_key.empty())
+                                keys.sessions.push_back(std::move(s.exported));
                 }
 
-                exported.room_id     = index.room_id;
-                exported.sender_key  = index.sender_key;
-                exported.session_id  = index.session_id;
-                exported.session_key = export_session(saved_session.get());
+                pickled.clear();
+        };
 
-                keys.sessions.push_back(exported);
+        std::string key, value;
+        std::size_t processed = 0;
+        while (cursor.get(key, value, MDB_NEXT)) {
+                pickled.emplace_back(std::move(key), std::move(value));
+
+                if (pickled.size() == SESSION_KEYS_CHUNK_SIZE) {
+                        processed += pickled.size();
+                        exportChunk();
+
+                        if (progress)
+                                progress(processed, total);
+                }
         }
 
+        processed += pickled.size();
+        exportChunk();
+
         cursor.close();
-        txn.commit();
+
+        if (progress)
+                progress(processed, total);
 
         return keys;
 }
 
 void
-Cache::importSessionKeys(const mtx::crypto::ExportedSessionKeys &keys)
+Cache::importSessionKeys(const mtx::crypto::ExportedSessionKeys &keys,
+                         SessionKeysProgress progress)
 {
-        for (const auto &s : keys.sessions) {
-                MegolmSessionIndex index;
-                index.room_id    = s.room_id;
-                index.session_id = s.session_id;
-                index.sender_key = s.sender_key;
+        using namespace mtx::crypto;
+
+        struct ImportedSession
+        {
+                const ExportedSession *exported = nullptr;
+                std::string key;
+                std::string pickled;
+                InboundGroupSessionPtr session;
+        };
+
+        const auto &sessions = keys.sessions;
+
+        for (std::size_t start = 0; start < sessions.size(); start += SESSION_KEYS_CHUNK_SIZE) {
+                const auto end = std::min(start + SESSION_KEYS_CHUNK_SIZE, sessions.size());
+
+                std::vector<ImportedSession> chunk(end - start);
+                for (std::size_t i = start; i < end; ++i)
+                        chunk[i - start].exported = &sessions[i];
+
+                // Decoding and pickling the sessions is spread over the thread pool.
+                QtConcurrent::blockingMap(chunk, [](ImportedSession &imported) {
+                        const auto &s = *imported.exported;
+
+                        MegolmSessionIndex index;
+                        index.room_id    = s.room_id;
+                        index.session_id = s.session_id;
+                        index.sender_key = s.sender_key;
+
+                        try {
+                                imported.session = import_session(s.session_key);
+                                imported.pickled =
+                                  pickle<InboundSessionObject>(imported.session.get(), SECRET);
+                                imported.key = json(index).dump();
+                        } catch (const olm_exception &e) {
+                                nhlog::crypto()->warn(
+                                  "failed to import megolm session {}: {}", s.session_id, e.what());
+                                imported.session.reset();
+                        }
+                });
 
-                auto exported_session = mtx::crypto::import_session(s.session_key);
+                auto txn = lmdb::txn::begin(env_);
+                for (const auto &imported : chunk) {
+                        if (!imported.session)
+                                continue;
 
-                saveInboundMegolmSession(index, std::move(exported_session));
+                        lmdb::dbi_put(txn,
+                                      inboundMegolmSessionDb_,
+                                      lmdb::val(imported.key),
+                                      lmdb::val(imported.pickled));
+                }
+                txn.commit();
+                syncToDisk();
+
+                {
+                        std::unique_lock<std::mutex> lock(session_storage.group_inbound_mtx);
+                        for (auto &imported : chunk) {
+                                if (imported.session)
+                                        session_storage.group_inbound_sessions[imported.key] =
+                                          std::move(imported.session);
+                        }
+                }
+
+                if (progress)
+                        progress(end, sessions.size());
         }
 }
 
@@ -279,6 +881,7 @@ Cache::saveInboundMegolmSession(const MegolmSessionIndex &index,
         auto txn = lmdb::txn::begin(env_);
         lmdb::dbi_put(txn, inboundMegolmSessionDb_, lmdb::val(key), lmdb::val(pickled));
         txn.commit();
+        syncToDisk();
 
         {
                 std::unique_lock<std::mutex> lock(session_storage.group_inbound_mtx);
@@ -286,6 +889,32 @@ Cache::saveInboundMegolmSession(const MegolmSessionIndex &index,
         }
 }
 
+void
+Cache::saveInboundMegolmSessions(InboundMegolmSessions sessions)
+{
+        using namespace mtx::crypto;
+
+        if (sessions.empty())
+                return;
+
+        auto txn = lmdb::txn::begin(env_);
+        for (const auto &session : sessions) {
+                const auto key     = json(session.first).dump();
+                const auto pickled = pickle<InboundSessionObject>(session.second.get(), SECRET);
+
+                lmdb::dbi_put(txn, inboundMegolmSessionDb_, lmdb::val(key), lmdb::val(pickled));
+        }
+        txn.commit();
+        syncToDisk();
+
+        {
+                std::unique_lock<std::mutex> lock(session_storage.group_inbound_mtx);
+                for (auto &session : sessions)
+                        session_storage.group_inbound_sessions[json(session.first).dump()] =
+                          std::move(session.second);
+        }
+}
+
 OlmInboundGroupSession *
 Cache::getInboundMegolmSession(const MegolmSessionIndex &index)
 {
@@ -304,8 +933,6 @@ Cache::inboundMegolmSessionExists(const MegolmSessionIndex &index)
 void
 Cache::updateOutboundMegolmSession(const std::string &room_id, int message_index)
 {
-        using namespace mtx::crypto;
-
         if (!outboundMegolmSessionExists(room_id))
                 return;
 
@@ -322,6 +949,44 @@ Cache::updateOutboundMegolmSession(const std::string &room_id, int message_index
         }
 
         // Save the updated pickled data for the session.
+        writeOutboundMegolmSession(room_id, data, session);
+}
+
+void
+Cache::markOutboundMegolmSessionShared(const std::string &room_id,
+                                       const std::string &session_id,
+                                       const std::string &user_id,
+                                       const std::vector<std::string> &device_ids)
+{
+        if (!outboundMegolmSessionExists(room_id))
+                return;
+
+        OutboundGroupSessionData data;
+        OlmOutboundGroupSession *session;
+        {
+                std::unique_lock<std::mutex> lock(session_storage.group_outbound_mtx);
+                auto &saved_data = session_storage.group_outbound_session_data[room_id];
+
+                // The session has been rotated in the meantime.
+                if (saved_data.session_id != session_id)
+                        return;
+
+                saved_data.shared_with[user_id].insert(device_ids.begin(), device_ids.end());
+
+                data    = saved_data;
+                session = session_storage.group_outbound_sessions[room_id].get();
+        }
+
+        writeOutboundMegolmSession(room_id, data, session);
+}
+
+void
+Cache::writeOutboundMegolmSession(const std::string &room_id,
+                                  const OutboundGroupSessionData &data,
+                                  OlmOutboundGroupSession *session)
+{
+        using namespace mtx::crypto;
+
         json j;
         j["data"]    = data;
         j["session"] = pickle<OutboundSessionObject>(session, SECRET);
@@ -329,6 +994,10 @@ Cache::updateOutboundMegolmSession(const std::string &room_id, int message_index
         auto txn = lmdb::txn::begin(env_);
         lmdb::dbi_put(txn, outboundMegolmSessionDb_, lmdb::val(room_id), lmdb::val(j.dump()));
         txn.commit();
+
+        // The message index must be on disk before the message that used it is sent,
+        // otherwise it could be reused after a crash.
+        syncToDisk();
 }
 
 void
@@ -336,16 +1005,7 @@ Cache::saveOutboundMegolmSession(const std::string &room_id,
                                  const OutboundGroupSessionData &data,
                                  mtx::crypto::OutboundGroupSessionPtr session)
 {
-        using namespace mtx::crypto;
-        const auto pickled = pickle<OutboundSessionObject>(session.get(), SECRET);
-
-        json j;
-        j["data"]    = data;
-        j["session"] = pickled;
-
-        auto txn = lmdb::txn::begin(env_);
-        lmdb::dbi_put(txn, outboundMegolmSessionDb_, lmdb::val(room_id), lmdb::val(j.dump()));
-        txn.commit();
+        writeOutboundMegolmSession(room_id, data, session.get());
 
         {
                 std::unique_lock<std::mutex> lock(session_storage.group_outbound_mtx);
@@ -381,8 +1041,10 @@ Cache::saveOlmSession(const std::string &curve25519, mtx::crypto::OlmSessionPtr
 {
         using namespace mtx::crypto;
 
+        createDbs({olmSessionsDb(curve25519)});
+
         auto txn = lmdb::txn::begin(env_);
-        auto db  = getOlmSessionsDb(txn, curve25519);
+        auto db  = openDb(olmSessionsDb(curve25519));
 
         const auto pickled    = pickle<SessionObject>(session.get(), SECRET);
         const auto session_id = mtx::crypto::session_id(session.get());
@@ -390,6 +1052,9 @@ Cache::saveOlmSession(const std::string &curve25519, mtx::crypto::OlmSessionPtr
         lmdb::dbi_put(txn, db, lmdb::val(session_id), lmdb::val(pickled));
 
         txn.commit();
+        syncToDisk();
+
+        cacheOlmSession(curve25519, OlmSessionRef(std::move(session)));
 }
 
 boost::optional<mtx::crypto::OlmSessionPtr>
@@ -397,20 +1062,23 @@ Cache::getOlmSession(const std::string &curve25519, const std::string &session_i
 {
         using namespace mtx::crypto;
 
-        auto txn = lmdb::txn::begin(env_);
-        auto db  = getOlmSessionsDb(txn, curve25519);
+        std::string data;
 
-        lmdb::val pickled;
-        bool found = lmdb::dbi_get(txn, db, lmdb::val(session_id), pickled);
+        try {
+                auto db  = openDb(olmSessionsDb(curve25519));
+                auto txn = readTxn();
 
-        txn.commit();
+                lmdb::val pickled;
+                if (!lmdb::dbi_get(txn, db, lmdb::val(session_id), pickled))
+                        return boost::none;
 
-        if (found) {
-                auto data = std::string(pickled.data(), pickled.size());
-                return unpickle<SessionObject>(data, SECRET);
+                data = std::string(pickled.data(), pickled.size());
+        } catch (const lmdb::error &) {
+                // No session with this device yet.
+                return boost::none;
         }
 
-        return boost::none;
+        return unpickle<SessionObject>(data, SECRET);
 }
 
 std::vector<std::string>
@@ -418,20 +1086,178 @@ Cache::getOlmSessions(const std::string &curve25519)
 {
         using namespace mtx::crypto;
 
-        auto txn = lmdb::txn::begin(env_);
-        auto db  = getOlmSessionsDb(txn, curve25519);
-
         std::string session_id, unused;
         std::vector<std::string> res;
 
-        auto cursor = lmdb::cursor::open(txn, db);
-        while (cursor.get(session_id, unused, MDB_NEXT))
-                res.emplace_back(session_id);
-        cursor.close();
+        try {
+                auto db  = openDb(olmSessionsDb(curve25519));
+                auto txn = readTxn();
+
+                auto cursor = lmdb::cursor::open(txn, db);
+                while (cursor.get(session_id, unused, MDB_NEXT))
+                        res.emplace_back(session_id);
+                cursor.close();
+        } catch (const lmdb::error &) {
+                // No session with this device yet.
+        }
+
+        return res;
+}
+
+std::vector<OlmSessionRef>
+Cache::getCachedOlmSessions(const std::string &curve25519)
+{
+        std::unique_lock<std::mutex> lock(session_storage.olm_mtx);
+
+        auto it = session_storage.olm_sessions.find(curve25519);
+        if (it == session_storage.olm_sessions.end())
+                return {};
+
+        return std::vector<OlmSessionRef>(it->second.begin(), it->second.end());
+}
+
+void
+Cache::touchOlmSession(const std::string &curve25519, OlmSessionRef session)
+{
+        cacheOlmSession(curve25519, session);
+
+        std::unique_lock<std::mutex> lock(session_storage.olm_mtx);
+
+        auto &modified = session_storage.modified_olm_sessions[curve25519];
+        if (std::find(modified.begin(), modified.end(), session) == modified.end())
+                modified.push_back(std::move(session));
+}
+
+void
+Cache::cacheOlmSession(const std::string &curve25519, OlmSessionRef session)
+{
+        const auto session_id = mtx::crypto::session_id(session.get());
+
+        std::unique_lock<std::mutex> lock(session_storage.olm_mtx);
+
+        auto &keys = session_storage.olm_session_keys;
+        keys.remove(curve25519);
+        keys.push_front(curve25519);
+
+        auto &sessions = session_storage.olm_sessions[curve25519];
+        sessions.remove_if([&session_id](const OlmSessionRef &s) {
+                return mtx::crypto::session_id(s.get()) == session_id;
+        });
+        sessions.push_front(std::move(session));
+
+        if (sessions.size() > MAX_CACHED_OLM_SESSIONS_PER_KEY)
+                sessions.resize(MAX_CACHED_OLM_SESSIONS_PER_KEY);
+
+        // Modified sessions are kept alive by the pending writes.
+        while (keys.size() > MAX_CACHED_OLM_SESSION_KEYS) {
+                session_storage.olm_sessions.erase(keys.back());
+                keys.pop_back();
+        }
+}
+
+void
+Cache::flushOlmSessions(const std::vector<std::string> &curve25519_keys)
+{
+        using namespace mtx::crypto;
+
+        std::map<std::string, std::vector<OlmSessionRef>> modified;
+        {
+                std::unique_lock<std::mutex> lock(session_storage.olm_mtx);
+
+                for (const auto &key : curve25519_keys) {
+                        auto it = session_storage.modified_olm_sessions.find(key);
+                        if (it == session_storage.modified_olm_sessions.end())
+                                continue;
+
+                        modified.emplace(key, std::move(it->second));
+                        session_storage.modified_olm_sessions.erase(it);
+                }
+        }
+
+        if (modified.empty())
+                return;
+
+        std::vector<std::string> dbs;
+        for (const auto &key : modified)
+                dbs.push_back(olmSessionsDb(key.first));
+
+        createDbs(dbs);
+
+        auto txn = lmdb::txn::begin(env_);
+
+        for (const auto &key : modified) {
+                auto db = openDb(olmSessionsDb(key.first));
+
+                for (const auto &session : key.second) {
+                        const auto pickled    = pickle<SessionObject>(session.get(), SECRET);
+                        const auto session_id = mtx::crypto::session_id(session.get());
+
+                        lmdb::dbi_put(txn, db, lmdb::val(session_id), lmdb::val(pickled));
+                }
+        }
+
+        txn.commit();
+        syncToDisk();
+}
+
+void
+Cache::savePendingToDevice(lmdb::txn &txn, const std::vector<nlohmann::json> &msgs)
+{
+        if (msgs.empty())
+                return;
+
+        uint64_t seq = 0;
+        {
+                auto cursor = lmdb::cursor::open(txn, pendingToDeviceDb_);
+
+                std::string key, unused;
+                if (cursor.get(key, unused, MDB_LAST))
+                        seq = std::stoull(key) + 1;
+
+                cursor.close();
+        }
+
+        for (const auto &msg : msgs) {
+                // Zero-padded so the keys sort in the order the messages were received.
+                auto key = std::to_string(seq++);
+                key.insert(0, 20 - key.size(), '0');
+                lmdb::dbi_put(txn, pendingToDeviceDb_, lmdb::val(key), lmdb::val(msg.dump()));
+        }
+}
+
+std::map<std::string, nlohmann::json>
+Cache::pendingToDevice()
+{
+        std::map<std::string, nlohmann::json> msgs;
+
+        auto txn    = readTxn();
+        auto cursor = lmdb::cursor::open(txn, pendingToDeviceDb_);
+
+        std::string key, value;
+        while (cursor.get(key, value, MDB_NEXT)) {
+                try {
+                        msgs.emplace(key, json::parse(value));
+                } catch (const json::exception &e) {
+                        nhlog::db()->warn("failed to parse pending to_device message: {}",
+                                          e.what());
+                }
+        }
+
+        cursor.close();
+
+        return msgs;
+}
+
+void
+Cache::removePendingToDevice(const std::vector<std::string> &keys)
+{
+        if (keys.empty())
+                return;
 
+        auto txn = lmdb::txn::begin(env_);
+        for (const auto &key : keys)
+                lmdb::dbi_del(txn, pendingToDeviceDb_, lmdb::val(key), nullptr);
         txn.commit();
-
-        return res;
 }
 
 void
@@ -440,6 +1266,7 @@ Cache::saveOlmAccount(const std::string &data)
         auto txn = lmdb::txn::begin(env_);
         lmdb::dbi_put(txn, syncStateDb_, OLM_ACCOUNT_KEY, lmdb::val(data));
         txn.commit();
+        syncToDisk();
 }
 
 void
@@ -495,14 +1322,199 @@ Cache::restoreSessions()
 std::string
 Cache::restoreOlmAccount()
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn = readTxn();
         lmdb::val pickled;
         lmdb::dbi_get(txn, syncStateDb_, OLM_ACCOUNT_KEY, pickled);
-        txn.commit();
 
         return std::string(pickled.data(), pickled.size());
 }
 
+//
+// Device keys
+//
+
+void
+Cache::saveDeviceKeys(lmdb::txn &txn,
+                      const std::string &user_id,
+                      const std::string &device_id,
+                      const DevicePublicKeys &keys)
+{
+        lmdb::dbi_put(txn,
+                      deviceKeysDb_,
+                      lmdb::val(deviceKeysIndex(user_id, device_id)),
+                      lmdb::val(json(keys).dump()));
+}
+
+boost::optional<DevicePublicKeys>
+Cache::getDeviceKeys(lmdb::txn &txn, const std::string &user_id, const std::string &device_id)
+{
+        const auto key = deviceKeysIndex(user_id, device_id);
+
+        lmdb::val value;
+        if (!lmdb::dbi_get(txn, deviceKeysDb_, lmdb::val(key), value))
+                return boost::none;
+
+        try {
+                return json::parse(std::string(value.data(), value.size())).get<DevicePublicKeys>();
+        } catch (const json::exception &e) {
+                nhlog::db()->warn("failed to parse device keys ({}, {}): {}",
+                                  user_id,
+                                  device_id,
+                                  e.what());
+        }
+
+        return boost::none;
+}
+
+uint64_t
+Cache::deviceListGeneration(const std::string &user_id)
+{
+        std::unique_lock<std::mutex> lock(deviceListsMtx_);
+
+        auto it = deviceListGenerations_.find(user_id);
+        return it != deviceListGenerations_.end() ? it->second : 0;
+}
+
+bool
+Cache::setDeviceList(const std::string &user_id,
+                     const DeviceKeysList &devices,
+                     uint64_t generation)
+{
+        auto txn = lmdb::txn::begin(env_);
+
+        // Invalidations happen in write transactions as well, so none can slip in
+        // between the check and the commit.
+        if (deviceListGeneration(user_id) != generation) {
+                nhlog::db()->info("not saving the outdated device list of {}", user_id);
+                return false;
+        }
+
+        // Remove the keys of devices that might no longer exist.
+        dropDeviceList(txn, user_id);
+
+        std::vector<std::string> device_ids;
+        device_ids.reserve(devices.size());
+
+        for (const auto &device : devices) {
+                saveDeviceKeys(txn, user_id, device.first, device.second);
+                device_ids.push_back(device.first);
+        }
+
+        lmdb::dbi_put(txn, devicesDb_, lmdb::val(user_id), lmdb::val(json(device_ids).dump()));
+
+        txn.commit();
+
+        return true;
+}
+
+std::vector<std::string>
+Cache::getDeviceList(const std::string &user_id)
+{
+        auto txn = readTxn();
+
+        lmdb::val value;
+        bool res = lmdb::dbi_get(txn, devicesDb_, lmdb::val(user_id), value);
+
+        if (!res)
+                return {};
+
+        try {
+                return json::parse(std::string(value.data(), value.size()))
+                  .get<std::vector<std::string>>();
+        } catch (const json::exception &e) {
+                nhlog::db()->warn("failed to parse device list of {}: {}", user_id, e.what());
+        }
+
+        return {};
+}
+
+std::map<std::string, DeviceKeysList>
+Cache::getDeviceKeys(const std::vector<std::string> &users, std::vector<std::string> &outdated)
+{
+        std::map<std::string, DeviceKeysList> result;
+
+        auto txn = readTxn();
+
+        for (const auto &user_id : users) {
+                lmdb::val value;
+                if (!lmdb::dbi_get(txn, devicesDb_, lmdb::val(user_id), value)) {
+                        outdated.push_back(user_id);
+                        continue;
+                }
+
+                std::vector<std::string> device_ids;
+                try {
+                        device_ids = json::parse(std::string(value.data(), value.size()))
+                                       .get<std::vector<std::string>>();
+                } catch (const json::exception &e) {
+                        nhlog::db()->warn(
+                          "failed to parse device list of {}: {}", user_id, e.what());
+                        outdated.push_back(user_id);
+                        continue;
+                }
+
+                DeviceKeysList devices;
+                bool isComplete = true;
+
+                for (const auto &device_id : device_ids) {
+                        auto keys = getDeviceKeys(txn, user_id, device_id);
+
+                        if (!keys) {
+                                isComplete = false;
+                                break;
+                        }
+
+                        devices.emplace(device_id, keys.value());
+                }
+
+                if (isComplete)
+                        result.emplace(user_id, std::move(devices));
+                else
+                        outdated.push_back(user_id);
+        }
+
+        return result;
+}
+
+void
+Cache::invalidateDeviceLists(lmdb::txn &txn, const std::vector<std::string> &users)
+{
+        {
+                // Queries already in flight for these users won't be saved.
+                std::unique_lock<std::mutex> lock(deviceListsMtx_);
+                for (const auto &user_id : users)
+                        deviceListGenerations_[user_id] += 1;
+        }
+
+        for (const auto &user_id : users)
+                dropDeviceList(txn, user_id);
+}
+
+void
+Cache::dropDeviceList(lmdb::txn &txn, const std::string &user_id)
+{
+        lmdb::val value;
+        if (!lmdb::dbi_get(txn, devicesDb_, lmdb::val(user_id), value))
+                return;
+
+        try {
+                const auto device_ids = json::parse(std::string(value.data(), value.size()))
+                                          .get<std::vector<std::string>>();
+
+                for (const auto &device_id : device_ids)
+                        lmdb::dbi_del(txn,
+                                      deviceKeysDb_,
+                                      lmdb::val(deviceKeysIndex(user_id, device_id)),
+                                      nullptr);
+        } catch (const json::exception &e) {
+                nhlog::db()->warn("failed to parse device list of {}: {}", user_id, e.what());
+        }
+
+        lmdb::dbi_del(txn, devicesDb_, lmdb::val(user_id), nullptr);
+
+        nhlog::db()->debug("dropped device list of {}", user_id);
+}
+
 //
 // Media Management
 //
@@ -513,18 +1525,21 @@ Cache::saveImage(const std::string &url, const std::string &img_data)
         if (url.empty() || img_data.empty())
                 return;
 
-        try {
-                auto txn = lmdb::txn::begin(env_);
-
-                lmdb::dbi_put(txn,
-                              mediaDb_,
-                              lmdb::val(url.data(), url.size()),
-                              lmdb::val(img_data.data(), img_data.size()));
+        const auto bytes = url.size() + img_data.size();
 
-                txn.commit();
-        } catch (const lmdb::error &e) {
-                nhlog::db()->critical("saveImage: {}", e.what());
+        {
+                std::unique_lock<std::mutex> lock(retentionMtx_);
+                mediaBytesSinceSweep_ += bytes;
         }
+
+        queueWrite("media/" + url,
+                   [this, url, img_data](lmdb::txn &txn) {
+                           lmdb::dbi_put(txn,
+                                         mediaDb_,
+                                         lmdb::val(url.data(), url.size()),
+                                         lmdb::val(img_data.data(), img_data.size()));
+                   },
+                   bytes);
 }
 
 void
@@ -533,6 +1548,20 @@ Cache::saveImage(const QString &url, const QByteArray &image)
         saveImage(url.toStdString(), std::string(image.constData(), image.length()));
 }
 
+void
+Cache::pinMedia(const std::string &owner, const std::string &url)
+{
+        queueWrite("pinned/" + owner,
+                   [this, owner, url](lmdb::txn &txn) {
+                           if (url.empty())
+                                   lmdb::dbi_del(txn, pinnedMediaDb_, lmdb::val(owner), nullptr);
+                           else
+                                   lmdb::dbi_put(
+                                     txn, pinnedMediaDb_, lmdb::val(owner), lmdb::val(url));
+                   },
+                   owner.size() + url.size());
+}
+
 QByteArray
 Cache::image(lmdb::txn &txn, const std::string &url) const
 {
@@ -555,7 +1584,7 @@ Cache::image(lmdb::txn &txn, const std::string &url) const
 }
 
 QByteArray
-Cache::image(const QString &url) const
+Cache::image(const QString &url)
 {
         if (url.isEmpty())
                 return QByteArray();
@@ -563,14 +1592,15 @@ Cache::image(const QString &url) const
         auto key = url.toUtf8();
 
         try {
-                auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+                // The media might still be waiting in the queue.
+                commitQueuedWrites();
+
+                auto txn = readTxn();
 
                 lmdb::val image;
 
                 bool res = lmdb::dbi_get(txn, mediaDb_, lmdb::val(key.data(), key.size()), image);
 
-                txn.commit();
-
                 if (!res)
                         return QByteArray();
 
@@ -582,12 +1612,31 @@ Cache::image(const QString &url) const
         return QByteArray();
 }
 
+std::map<std::string, QByteArray>
+Cache::images(const std::vector<std::string> &urls)
+{
+        std::map<std::string, QByteArray> images;
+
+        commitQueuedWrites();
+
+        auto txn = readTxn();
+
+        for (const auto &url : urls) {
+                auto data = image(txn, url);
+
+                if (!data.isEmpty())
+                        images.emplace(url, std::move(data));
+        }
+
+        return images;
+}
+
 void
 Cache::removeInvite(lmdb::txn &txn, const std::string &room_id)
 {
         lmdb::dbi_del(txn, invitesDb_, lmdb::val(room_id), nullptr);
-        lmdb::dbi_drop(txn, getInviteStatesDb(txn, room_id), true);
-        lmdb::dbi_drop(txn, getInviteMembersDb(txn, room_id), true);
+        for (const auto &db : inviteDbs(room_id))
+                dropDb(txn, db);
 }
 
 void
@@ -602,8 +1651,14 @@ void
 Cache::removeRoom(lmdb::txn &txn, const std::string &roomid)
 {
         lmdb::dbi_del(txn, roomsDb_, lmdb::val(roomid), nullptr);
-        lmdb::dbi_drop(txn, getStatesDb(txn, roomid), true);
-        lmdb::dbi_drop(txn, getMembersDb(txn, roomid), true);
+        for (const auto &db : roomDbs(roomid))
+                dropDb(txn, db);
+        lmdb::dbi_del(txn, retentionDb_, lmdb::val(roomid), nullptr);
+
+        // The avatars of the room and its members may be orphaned now.
+        std::unique_lock<std::mutex> lock(retentionMtx_);
+        mediaBytesSinceSweep_ = std::max(mediaBytesSinceSweep_, MEDIA_SWEEP_THRESHOLD);
+        dirtyRooms_.erase(roomid);
 }
 
 void
@@ -629,26 +1684,22 @@ Cache::setNextBatchToken(lmdb::txn &txn, const QString &token)
 bool
 Cache::isInitialized() const
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn = readTxn();
         lmdb::val token;
 
         bool res = lmdb::dbi_get(txn, syncStateDb_, NEXT_BATCH_KEY, token);
 
-        txn.commit();
-
         return res;
 }
 
 std::string
 Cache::nextBatchToken() const
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn = readTxn();
         lmdb::val token;
 
         lmdb::dbi_get(txn, syncStateDb_, NEXT_BATCH_KEY, token);
 
-        txn.commit();
-
         return std::string(token.data(), token.size());
 }
 
@@ -665,18 +1716,27 @@ Cache::deleteData()
 bool
 Cache::isFormatValid()
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn = readTxn();
 
         lmdb::val current_version;
         bool res = lmdb::dbi_get(txn, syncStateDb_, CACHE_FORMAT_VERSION_KEY, current_version);
 
-        txn.commit();
-
         if (!res)
                 return false;
 
         std::string stored_version(current_version.data(), current_version.size());
 
+        if (stored_version == TIMESTAMP_KEYS_CACHE_FORMAT_VERSION) {
+                try {
+                        upgradeMessageKeys();
+                        setCurrentFormat();
+                        return true;
+                } catch (const lmdb::error &e) {
+                        nhlog::db()->critical("failed to upgrade the message keys: {}", e.what());
+                        return false;
+                }
+        }
+
         if (stored_version != CURRENT_CACHE_FORMAT_VERSION) {
                 nhlog::db()->warn("breaking changes in the cache format. stored: {}, current: {}",
                                   stored_version,
@@ -701,15 +1761,62 @@ Cache::setCurrentFormat()
         txn.commit();
 }
 
+void
+Cache::upgradeMessageKeys()
+{
+        const auto rooms = joinedRooms();
+
+        for (const auto &room_id : rooms) {
+                createDbs(roomDbs(room_id));
+
+                auto txn = lmdb::txn::begin(env_);
+                auto db  = getMessagesDb(room_id);
+
+                std::vector<std::pair<std::string, std::string>> messages;
+                {
+                        auto cursor = lmdb::cursor::open(txn, db);
+
+                        std::string key, msg;
+                        while (cursor.get(key, msg, MDB_NEXT)) {
+                                if (key.find('|') == std::string::npos)
+                                        messages.emplace_back(std::move(key), std::move(msg));
+                        }
+
+                        cursor.close();
+                }
+
+                for (const auto &msg : messages) {
+                        lmdb::dbi_del(txn, db, lmdb::val(msg.first), nullptr);
+
+                        try {
+                                const auto event_id = json::parse(msg.second)
+                                                        .at("event")
+                                                        .at("event_id")
+                                                        .get<std::string>();
+
+                                lmdb::dbi_put(
+                                  txn,
+                                  db,
+                                  lmdb::val(message_key(std::stoull(msg.first), event_id)),
+                                  lmdb::val(msg.second));
+                        } catch (const json::exception &e) {
+                                nhlog::db()->warn("dropping unreadable message: {}", e.what());
+                        }
+                }
+
+                txn.commit();
+
+                nhlog::db()->info("[{}] upgraded {} message keys", room_id, messages.size());
+        }
+}
+
 std::vector<QString>
 Cache::pendingReceiptsEvents(lmdb::txn &txn, const std::string &room_id)
 {
-        auto db = getPendingReceiptsDb(txn);
-
         std::string key, unused;
         std::vector<QString> pending;
 
-        auto cursor = lmdb::cursor::open(txn, db);
+        auto cursor = lmdb::cursor::open(txn, pendingReceiptsDb_);
         while (cursor.get(key, unused, MDB_NEXT)) {
                 ReadReceiptKey receipt;
                 try {
@@ -731,13 +1838,11 @@ Cache::pendingReceiptsEvents(lmdb::txn &txn, const std::string &room_id)
 void
 Cache::removePendingReceipt(lmdb::txn &txn, const std::string &room_id, const std::string &event_id)
 {
-        auto db = getPendingReceiptsDb(txn);
-
         ReadReceiptKey receipt_key{event_id, room_id};
         auto key = json(receipt_key).dump();
 
         try {
-                lmdb::dbi_del(txn, db, lmdb::val(key.data(), key.size()), nullptr);
+                lmdb::dbi_del(txn, pendingReceiptsDb_, lmdb::val(key.data(), key.size()), nullptr);
         } catch (const lmdb::error &e) {
                 nhlog::db()->critical("removePendingReceipt: {}", e.what());
         }
@@ -746,23 +1851,23 @@ Cache::removePendingReceipt(lmdb::txn &txn, const std::string &room_id, const st
 void
 Cache::addPendingReceipt(const QString &room_id, const QString &event_id)
 {
-        auto txn = lmdb::txn::begin(env_);
-        auto db  = getPendingReceiptsDb(txn);
-
         ReadReceiptKey receipt_key{event_id.toStdString(), room_id.toStdString()};
         auto key = json(receipt_key).dump();
-        std::string empty;
 
-        try {
-                lmdb::dbi_put(txn,
-                              db,
-                              lmdb::val(key.data(), key.size()),
-                              lmdb::val(empty.data(), empty.size()));
-        } catch (const lmdb::error &e) {
-                nhlog::db()->critical("addPendingReceipt: {}", e.what());
-        }
+        queueWrite("pending_receipt/" + key,
+                   [this, key](lmdb::txn &txn) {
+                           std::string empty;
 
-        txn.commit();
+                           try {
+                                   lmdb::dbi_put(txn,
+                                                 pendingReceiptsDb_,
+                                                 lmdb::val(key.data(), key.size()),
+                                                 lmdb::val(empty.data(), empty.size()));
+                           } catch (const lmdb::error &e) {
+                                   nhlog::db()->critical("addPendingReceipt: {}", e.what());
+                           }
+                   },
+                   key.size());
 }
 
 CachedReceipts
@@ -774,7 +1879,7 @@ Cache::readReceipts(const QString &event_id, const QString &room_id)
         nlohmann::json json_key = receipt_key;
 
         try {
-                auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+                auto txn = readTxn();
                 auto key = json_key.dump();
 
                 lmdb::val value;
@@ -782,8 +1887,6 @@ Cache::readReceipts(const QString &event_id, const QString &room_id)
                 bool res =
                   lmdb::dbi_get(txn, readReceiptsDb_, lmdb::val(key.data(), key.size()), value);
 
-                txn.commit();
-
                 if (res) {
                         auto json_response = json::parse(std::string(value.data(), value.size()));
                         auto values        = json_response.get<std::map<std::string, uint64_t>>();
@@ -876,6 +1979,8 @@ Cache::updateReadReceipt(lmdb::txn &txn, const std::string &room_id, const Recei
 void
 Cache::notifyForReadReceipts(const std::string &room_id)
 {
+        commitQueuedWrites();
+
         auto txn = lmdb::txn::begin(env_);
 
         QSettings settings;
@@ -910,13 +2015,19 @@ Cache::calculateRoomReadStatus()
 bool
 Cache::calculateRoomReadStatus(const std::string &room_id)
 {
-        auto txn = lmdb::txn::begin(env_);
+        std::string last_event_id;
 
-        // Get last event id on the room.
-        const auto last_event_id = getLastMessageInfo(txn, room_id).event_id;
-        const auto localUser     = utils::localUser().toStdString();
+        try {
+                auto txn = readTxn();
 
-        txn.commit();
+                // Get last event id on the room.
+                last_event_id = getLastMessageInfo(txn, room_id).event_id;
+        } catch (const lmdb::error &e) {
+                nhlog::db()->warn("failed to read the last message of {}: {}", room_id, e.what());
+                return false;
+        }
+
+        const auto localUser = utils::localUser().toStdString();
 
         // Retrieve all read receipts for that event.
         const auto receipts = readReceipts(last_event_id, QString::fromStdString(room_id));
@@ -938,14 +2049,32 @@ Cache::saveState(const mtx::responses::Sync &res)
 {
         using namespace mtx::events;
 
+        std::vector<std::string> dbs;
+        for (const auto &room : res.rooms.join) {
+                const auto names = roomDbs(room.first);
+                dbs.insert(dbs.end(), names.begin(), names.end());
+        }
+        for (const auto &room : res.rooms.invite) {
+                const auto names = inviteDbs(room.first);
+                dbs.insert(dbs.end(), names.begin(), names.end());
+        }
+
+        createDbs(dbs);
+
         auto txn = lmdb::txn::begin(env_);
 
+        // The server won't send the to_device messages again once we move past that token.
+        savePendingToDevice(txn, res.to_device);
         setNextBatchToken(txn, res.next_batch);
 
+        // The device lists of these users have changed since the last sync.
+        invalidateDeviceLists(txn, res.device_lists.changed);
+        invalidateDeviceLists(txn, res.device_lists.left);
+
         // Save joined rooms
         for (const auto &room : res.rooms.join) {
-                auto statesdb  = getStatesDb(txn, room.first);
-                auto membersdb = getMembersDb(txn, room.first);
+                auto statesdb  = getStatesDb(room.first);
+                auto membersdb = getMembersDb(room.first);
 
                 saveStateEvents(txn, statesdb, membersdb, room.first, room.second.state.events);
                 saveStateEvents(txn, statesdb, membersdb, room.first, room.second.timeline.events);
@@ -1003,6 +2132,17 @@ Cache::saveState(const mtx::responses::Sync &res)
 
         txn.commit();
 
+        if (!res.to_device.empty())
+                syncToDisk();
+
+        {
+                std::unique_lock<std::mutex> lock(retentionMtx_);
+                for (const auto &room : res.rooms.join) {
+                        if (!room.second.timeline.events.empty())
+                                dirtyRooms_.insert(room.first);
+                }
+        }
+
         std::map<QString, bool> readStatus;
 
         for (const auto &room : res.rooms.join) {
@@ -1018,8 +2158,8 @@ void
 Cache::saveInvites(lmdb::txn &txn, const std::map<std::string, mtx::responses::InvitedRoom> &rooms)
 {
         for (const auto &room : rooms) {
-                auto statesdb  = getInviteStatesDb(txn, room.first);
-                auto membersdb = getInviteMembersDb(txn, room.first);
+                auto statesdb  = getInviteStatesDb(room.first);
+                auto membersdb = getInviteMembersDb(room.first);
 
                 saveInvite(txn, statesdb, membersdb, room.second);
 
@@ -1133,8 +2273,9 @@ Cache::roomsWithTagUpdates(const mtx::responses::Sync &res)
 RoomInfo
 Cache::singleRoomInfo(const std::string &room_id)
 {
-        auto txn      = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
-        auto statesdb = getStatesDb(txn, room_id);
+        auto statesdb  = getStatesDb(room_id);
+        auto membersdb = getMembersDb(room_id);
+        auto txn       = readTxn();
 
         lmdb::val data;
 
@@ -1142,12 +2283,10 @@ Cache::singleRoomInfo(const std::string &room_id)
         if (lmdb::dbi_get(txn, roomsDb_, lmdb::val(room_id), data)) {
                 try {
                         RoomInfo tmp     = json::parse(std::string(data.data(), data.size()));
-                        tmp.member_count = getMembersDb(txn, room_id).size(txn);
+                        tmp.member_count = membersdb.size(txn);
                         tmp.join_rule    = getRoomJoinRule(txn, statesdb);
                         tmp.guest_access = getRoomGuestAccess(txn, statesdb);
 
-                        txn.commit();
-
                         return tmp;
                 } catch (const json::exception &e) {
                         nhlog::db()->warn("failed to parse room info: room_id ({}), {}",
@@ -1156,8 +2295,6 @@ Cache::singleRoomInfo(const std::string &room_id)
                 }
         }
 
-        txn.commit();
-
         return RoomInfo();
 }
 
@@ -1166,18 +2303,18 @@ Cache::getRoomInfo(const std::vector<std::string> &rooms)
 {
         std::map<QString, RoomInfo> room_info;
 
-        // TODO This should be read only.
-        auto txn = lmdb::txn::begin(env_);
+        auto txn = readTxn();
 
         for (const auto &room : rooms) {
                 lmdb::val data;
-                auto statesdb = getStatesDb(txn, room);
 
                 // Check if the room is joined.
                 if (lmdb::dbi_get(txn, roomsDb_, lmdb::val(room), data)) {
                         try {
+                                auto statesdb = getStatesDb(room);
+
                                 RoomInfo tmp = json::parse(std::string(data.data(), data.size()));
-                                tmp.member_count = getMembersDb(txn, room).size(txn);
+                                tmp.member_count = getMembersDb(room).size(txn);
                                 tmp.join_rule    = getRoomJoinRule(txn, statesdb);
                                 tmp.guest_access = getRoomGuestAccess(txn, statesdb);
 
@@ -1193,7 +2330,7 @@ Cache::getRoomInfo(const std::vector<std::string> &rooms)
                                 try {
                                         RoomInfo tmp =
                                           json::parse(std::string(data.data(), data.size()));
-                                        tmp.member_count = getInviteMembersDb(txn, room).size(txn);
+                                        tmp.member_count = getInviteMembersDb(room).size(txn);
 
                                         room_info.emplace(QString::fromStdString(room),
                                                           std::move(tmp));
@@ -1207,33 +2344,171 @@ Cache::getRoomInfo(const std::vector<std::string> &rooms)
                 }
         }
 
-        txn.commit();
+        return room_info;
+}
+
+std::map<QString, mtx::responses::Timeline>
+Cache::roomMessages()
+{
+        auto txn = readTxn();
+
+        std::map<QString, mtx::responses::Timeline> msgs;
+        std::string room_id, unused;
+
+        auto roomsCursor = lmdb::cursor::open(txn, roomsDb_);
+        while (roomsCursor.get(room_id, unused, MDB_NEXT))
+                msgs.emplace(QString::fromStdString(room_id), mtx::responses::Timeline());
+
+        roomsCursor.close();
+
+        return msgs;
+}
+
+HistoryPage
+Cache::readHistory(const std::string &room_id, const std::string &before, std::size_t limit)
+{
+        HistoryPage page;
+
+        try {
+                auto db     = getMessagesDb(room_id);
+                auto txn    = readTxn();
+                auto cursor = lmdb::cursor::open(txn, db);
+
+                lmdb::val key, msg;
+
+                // The message we start from is already displayed. Only its markers matter.
+                bool anchor = !before.empty();
+                bool found  = anchor ? seekMessage(cursor, before, key, msg)
+                                    : cursor.get(key, msg, MDB_FIRST);
+
+                while (found) {
+                        const auto obj = json::parse(std::string(msg.data(), msg.size()));
+
+                        if (!anchor) {
+                                mtx::events::collections::TimelineEvent event;
+                                mtx::events::collections::from_json(obj.at("event"), event);
+
+                                page.events.push_back(std::move(event.data));
+                        }
+
+                        anchor          = false;
+                        page.prev_batch = obj.value("token", "");
+                        page.gap        = obj.value("gap", false);
+                        page.complete   = obj.value("start", false);
+
+                        if (page.gap || page.complete || page.events.size() >= limit)
+                                break;
+
+                        found = cursor.get(key, msg, MDB_NEXT);
+                }
+
+                // Anything older than the stored messages has to come from the server.
+                if (!found)
+                        page.gap = true;
+
+                cursor.close();
+        } catch (const lmdb::error &) {
+                // Nothing was stored for the room yet.
+                page.gap = true;
+        } catch (const json::exception &e) {
+                nhlog::db()->warn("failed to read the history of {}: {}", room_id, e.what());
+                page.gap = true;
+        }
+
+        return page;
+}
+
+void
+Cache::saveHistory(const std::string &room_id,
+                   const std::string &anchor,
+                   const mtx::responses::Messages &res)
+{
+        using namespace mtx::events;
+
+        const bool start = res.end.empty() || res.end == res.start;
+
+        createDbs(roomDbs(room_id));
+
+        auto txn = lmdb::txn::begin(env_);
+        auto db  = getMessagesDb(room_id);
+
+        // The response picks up right before the message it was requested from.
+        if (!anchor.empty()) {
+                auto cursor = lmdb::cursor::open(txn, db);
+
+                lmdb::val key, msg;
+                if (seekMessage(cursor, anchor, key, msg)) {
+                        const auto found = std::string(key.data(), key.size());
+                        cursor.close();
+
+                        markMessage(txn, db, found, false, start && res.chunk.empty());
+                } else {
+                        cursor.close();
+                }
+        }
+
+        // The redactions come before the older events they apply to.
+        std::set<std::string> redacted;
+        for (const auto &e : res.chunk) {
+                if (auto redaction = boost::get<RedactionEvent<msg::Redaction>>(&e)) {
+                        redacted.insert(redaction->redacts);
+                        redactMessage(txn, db, redaction->redacts);
+                }
+        }
 
-        return room_info;
-}
+        // The chunk is ordered from the newest to the oldest event.
+        std::vector<std::pair<std::string, const collections::TimelineEvents *>> events;
+        for (const auto &e : res.chunk) {
+                if (isStateEvent(e))
+                        continue;
 
-std::map<QString, mtx::responses::Timeline>
-Cache::roomMessages()
-{
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+                if (boost::get<RedactionEvent<msg::Redaction>>(&e) != nullptr)
+                        continue;
 
-        std::map<QString, mtx::responses::Timeline> msgs;
-        std::string room_id, unused;
+                if (redacted.count(utils::event_id(e)) != 0)
+                        continue;
 
-        auto roomsCursor = lmdb::cursor::open(txn, roomsDb_);
-        while (roomsCursor.get(room_id, unused, MDB_NEXT))
-                msgs.emplace(QString::fromStdString(room_id), mtx::responses::Timeline());
+                events.emplace_back(message_key(utils::event_timestamp(e), utils::event_id(e)),
+                                    &e);
+        }
+
+        lmdb::val unused;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+                const auto &key  = events[i].first;
+                const bool known = lmdb::dbi_get(txn, db, lmdb::val(key), unused);
+                const bool last  = i + 1 == events.size();
+
+                // A stored message that is followed by older ones is no longer a gap.
+                // The oldest one keeps its markers since nothing is known past it.
+                if (known) {
+                        if (!last)
+                                markMessage(txn, db, key, false, false);
+                        continue;
+                }
+
+                json obj = json::object();
+
+                obj["event"] = utils::serialize_event(*events[i].second);
+                obj["token"] = res.end;
+
+                if (last && start)
+                        obj["start"] = true;
+                else if (last)
+                        obj["gap"] = true;
+
+                lmdb::dbi_put(txn, db, lmdb::val(key), lmdb::val(obj.dump()));
+        }
 
-        roomsCursor.close();
         txn.commit();
 
-        return msgs;
+        std::unique_lock<std::mutex> lock(retentionMtx_);
+        dirtyRooms_.insert(room_id);
 }
 
 mtx::responses::Timeline
 Cache::getTimelineMessages(lmdb::txn &txn, const std::string &room_id)
 {
-        auto db = getMessagesDb(txn, room_id);
+        auto db = getMessagesDb(room_id);
 
         mtx::responses::Timeline timeline;
         std::string timestamp, msg;
@@ -1268,7 +2543,7 @@ Cache::roomInfo(bool withInvites)
 {
         QMap<QString, RoomInfo> result;
 
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn = readTxn();
 
         std::string room_id;
         std::string room_data;
@@ -1277,7 +2552,7 @@ Cache::roomInfo(bool withInvites)
         auto roomsCursor = lmdb::cursor::open(txn, roomsDb_);
         while (roomsCursor.get(room_id, room_data, MDB_NEXT)) {
                 RoomInfo tmp     = json::parse(std::move(room_data));
-                tmp.member_count = getMembersDb(txn, room_id).size(txn);
+                tmp.member_count = getMembersDb(room_id).size(txn);
                 tmp.msgInfo      = getLastMessageInfo(txn, room_id);
 
                 result.insert(QString::fromStdString(std::move(room_id)), std::move(tmp));
@@ -1289,21 +2564,19 @@ Cache::roomInfo(bool withInvites)
                 auto invitesCursor = lmdb::cursor::open(txn, invitesDb_);
                 while (invitesCursor.get(room_id, room_data, MDB_NEXT)) {
                         RoomInfo tmp     = json::parse(room_data);
-                        tmp.member_count = getInviteMembersDb(txn, room_id).size(txn);
+                        tmp.member_count = getInviteMembersDb(room_id).size(txn);
                         result.insert(QString::fromStdString(std::move(room_id)), std::move(tmp));
                 }
                 invitesCursor.close();
         }
 
-        txn.commit();
-
         return result;
 }
 
 DescInfo
 Cache::getLastMessageInfo(lmdb::txn &txn, const std::string &room_id)
 {
-        auto db = getMessagesDb(txn, room_id);
+        auto db = getMessagesDb(room_id);
 
         if (db.size(txn) == 0)
                 return DescInfo{};
@@ -1337,7 +2610,7 @@ Cache::invites()
 {
         std::map<QString, bool> result;
 
-        auto txn    = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn    = readTxn();
         auto cursor = lmdb::cursor::open(txn, invitesDb_);
 
         std::string room_id, unused;
@@ -1346,7 +2619,6 @@ Cache::invites()
                 result.emplace(QString::fromStdString(std::move(room_id)), true);
 
         cursor.close();
-        txn.commit();
 
         return result;
 }
@@ -1667,14 +2939,12 @@ Cache::getRoomAvatar(const QString &room_id)
 QImage
 Cache::getRoomAvatar(const std::string &room_id)
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn = readTxn();
 
         lmdb::val response;
 
-        if (!lmdb::dbi_get(txn, roomsDb_, lmdb::val(room_id), response)) {
-                txn.commit();
+        if (!lmdb::dbi_get(txn, roomsDb_, lmdb::val(room_id), response))
                 return QImage();
-        }
 
         std::string media_url;
 
@@ -1682,22 +2952,16 @@ Cache::getRoomAvatar(const std::string &room_id)
                 RoomInfo info = json::parse(std::string(response.data(), response.size()));
                 media_url     = std::move(info.avatar_url);
 
-                if (media_url.empty()) {
-                        txn.commit();
+                if (media_url.empty())
                         return QImage();
-                }
         } catch (const json::exception &e) {
                 nhlog::db()->warn("failed to parse room info: {}, {}",
                                   e.what(),
                                   std::string(response.data(), response.size()));
         }
 
-        if (!lmdb::dbi_get(txn, mediaDb_, lmdb::val(media_url), response)) {
-                txn.commit();
+        if (!lmdb::dbi_get(txn, mediaDb_, lmdb::val(media_url), response))
                 return QImage();
-        }
-
-        txn.commit();
 
         return QImage::fromData(QByteArray(response.data(), response.size()));
 }
@@ -1705,7 +2969,7 @@ Cache::getRoomAvatar(const std::string &room_id)
 std::vector<std::string>
 Cache::joinedRooms()
 {
-        auto txn         = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn         = readTxn();
         auto roomsCursor = lmdb::cursor::open(txn, roomsDb_);
 
         std::string id, data;
@@ -1716,23 +2980,40 @@ Cache::joinedRooms()
                 room_ids.emplace_back(id);
 
         roomsCursor.close();
-        txn.commit();
 
         return room_ids;
 }
 
+void
+Cache::openRoomDbs()
+{
+        std::vector<std::string> dbs;
+
+        for (const auto &room : joinedRooms()) {
+                const auto names = roomDbs(room);
+                dbs.insert(dbs.end(), names.begin(), names.end());
+        }
+
+        for (const auto &room : invites()) {
+                const auto names = inviteDbs(room.first.toStdString());
+                dbs.insert(dbs.end(), names.begin(), names.end());
+        }
+
+        createDbs(dbs);
+}
+
 void
 Cache::populateMembers()
 {
         auto rooms = joinedRooms();
         nhlog::db()->info("loading {} rooms", rooms.size());
 
-        auto txn = lmdb::txn::begin(env_);
+        auto txn = readTxn();
 
         for (const auto &room : rooms) {
                 const auto roomid = QString::fromStdString(room);
 
-                auto membersdb = getMembersDb(txn, room);
+                auto membersdb = getMembersDb(room);
                 auto cursor    = lmdb::cursor::open(txn, membersdb);
 
                 std::string user_id, info;
@@ -1747,120 +3028,93 @@ Cache::populateMembers()
 
                 cursor.close();
         }
-
-        txn.commit();
 }
 
-std::vector<RoomSearchResult>
-Cache::searchRooms(const std::string &query, std::uint8_t max_items)
+std::vector<SearchCandidate>
+Cache::roomSearchCandidates()
 {
-        std::multimap<int, std::pair<std::string, RoomInfo>> items;
+        std::vector<SearchCandidate> candidates;
 
-        auto txn    = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        auto txn    = readTxn();
         auto cursor = lmdb::cursor::open(txn, roomsDb_);
 
         std::string room_id, room_data;
         while (cursor.get(room_id, room_data, MDB_NEXT)) {
-                RoomInfo tmp = json::parse(std::move(room_data));
+                try {
+                        RoomInfo tmp = json::parse(std::move(room_data));
 
-                const int score = utils::levenshtein_distance(
-                  query, QString::fromStdString(tmp.name).toLower().toStdString());
-                items.emplace(score, std::make_pair(room_id, tmp));
+                        auto key = QString::fromStdString(tmp.name).toLower().toStdString();
+                        candidates.push_back(
+                          SearchCandidate{room_id, std::move(key), tmp.name, tmp.avatar_url});
+                } catch (const json::exception &e) {
+                        nhlog::db()->warn("failed to parse room info: {}, {}", room_id, e.what());
+                }
         }
 
         cursor.close();
 
-        auto end = items.begin();
-
-        if (items.size() >= max_items)
-                std::advance(end, max_items);
-        else if (items.size() > 0)
-                std::advance(end, items.size());
-
-        std::vector<RoomSearchResult> results;
-        for (auto it = items.begin(); it != end; it++) {
-                results.push_back(
-                  RoomSearchResult{it->second.first,
-                                   it->second.second,
-                                   QImage::fromData(image(txn, it->second.second.avatar_url))});
-        }
-
-        txn.commit();
-
-        return results;
+        return candidates;
 }
 
-QVector<SearchResult>
-Cache::searchUsers(const std::string &room_id, const std::string &query, std::uint8_t max_items)
+std::vector<SearchCandidate>
+Cache::userSearchCandidates(const std::string &room_id)
 {
-        std::multimap<int, std::pair<std::string, std::string>> items;
+        std::vector<SearchCandidate> candidates;
 
-        auto txn    = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
-        auto cursor = lmdb::cursor::open(txn, getMembersDb(txn, room_id));
+        auto db     = getMembersDb(room_id);
+        auto txn    = readTxn();
+        auto cursor = lmdb::cursor::open(txn, db);
 
         std::string user_id, user_data;
         while (cursor.get(user_id, user_data, MDB_NEXT)) {
                 const auto display_name = displayName(room_id, user_id);
-                const int score         = utils::levenshtein_distance(query, display_name);
-
-                items.emplace(score, std::make_pair(user_id, display_name));
+                candidates.push_back(SearchCandidate{user_id, display_name, display_name, ""});
         }
 
-        auto end = items.begin();
-
-        if (items.size() >= max_items)
-                std::advance(end, max_items);
-        else if (items.size() > 0)
-                std::advance(end, items.size());
-
-        QVector<SearchResult> results;
-        for (auto it = items.begin(); it != end; it++) {
-                const auto user = it->second;
-                results.push_back(SearchResult{QString::fromStdString(user.first),
-                                               QString::fromStdString(user.second)});
-        }
+        cursor.close();
 
-        return results;
+        return candidates;
 }
 
 std::vector<RoomMember>
-Cache::getMembers(const std::string &room_id, std::size_t startIndex, std::size_t len)
+Cache::getMembers(const std::string &room_id, const std::string &after, std::size_t len)
 {
-        auto txn    = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
-        auto db     = getMembersDb(txn, room_id);
+        auto db     = getMembersDb(room_id);
+        auto txn    = readTxn();
         auto cursor = lmdb::cursor::open(txn, db);
 
-        std::size_t currentIndex = 0;
-
-        const auto endIndex = std::min(startIndex + len, db.size(txn));
-
         std::vector<RoomMember> members;
+        members.reserve(len);
 
-        std::string user_id, user_data;
-        while (cursor.get(user_id, user_data, MDB_NEXT)) {
-                if (currentIndex < startIndex) {
-                        currentIndex += 1;
-                        continue;
-                }
+        lmdb::val user_id, user_data;
 
-                if (currentIndex >= endIndex)
-                        break;
+        // Pages resume from the last member of the previous one, so the cursor never has to
+        // walk over the members that were already returned.
+        bool found;
+        if (after.empty()) {
+                found = cursor.get(user_id, user_data, MDB_FIRST);
+        } else {
+                user_id = lmdb::val(after);
+                found   = cursor.get(user_id, user_data, MDB_SET_RANGE);
+
+                if (found && std::string(user_id.data(), user_id.size()) == after)
+                        found = cursor.get(user_id, user_data, MDB_NEXT);
+        }
 
+        for (; found && members.size() < len; found = cursor.get(user_id, user_data, MDB_NEXT)) {
                 try {
-                        MemberInfo tmp = json::parse(user_data);
+                        MemberInfo tmp = json::parse(
+                          std::string(user_data.data(), user_data.size()));
                         members.emplace_back(
-                          RoomMember{QString::fromStdString(user_id),
+                          RoomMember{QString::fromUtf8(user_id.data(), user_id.size()),
                                      QString::fromStdString(tmp.name),
-                                     QImage::fromData(image(txn, tmp.avatar_url))});
+                                     QString::fromStdString(tmp.avatar_url)});
                 } catch (const json::exception &e) {
                         nhlog::db()->warn("{}", e.what());
                 }
-
-                currentIndex += 1;
         }
 
         cursor.close();
-        txn.commit();
 
         return members;
 }
@@ -1868,14 +3122,16 @@ Cache::getMembers(const std::string &room_id, std::size_t startIndex, std::size_
 bool
 Cache::isRoomMember(const std::string &user_id, const std::string &room_id)
 {
-        auto txn = lmdb::txn::begin(env_);
-        auto db  = getMembersDb(txn, room_id);
-
-        lmdb::val value;
-        bool res = lmdb::dbi_get(txn, db, lmdb::val(user_id), value);
-        txn.commit();
+        try {
+                auto db  = getMembersDb(room_id);
+                auto txn = readTxn();
 
-        return res;
+                lmdb::val value;
+                return lmdb::dbi_get(txn, db, lmdb::val(user_id), value);
+        } catch (const lmdb::error &) {
+                // Unknown room.
+                return false;
+        }
 }
 
 void
@@ -1883,56 +3139,76 @@ Cache::saveTimelineMessages(lmdb::txn &txn,
                             const std::string &room_id,
                             const mtx::responses::Timeline &res)
 {
-        auto db = getMessagesDb(txn, room_id);
+        auto db = getMessagesDb(room_id);
 
         using namespace mtx::events;
         using namespace mtx::events::state;
 
+        // Nothing before a limited batch is known, and neither is before the first one.
+        bool gap = res.limited || db.size(txn) == 0;
+
         for (const auto &e : res.events) {
                 if (isStateEvent(e))
                         continue;
 
-                if (boost::get<RedactionEvent<msg::Redaction>>(&e) != nullptr)
+                // The redacted message is gone from the timeline of a view that is
+                // rebuilt from the cache as well.
+                if (auto redaction = boost::get<RedactionEvent<msg::Redaction>>(&e)) {
+                        redactMessage(txn, db, redaction->redacts);
                         continue;
+                }
 
                 json obj = json::object();
 
                 obj["event"] = utils::serialize_event(e);
                 obj["token"] = res.prev_batch;
 
-                lmdb::dbi_put(txn,
-                              db,
-                              lmdb::val(std::to_string(utils::event_timestamp(e))),
-                              lmdb::val(obj.dump()));
+                // The oldest event of the batch carries the gap.
+                if (gap)
+                        obj["gap"] = true;
+                gap = false;
+
+                const auto key = message_key(utils::event_timestamp(e), utils::event_id(e));
+                lmdb::dbi_put(txn, db, lmdb::val(key), lmdb::val(obj.dump()));
         }
 }
 
 void
 Cache::markSentNotification(const std::string &event_id)
 {
-        auto txn = lmdb::txn::begin(env_);
-        lmdb::dbi_put(txn, notificationsDb_, lmdb::val(event_id), lmdb::val(std::string("")));
-        txn.commit();
+        // The time of the notification is kept for the retention.
+        const auto sent_at = std::to_string(QDateTime::currentMSecsSinceEpoch());
+
+        queueWrite("notification/" + event_id,
+                   [this, event_id, sent_at](lmdb::txn &txn) {
+                           lmdb::dbi_put(
+                             txn, notificationsDb_, lmdb::val(event_id), lmdb::val(sent_at));
+                   },
+                   event_id.size() + sent_at.size());
+
+        std::unique_lock<std::mutex> lock(retentionMtx_);
+        notificationsDirty_ = true;
 }
 
 void
 Cache::removeReadNotification(const std::string &event_id)
 {
-        auto txn = lmdb::txn::begin(env_);
-
-        lmdb::dbi_del(txn, notificationsDb_, lmdb::val(event_id), nullptr);
-
-        txn.commit();
+        queueWrite("notification/" + event_id,
+                   [this, event_id](lmdb::txn &txn) {
+                           lmdb::dbi_del(txn, notificationsDb_, lmdb::val(event_id), nullptr);
+                   },
+                   event_id.size());
 }
 
 bool
 Cache::isNotificationSent(const std::string &event_id)
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
+        commitQueuedWrites();
+
+        auto txn = readTxn();
 
         lmdb::val value;
         bool res = lmdb::dbi_get(txn, notificationsDb_, lmdb::val(event_id), value);
-        txn.commit();
 
         return res;
 }
@@ -1940,8 +3216,7 @@ Cache::isNotificationSent(const std::string &event_id)
 std::vector<std::string>
 Cache::getRoomIds(lmdb::txn &txn)
 {
-        auto db     = lmdb::dbi::open(txn, ROOMS_DB, MDB_CREATE);
-        auto cursor = lmdb::cursor::open(txn, db);
+        auto cursor = lmdb::cursor::open(txn, roomsDb_);
 
         std::vector<std::string> rooms;
 
@@ -1954,48 +3229,312 @@ Cache::getRoomIds(lmdb::txn &txn)
         return rooms;
 }
 
+//
+// Retention
+//
+
+RetentionPolicy
+Cache::retentionPolicy(const std::string &room_id)
+{
+        try {
+                auto txn = readTxn();
+
+                lmdb::val data;
+                if (lmdb::dbi_get(txn, retentionDb_, lmdb::val(room_id), data))
+                        return json::parse(std::string(data.data(), data.size()));
+        } catch (const lmdb::error &e) {
+                nhlog::db()->warn("failed to read retention policy of {}: {}", room_id, e.what());
+        } catch (const json::exception &e) {
+                nhlog::db()->warn("failed to parse retention policy of {}: {}", room_id, e.what());
+        }
+
+        return defaultRetention_;
+}
+
+void
+Cache::setRetentionPolicy(const std::string &room_id, const RetentionPolicy &policy)
+{
+        auto txn = lmdb::txn::begin(env_);
+        lmdb::dbi_put(txn, retentionDb_, lmdb::val(room_id), lmdb::val(json(policy).dump()));
+        txn.commit();
+
+        // Apply the new policy on the next pass.
+        std::unique_lock<std::mutex> lock(retentionMtx_);
+        dirtyRooms_.insert(room_id);
+}
+
 void
-Cache::deleteOldMessages()
+Cache::scheduleRetention()
 {
-        auto txn      = lmdb::txn::begin(env_);
-        auto room_ids = getRoomIds(txn);
+        std::unique_lock<std::mutex> lock(retentionMtx_);
 
-        for (const auto &id : room_ids) {
-                auto msg_db = getMessagesDb(txn, id);
+        const bool pending = !dirtyRooms_.empty() || notificationsDirty_ ||
+                             mediaBytesSinceSweep_ >= MEDIA_SWEEP_THRESHOLD;
 
-                std::string ts, event;
-                uint64_t idx = 0;
+        // Changes made while a pass is running are picked up by the next one.
+        if (!pending || retention_.isRunning())
+                return;
 
-                const auto db_size = msg_db.size(txn);
-                if (db_size <= 3 * MAX_RESTORED_MESSAGES)
-                        continue;
+        retention_ = QtConcurrent::run([this]() { runRetention(); });
+}
+
+void
+Cache::runRetention(bool allRooms) noexcept
+{
+        std::set<std::string> rooms;
+        bool notifications = allRooms;
+        bool media         = allRooms;
+
+        {
+                std::unique_lock<std::mutex> lock(retentionMtx_);
+                std::swap(rooms, dirtyRooms_);
+
+                notifications = notifications || notificationsDirty_;
+                media         = media || mediaBytesSinceSweep_ >= MEDIA_SWEEP_THRESHOLD;
+
+                notificationsDirty_ = false;
+                if (media)
+                        mediaBytesSinceSweep_ = 0;
+        }
+
+        try {
+                if (allRooms) {
+                        for (const auto &room_id : joinedRooms())
+                                rooms.insert(room_id);
+                }
+
+                // Every room is trimmed in its own transaction to keep the writer available.
+                for (const auto &room_id : rooms)
+                        trimRoom(room_id);
+
+                if (notifications)
+                        trimNotifications();
+
+                if (media)
+                        sweepMedia();
+        } catch (const lmdb::error &e) {
+                nhlog::db()->error("failed to apply the retention policies: {}", e.what());
+        } catch (const json::exception &e) {
+                nhlog::db()->error("failed to apply the retention policies: {}", e.what());
+        }
+}
+
+void
+Cache::trimRoom(const std::string &room_id)
+{
+        const auto policy = retentionPolicy(room_id);
+
+        const auto noLimit     = std::numeric_limits<std::size_t>::max();
+        const auto maxMessages = std::min(
+          policy.max_messages > 0 ? policy.max_messages : noLimit, maxStoredMessages());
+        const auto maxBytes    = policy.max_bytes > 0 ? policy.max_bytes : noLimit;
+        const auto maxAge      = std::chrono::milliseconds(policy.max_age).count();
+        const auto oldest      = maxAge > 0 ? QDateTime::currentMSecsSinceEpoch() - maxAge : 0;
+
+        // Message keys of the expired messages along with their event ids.
+        std::vector<std::pair<std::string, std::string>> expired;
+
+        {
+                auto db  = getMessagesDb(room_id);
+                auto txn = readTxn();
+
+                std::size_t count = db.size(txn);
+                std::size_t bytes = policy.max_bytes > 0 ? databaseSize(txn, db) : 0;
+
+                // Messages are sorted from the newest to the oldest.
+                auto cursor = lmdb::cursor::open(txn, db);
+
+                std::string key, msg;
+                auto op = MDB_LAST;
+                while (cursor.get(key, msg, op)) {
+                        op = MDB_PREV;
 
-                nhlog::db()->info("[{}] message count: {}", id, db_size);
+                        // The key starts with the timestamp of the message.
+                        const bool tooOld = oldest > 0 && std::stoll(key) < oldest;
+
+                        if (count <= maxMessages && bytes <= maxBytes && !tooOld)
+                                break;
+
+                        std::string event_id;
+                        try {
+                                event_id = json::parse(msg)["event"].value("event_id", "");
+                        } catch (const json::exception &e) {
+                                nhlog::db()->warn("failed to parse stored message: {}", e.what());
+                        }
 
-                auto cursor = lmdb::cursor::open(txn, msg_db);
-                while (cursor.get(ts, event, MDB_NEXT)) {
-                        idx += 1;
+                        expired.emplace_back(key, std::move(event_id));
 
-                        if (idx > MAX_RESTORED_MESSAGES)
-                                lmdb::cursor_del(cursor);
+                        count -= 1;
+                        bytes -= std::min(bytes, key.size() + msg.size());
                 }
 
                 cursor.close();
+        }
+
+        if (expired.empty())
+                return;
+
+        auto db  = getMessagesDb(room_id);
+        auto txn = lmdb::txn::begin(env_);
+
+        for (const auto &msg : expired) {
+                lmdb::dbi_del(txn, db, lmdb::val(msg.first), nullptr);
+
+                if (msg.second.empty())
+                        continue;
+
+                // The receipts of the dropped events won't be displayed anymore.
+                const auto key = json(ReadReceiptKey{msg.second, room_id}).dump();
+                lmdb::dbi_del(txn, readReceiptsDb_, lmdb::val(key), nullptr);
+                lmdb::dbi_del(txn, pendingReceiptsDb_, lmdb::val(key), nullptr);
+        }
+
+        // Scrolling past the remaining messages has to go back to the server.
+        {
+                auto cursor = lmdb::cursor::open(txn, db);
+
+                std::string key, unused;
+                const bool found = cursor.get(key, unused, MDB_LAST);
+                cursor.close();
 
-                nhlog::db()->info("[{}] updated message count: {}", id, msg_db.size(txn));
+                if (found)
+                        markMessage(txn, db, key, true, false);
         }
 
         txn.commit();
+
+        nhlog::db()->debug("[{}] dropped {} messages", room_id, expired.size());
+}
+
+std::size_t
+Cache::maxStoredMessages()
+{
+        auto txn = readTxn();
+
+        const std::size_t rooms = std::max<std::size_t>(1, roomsDb_.size(txn));
+
+        // The timeline of every room can still be restored.
+        return std::max(MAX_RESTORED_MESSAGES, MESSAGES_BYTES / STORED_MESSAGE_BYTES / rooms);
 }
 
 void
-Cache::deleteOldData() noexcept
+Cache::trimNotifications()
 {
-        try {
-                deleteOldMessages();
-        } catch (const lmdb::error &e) {
-                nhlog::db()->error("failed to delete old messages: {}", e.what());
+        // The markers might still be queued.
+        commitQueuedWrites();
+
+        const auto now    = QDateTime::currentMSecsSinceEpoch();
+        const auto oldest = now - std::chrono::milliseconds(NOTIFICATION_RETENTION).count();
+
+        std::vector<std::string> expired, unstamped;
+
+        {
+                auto txn    = readTxn();
+                auto cursor = lmdb::cursor::open(txn, notificationsDb_);
+
+                std::string event_id, sent_at;
+                while (cursor.get(event_id, sent_at, MDB_NEXT)) {
+                        if (sent_at.empty())
+                                unstamped.push_back(event_id);
+                        else if (std::stoll(sent_at) < oldest)
+                                expired.push_back(event_id);
+                }
+
+                cursor.close();
+        }
+
+        if (expired.empty() && unstamped.empty())
+                return;
+
+        auto txn = lmdb::txn::begin(env_);
+
+        for (const auto &event_id : expired)
+                lmdb::dbi_del(txn, notificationsDb_, lmdb::val(event_id), nullptr);
+
+        // Markers from older versions have no time, so they start aging now.
+        const auto stamp = std::to_string(now);
+        for (const auto &event_id : unstamped)
+                lmdb::dbi_put(txn, notificationsDb_, lmdb::val(event_id), lmdb::val(stamp));
+
+        txn.commit();
+
+        nhlog::db()->debug("dropped {} notification markers", expired.size());
+}
+
+void
+Cache::sweepMedia()
+{
+        std::vector<std::string> orphaned;
+
+        {
+                auto txn = readTxn();
+
+                if (databaseSize(txn, mediaDb_) <= MAX_MEDIA_BYTES)
+                        return;
+
+                std::set<std::string> referenced;
+                std::string key, data;
+
+                auto rooms = lmdb::cursor::open(txn, roomsDb_);
+                while (rooms.get(key, data, MDB_NEXT)) {
+                        try {
+                                RoomInfo info = json::parse(data);
+                                referenced.insert(info.avatar_url);
+                        } catch (const json::exception &e) {
+                                nhlog::db()->warn("failed to parse room info: {}", e.what());
+                        }
+
+                        auto members = lmdb::cursor::open(txn, getMembersDb(key));
+
+                        std::string user_id, member;
+                        while (members.get(user_id, member, MDB_NEXT)) {
+                                try {
+                                        MemberInfo info = json::parse(member);
+                                        referenced.insert(info.avatar_url);
+                                } catch (const json::exception &e) {
+                                        nhlog::db()->warn("failed to parse member info: {}",
+                                                          e.what());
+                                }
+                        }
+
+                        members.close();
+                }
+                rooms.close();
+
+                auto invites = lmdb::cursor::open(txn, invitesDb_);
+                while (invites.get(key, data, MDB_NEXT)) {
+                        try {
+                                RoomInfo info = json::parse(data);
+                                referenced.insert(info.avatar_url);
+                        } catch (const json::exception &e) {
+                                nhlog::db()->warn("failed to parse invite info: {}", e.what());
+                        }
+                }
+                invites.close();
+
+                auto pinned = lmdb::cursor::open(txn, pinnedMediaDb_);
+                while (pinned.get(key, data, MDB_NEXT))
+                        referenced.insert(data);
+                pinned.close();
+
+                auto media = lmdb::cursor::open(txn, mediaDb_);
+                while (media.get(key, data, MDB_NEXT)) {
+                        if (referenced.find(key) == referenced.end())
+                                orphaned.push_back(key);
+                }
+                media.close();
+        }
+
+        for (std::size_t start = 0; start < orphaned.size(); start += MEDIA_SWEEP_BATCH_SIZE) {
+                const auto end = std::min(start + MEDIA_SWEEP_BATCH_SIZE, orphaned.size());
+
+                auto txn = lmdb::txn::begin(env_);
+                for (std::size_t i = start; i < end; ++i)
+                        lmdb::dbi_del(txn, mediaDb_, lmdb::val(orphaned[i]), nullptr);
+                txn.commit();
         }
+
+        nhlog::db()->info("dropped {} orphaned media", orphaned.size());
 }
 
 bool
@@ -2006,12 +3545,19 @@ Cache::hasEnoughPowerLevel(const std::vector<mtx::events::EventType> &eventTypes
         using namespace mtx::events;
         using namespace mtx::events::state;
 
-        auto txn = lmdb::txn::begin(env_);
-        auto db  = getStatesDb(txn, room_id);
-
         uint16_t min_event_level = std::numeric_limits<uint16_t>::max();
         uint16_t user_level      = std::numeric_limits<uint16_t>::min();
 
+        lmdb::dbi db{0};
+        try {
+                db = getStatesDb(room_id);
+        } catch (const lmdb::error &) {
+                // Unknown room.
+                return false;
+        }
+
+        auto txn = readTxn();
+
         lmdb::val event;
         bool res = lmdb::dbi_get(txn, db, lmdb::val(to_string(EventType::RoomPowerLevels)), event);
 
@@ -2032,28 +3578,23 @@ Cache::hasEnoughPowerLevel(const std::vector<mtx::events::EventType> &eventTypes
                 }
         }
 
-        txn.commit();
-
         return user_level >= min_event_level;
 }
 
 std::vector<std::string>
 Cache::roomMembers(const std::string &room_id)
 {
-        auto txn = lmdb::txn::begin(env_, nullptr, MDB_RDONLY);
-
         std::vector<std::string> members;
         std::string user_id, unused;
 
-        auto db = getMembersDb(txn, room_id);
+        auto db  = getMembersDb(room_id);
+        auto txn = readTxn();
 
         auto cursor = lmdb::cursor::open(txn, db);
         while (cursor.get(user_id, unused, MDB_NEXT))
                 members.emplace_back(std::move(user_id));
         cursor.close();
 
-        txn.commit();
-
         return members;
 }
 
@@ -21,6 +21,7 @@
 
 #include <QDateTime>
 #include <QDir>
+#include <QFuture>
 #include <QImage>
 #include <QString>
 
@@ -28,8 +29,16 @@
 #include <lmdb++.h>
 #include <mtx/events/join_rules.hpp>
 #include <mtx/responses.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
 #include <mtxclient/crypto/client.hpp>
 #include <mutex>
+#include <set>
+#include <thread>
 
 #include "Logging.h"
 
@@ -39,7 +48,7 @@ struct RoomMember
 {
         QString user_id;
         QString display_name;
-        QImage avatar;
+        QString avatar_url;
 };
 
 struct SearchResult
@@ -48,18 +57,42 @@ struct SearchResult
         QString display_name;
 };
 
+//! An entry of a SearchSession.
+struct SearchCandidate
+{
+        std::string id;
+        //! What the query is matched against.
+        std::string key;
+        std::string name;
+        std::string avatar_url;
+};
+
+//! Key of a stored message. The event id follows the timestamp so that the events
+//! sent in the same millisecond don't replace each other.
+inline std::string
+message_key(uint64_t timestamp, const std::string &event_id)
+{
+        return std::to_string(timestamp) + "|" + event_id;
+}
+
+//! Messages are sorted by timestamp, from the newest to the oldest, and then by event id.
 static int
-numeric_key_comparison(const MDB_val *a, const MDB_val *b)
+message_key_comparison(const MDB_val *a, const MDB_val *b)
 {
-        auto lhs = std::stoull(std::string((char *)a->mv_data, a->mv_size));
-        auto rhs = std::stoull(std::string((char *)b->mv_data, b->mv_size));
+        const std::string lhs((char *)a->mv_data, a->mv_size);
+        const std::string rhs((char *)b->mv_data, b->mv_size);
+
+        const auto lhs_ts = std::stoull(lhs);
+        const auto rhs_ts = std::stoull(rhs);
 
-        if (lhs < rhs)
-                return 1;
-        else if (lhs == rhs)
-                return 0;
+        if (lhs_ts != rhs_ts)
+                return lhs_ts < rhs_ts ? 1 : -1;
 
-        return -1;
+        // Keys from older versions have no event id.
+        const auto lhs_id = lhs.substr(std::min(lhs.find('|'), lhs.size()));
+        const auto rhs_id = rhs.substr(std::min(rhs.find('|'), rhs.size()));
+
+        return rhs_id.compare(lhs_id);
 }
 
 Q_DECLARE_METATYPE(SearchResult)
@@ -178,18 +211,60 @@ struct RoomSearchResult
 {
         std::string room_id;
         RoomInfo info;
-        QImage img;
 };
 
 Q_DECLARE_METATYPE(RoomSearchResult)
 Q_DECLARE_METATYPE(RoomInfo)
 
+//! Stored timeline events of a room, ordered from the newest to the oldest.
+struct HistoryPage
+{
+        std::vector<mtx::events::collections::TimelineEvents> events;
+        //! Pagination token for the events before the oldest one of the page.
+        std::string prev_batch;
+        //! Whether the older events are missing and should be fetched from the server.
+        bool gap = false;
+        //! Whether the page reaches the start of the room.
+        bool complete = false;
+};
+
+//! Limits on the messages the cache keeps for a room. A zero disables a limit.
+struct RetentionPolicy
+{
+        //! Number of the most recent messages to keep.
+        std::size_t max_messages = 0;
+        //! Messages older than this are dropped.
+        std::chrono::seconds max_age{0};
+        //! Approximate size of the stored messages.
+        std::size_t max_bytes = 0;
+};
+
+inline void
+to_json(json &j, const RetentionPolicy &policy)
+{
+        j["max_messages"] = policy.max_messages;
+        j["max_age"]      = policy.max_age.count();
+        j["max_bytes"]    = policy.max_bytes;
+}
+
+inline void
+from_json(const json &j, RetentionPolicy &policy)
+{
+        policy.max_messages = j.value("max_messages", std::size_t(0));
+        policy.max_age      = std::chrono::seconds(j.value("max_age", int64_t(0)));
+        policy.max_bytes    = j.value("max_bytes", std::size_t(0));
+}
+
 // Extra information associated with an outbound megolm session.
 struct OutboundGroupSessionData
 {
         std::string session_id;
         std::string session_key;
         uint64_t message_index = 0;
+        //! When the session was created (ms since the epoch).
+        uint64_t timestamp = 0;
+        //! The devices that have already received the session key. user_id -> device_ids
+        std::map<std::string, std::set<std::string>> shared_with;
 };
 
 inline void
@@ -198,6 +273,8 @@ to_json(nlohmann::json &obj, const OutboundGroupSessionData &msg)
         obj["session_id"]    = msg.session_id;
         obj["session_key"]   = msg.session_key;
         obj["message_index"] = msg.message_index;
+        obj["timestamp"]     = msg.timestamp;
+        obj["shared_with"]   = msg.shared_with;
 }
 
 inline void
@@ -206,8 +283,26 @@ from_json(const nlohmann::json &obj, OutboundGroupSessionData &msg)
         msg.session_id    = obj.at("session_id");
         msg.session_key   = obj.at("session_key");
         msg.message_index = obj.at("message_index");
+
+        // Sessions saved by older versions don't have the following.
+        if (obj.count("timestamp") != 0)
+                msg.timestamp = obj.at("timestamp");
+
+        if (obj.count("shared_with") != 0)
+                msg.shared_with =
+                  obj.at("shared_with").get<std::map<std::string, std::set<std::string>>>();
 }
 
+//! When the outbound megolm sessions of a room should be replaced, as set by its
+//! m.room.encryption state. Zero means the room doesn't say.
+struct MegolmRotation
+{
+        //! Age of the session in milliseconds.
+        uint64_t period_ms = 0;
+        //! Number of messages encrypted with the session.
+        uint64_t period_msgs = 0;
+};
+
 struct OutboundGroupSessionDataRef
 {
         OlmOutboundGroupSession *session;
@@ -234,6 +329,9 @@ from_json(const nlohmann::json &obj, DevicePublicKeys &msg)
         msg.curve25519 = obj.at("curve25519");
 }
 
+//! The verified public keys of all the devices of a user. device_id -> keys
+using DeviceKeysList = std::map<std::string, DevicePublicKeys>;
+
 //! Represents a unique megolm session identifier.
 struct MegolmSessionIndex
 {
@@ -261,6 +359,13 @@ from_json(const nlohmann::json &obj, MegolmSessionIndex &msg)
         msg.sender_key = obj.at("sender_key");
 }
 
+//! Inbound megolm sessions along with their index, waiting to be saved.
+using InboundMegolmSessions =
+  std::vector<std::pair<MegolmSessionIndex, mtx::crypto::InboundGroupSessionPtr>>;
+
+//! An unpickled olm session that is kept in memory.
+using OlmSessionRef = std::shared_ptr<OlmSession>;
+
 struct OlmSessionStorage
 {
         // Megolm sessions
@@ -268,9 +373,49 @@ struct OlmSessionStorage
         std::map<std::string, mtx::crypto::OutboundGroupSessionPtr> group_outbound_sessions;
         std::map<std::string, OutboundGroupSessionData> group_outbound_session_data;
 
+        // Olm sessions by curve25519 key, the most recently used first.
+        std::map<std::string, std::list<OlmSessionRef>> olm_sessions;
+        // Keys of the cached olm sessions, the most recently used first.
+        std::list<std::string> olm_session_keys;
+        // Olm sessions that advanced since they were last persisted.
+        std::map<std::string, std::vector<OlmSessionRef>> modified_olm_sessions;
+
         // Guards for accessing megolm sessions.
         std::mutex group_outbound_mtx;
         std::mutex group_inbound_mtx;
+        // Guard for the olm session cache.
+        std::mutex olm_mtx;
+};
+
+class Cache;
+
+//! A read-only transaction borrowed from the cache's pool.
+//! It's reset and handed back to the pool when it goes out of scope.
+class ReadTxn
+{
+public:
+        ReadTxn(const Cache *cache, lmdb::txn txn);
+        ReadTxn(ReadTxn &&other) = default;
+        ReadTxn &operator=(ReadTxn &&other) = delete;
+        ~ReadTxn();
+
+        operator lmdb::txn &() noexcept { return txn_; }
+        operator MDB_txn *() const noexcept { return txn_.handle(); }
+
+private:
+        const Cache *cache_;
+        lmdb::txn txn_;
+};
+
+//! How the commits of the cache reach the disk.
+enum class Durability
+{
+        //! Every commit is synced to disk.
+        Full,
+        //! The meta page is left to the OS; a crash may undo the last commit.
+        NoMetaSync,
+        //! Commits are synced by a background flusher, bounding the loss to its interval.
+        GroupCommit,
 };
 
 class Cache : public QObject
@@ -279,6 +424,7 @@ class Cache : public QObject
 
 public:
         Cache(const QString &userId, QObject *parent = nullptr);
+        ~Cache() override;
 
         static QHash<QString, QString> DisplayNames;
         static QHash<QString, QString> AvatarUrls;
@@ -297,6 +443,8 @@ public:
                                     const QString &user_id,
                                     const QString &avatar_url);
 
+        //! Open the databases of all the rooms in a single transaction.
+        void openRoomDbs();
         //! Load saved data for the display names & avatars.
         void populateMembers();
         std::vector<std::string> joinedRooms();
@@ -317,10 +465,11 @@ public:
                                  lmdb::dbi &membersdb,
                                  const QString &room_id);
 
-        //! Retrieve member info from a room.
+        //! Retrieve member info from a room, starting after the member with the given id.
+        //! The avatars are left for the caller to resolve.
         std::vector<RoomMember> getMembers(const std::string &room_id,
-                                           std::size_t startIndex = 0,
-                                           std::size_t len        = 30);
+                                           const std::string &after = "",
+                                           std::size_t len          = 30);
 
         void saveState(const mtx::responses::Sync &res);
         bool isInitialized() const;
@@ -336,11 +485,32 @@ public:
         void removeRoom(const QString &roomid) { removeRoom(roomid.toStdString()); };
         void setup();
 
+        //! Commit the queued writes and sync the environment to disk.
+        void flush();
+
+        //! Borrow a read-only transaction, renewing a pooled one when available.
+        //! It never waits on the writer.
+        ReadTxn readTxn() const;
+        //! Return a read-only transaction to the pool.
+        void releaseReadTxn(lmdb::txn txn) const;
+
         bool isFormatValid();
         void setCurrentFormat();
 
         std::map<QString, mtx::responses::Timeline> roomMessages();
 
+        //! Retrieve at most `limit` stored events that are older than the one with the
+        //! given message key. An empty key starts from the newest event. Reading stops at
+        //! the first gap.
+        HistoryPage readHistory(const std::string &room_id,
+                                const std::string &before,
+                                std::size_t limit);
+        //! Store a /messages response that was requested from the event with the given
+        //! message key, closing the gap that was left before it.
+        void saveHistory(const std::string &room_id,
+                         const std::string &anchor,
+                         const mtx::responses::Messages &res);
+
         //! Retrieve all the user ids from a room.
         std::vector<std::string> roomMembers(const std::string &room_id);
 
@@ -381,14 +551,20 @@ public:
         void notifyForReadReceipts(const std::string &room_id);
         std::vector<QString> pendingReceiptsEvents(lmdb::txn &txn, const std::string &room_id);
 
-        QByteArray image(const QString &url) const;
+        QByteArray image(const QString &url);
         QByteArray image(lmdb::txn &txn, const std::string &url) const;
-        QByteArray image(const std::string &url) const
+        QByteArray image(const std::string &url)
         {
                 return image(QString::fromStdString(url));
         }
+        //! Retrieve the stored media of multiple urls within a single transaction.
+        //! Urls that aren't in the cache are left out.
+        std::map<std::string, QByteArray> images(const std::vector<std::string> &urls);
         void saveImage(const std::string &url, const std::string &data);
         void saveImage(const QString &url, const QByteArray &data);
+        //! Keep the media of an avatar that isn't part of any room's state (e.g a community's
+        //! or our own) out of the media sweep. An empty url releases the owner's media.
+        void pinMedia(const std::string &owner, const std::string &url);
 
         RoomInfo singleRoomInfo(const std::string &room_id);
         std::vector<std::string> roomsWithStateUpdates(const mtx::responses::Sync &res);
@@ -408,11 +584,10 @@ public:
         bool calculateRoomReadStatus(const std::string &room_id);
         void calculateRoomReadStatus();
 
-        QVector<SearchResult> searchUsers(const std::string &room_id,
-                                          const std::string &query,
-                                          std::uint8_t max_items = 5);
-        std::vector<RoomSearchResult> searchRooms(const std::string &query,
-                                                  std::uint8_t max_items = 5);
+        //! Members of a room to search for, matched against their display name.
+        std::vector<SearchCandidate> userSearchCandidates(const std::string &room_id);
+        //! Rooms to search for, matched against their lowercase name.
+        std::vector<SearchCandidate> roomSearchCandidates();
 
         void markSentNotification(const std::string &event_id);
         //! Removes an event from the sent notifications.
@@ -420,24 +595,59 @@ public:
         //! Check if we have sent a desktop notification for the given event id.
         bool isNotificationSent(const std::string &event_id);
 
-        //! Remove old unused data.
-        void deleteOldMessages();
-        void deleteOldData() noexcept;
+        //! The retention policy of a room, or the default one if it has none.
+        RetentionPolicy retentionPolicy(const std::string &room_id);
+        void setRetentionPolicy(const std::string &room_id, const RetentionPolicy &policy);
+        //! Trim the data that changed since the last pass on a background thread.
+        //! Does nothing if nothing changed.
+        void scheduleRetention();
+        //! Trim the data that changed since the last pass, or every room when asked.
+        void runRetention(bool allRooms = false) noexcept;
         //! Retrieve all saved room ids.
         std::vector<std::string> getRoomIds(lmdb::txn &txn);
 
-        //! Mark a room that uses e2e encryption.
-        void setEncryptedRoom(lmdb::txn &txn, const std::string &room_id);
+        //! Mark a room that uses e2e encryption, along with the content of its
+        //! m.room.encryption event.
+        void setEncryptedRoom(lmdb::txn &txn,
+                              const std::string &room_id,
+                              const nlohmann::json &content);
         bool isRoomEncrypted(const std::string &room_id);
+        //! The rotation settings from the m.room.encryption event of the room.
+        MegolmRotation megolmRotation(const std::string &room_id);
 
-        //! Save the public keys for a device.
-        void saveDeviceKeys(const std::string &device_id);
-        void getDeviceKeys(const std::string &device_id);
+        //
+        // Device keys
+        //
 
-        //! Save the device list for a user.
-        void setDeviceList(const std::string &user_id, const std::vector<std::string> &devices);
+        //! Save the verified public keys for a device.
+        void saveDeviceKeys(lmdb::txn &txn,
+                            const std::string &user_id,
+                            const std::string &device_id,
+                            const DevicePublicKeys &keys);
+        boost::optional<DevicePublicKeys> getDeviceKeys(lmdb::txn &txn,
+                                                        const std::string &user_id,
+                                                        const std::string &device_id);
+
+        //! Changes every time the device list of the user is invalidated.
+        uint64_t deviceListGeneration(const std::string &user_id);
+        //! Save the device list for a user along with the verified keys of each device.
+        //! Any previously saved devices of the user are replaced.
+        //!
+        //! Nothing is saved if the list was invalidated since the given generation was read,
+        //! as it might be stale by now. Returns whether the list was saved.
+        bool setDeviceList(const std::string &user_id,
+                           const DeviceKeysList &devices,
+                           uint64_t generation);
         std::vector<std::string> getDeviceList(const std::string &user_id);
 
+        //! Retrieve the saved device keys for the given users. Users that don't have
+        //! an up-to-date device list in the cache are appended to `outdated`.
+        std::map<std::string, DeviceKeysList> getDeviceKeys(const std::vector<std::string> &users,
+                                                            std::vector<std::string> &outdated);
+        //! Drop the saved device lists of the given users. The next time we need
+        //! their keys they will be queried again from the server.
+        void invalidateDeviceLists(lmdb::txn &txn, const std::vector<std::string> &users);
+
         //! Check if a user is a member of the room.
         bool isRoomMember(const std::string &user_id, const std::string &room_id);
 
@@ -450,15 +660,27 @@ public:
         OutboundGroupSessionDataRef getOutboundMegolmSession(const std::string &room_id);
         bool outboundMegolmSessionExists(const std::string &room_id) noexcept;
         void updateOutboundMegolmSession(const std::string &room_id, int message_index);
+        //! Record the devices of a user that received the key of the given outbound session.
+        void markOutboundMegolmSessionShared(const std::string &room_id,
+                                             const std::string &session_id,
+                                             const std::string &user_id,
+                                             const std::vector<std::string> &device_ids);
 
-        void importSessionKeys(const mtx::crypto::ExportedSessionKeys &keys);
-        mtx::crypto::ExportedSessionKeys exportSessionKeys();
+        //! Called with the number of processed sessions and the total.
+        using SessionKeysProgress = std::function<void(std::size_t, std::size_t)>;
+
+        //! Import the sessions in chunks, each saved with a single transaction.
+        void importSessionKeys(const mtx::crypto::ExportedSessionKeys &keys,
+                               SessionKeysProgress progress = nullptr);
+        mtx::crypto::ExportedSessionKeys exportSessionKeys(SessionKeysProgress progress = nullptr);
 
         //
         // Inbound Megolm Sessions
         //
         void saveInboundMegolmSession(const MegolmSessionIndex &index,
                                       mtx::crypto::InboundGroupSessionPtr session);
+        //! Save all the given sessions in a single transaction.
+        void saveInboundMegolmSessions(InboundMegolmSessions sessions);
         OlmInboundGroupSession *getInboundMegolmSession(const MegolmSessionIndex &index);
         bool inboundMegolmSessionExists(const MegolmSessionIndex &index);
 
@@ -469,6 +691,18 @@ public:
         std::vector<std::string> getOlmSessions(const std::string &curve25519);
         boost::optional<mtx::crypto::OlmSessionPtr> getOlmSession(const std::string &curve25519,
                                                                   const std::string &session_id);
+        //! The olm sessions with the given key that are kept in memory, most recently used first.
+        std::vector<OlmSessionRef> getCachedOlmSessions(const std::string &curve25519);
+        //! Mark the session as the most recently used one and queue it to be persisted.
+        void touchOlmSession(const std::string &curve25519, OlmSessionRef session);
+        //! Persist the olm sessions with the given keys that advanced since the last call,
+        //! in a single transaction.
+        void flushOlmSessions(const std::vector<std::string> &curve25519_keys);
+
+        //! The to_device messages that were saved with a sync but not processed yet, by key.
+        std::map<std::string, nlohmann::json> pendingToDevice();
+        //! Drop the to_device messages that have been processed.
+        void removePendingToDevice(const std::vector<std::string> &keys);
 
         void saveOlmAccount(const std::string &pickled);
         std::string restoreOlmAccount();
@@ -568,7 +802,9 @@ private:
 
                         return;
                 } else if (boost::get<StateEvent<Encryption>>(&event) != nullptr) {
-                        setEncryptedRoom(txn, room_id);
+                        const auto e = boost::get<StateEvent<Encryption>>(event);
+                        setEncryptedRoom(
+                          txn, room_id, nlohmann::json(e).value("content", nlohmann::json()));
                         return;
                 }
 
@@ -642,50 +878,64 @@ private:
                 }
         }
 
-        lmdb::dbi getPendingReceiptsDb(lmdb::txn &txn)
+        //! Shared handle of a database that already exists. It is opened once, in a
+        //! transaction of its own, and kept for every transaction that follows. LMDB only lets a
+        //! transaction use the handles that existed when it began, so open it before the
+        //! transaction that uses it.
+        lmdb::dbi openDb(const std::string &name);
+        //! Create the databases that don't exist yet and keep their handles.
+        //! It takes the write lock, so the thread must not have a write transaction open.
+        void createDbs(const std::vector<std::string> &names);
+        //! Delete a database along with its handle.
+        void dropDb(lmdb::txn &txn, const std::string &name);
+
+        //! The databases of a joined room.
+        std::vector<std::string> roomDbs(const std::string &room_id)
         {
-                return lmdb::dbi::open(txn, "pending_receipts", MDB_CREATE);
+                return {room_id + "/state", room_id + "/members", room_id + "/messages"};
         }
 
-        lmdb::dbi getMessagesDb(lmdb::txn &txn, const std::string &room_id)
+        //! The databases of an invite.
+        std::vector<std::string> inviteDbs(const std::string &room_id)
         {
-                auto db =
-                  lmdb::dbi::open(txn, std::string(room_id + "/messages").c_str(), MDB_CREATE);
-                lmdb::dbi_set_compare(txn, db, numeric_key_comparison);
-
-                return db;
+                return {room_id + "/invite_state", room_id + "/invite_members"};
         }
 
-        lmdb::dbi getInviteStatesDb(lmdb::txn &txn, const std::string &room_id)
+        lmdb::dbi getMessagesDb(const std::string &room_id)
         {
-                return lmdb::dbi::open(
-                  txn, std::string(room_id + "/invite_state").c_str(), MDB_CREATE);
+                return openDb(room_id + "/messages");
         }
 
-        lmdb::dbi getInviteMembersDb(lmdb::txn &txn, const std::string &room_id)
+        lmdb::dbi getInviteStatesDb(const std::string &room_id)
         {
-                return lmdb::dbi::open(
-                  txn, std::string(room_id + "/invite_members").c_str(), MDB_CREATE);
+                return openDb(room_id + "/invite_state");
         }
 
-        lmdb::dbi getStatesDb(lmdb::txn &txn, const std::string &room_id)
+        lmdb::dbi getInviteMembersDb(const std::string &room_id)
         {
-                return lmdb::dbi::open(txn, std::string(room_id + "/state").c_str(), MDB_CREATE);
+                return openDb(room_id + "/invite_members");
         }
 
-        lmdb::dbi getMembersDb(lmdb::txn &txn, const std::string &room_id)
+        lmdb::dbi getStatesDb(const std::string &room_id) { return openDb(room_id + "/state"); }
+
+        lmdb::dbi getMembersDb(const std::string &room_id)
         {
-                return lmdb::dbi::open(txn, std::string(room_id + "/members").c_str(), MDB_CREATE);
+                return openDb(room_id + "/members");
         }
 
-        //! Retrieves or creates the database that stores the open OLM sessions between our device
-        //! and the given curve25519 key which represents another device.
+        //! The database that stores the open OLM sessions between our device and the given
+        //! curve25519 key which represents another device.
         //!
         //! Each entry is a map from the session_id to the pickled representation of the session.
-        lmdb::dbi getOlmSessionsDb(lmdb::txn &txn, const std::string &curve25519_key)
+        std::string olmSessionsDb(const std::string &curve25519_key)
         {
-                return lmdb::dbi::open(
-                  txn, std::string("olm_sessions/" + curve25519_key).c_str(), MDB_CREATE);
+                return "olm_sessions/" + curve25519_key;
+        }
+
+        //! The key under which the public keys of a device are saved.
+        std::string deviceKeysIndex(const std::string &user_id, const std::string &device_id)
+        {
+                return json{{"user_id", user_id}, {"device_id", device_id}}.dump();
         }
 
         QString getDisplayName(const mtx::events::StateEvent<mtx::events::state::Member> &event)
@@ -696,9 +946,68 @@ private:
                 return QString::fromStdString(event.state_key);
         }
 
+        //! Remove the saved device list of the user along with the keys of the devices.
+        void dropDeviceList(lmdb::txn &txn, const std::string &user_id);
+
+        //! Add the session at the front of the in-memory olm session cache.
+        void cacheOlmSession(const std::string &curve25519, OlmSessionRef session);
+
+        //! Persist the pickled outbound session of a room along with its data.
+        void writeOutboundMegolmSession(const std::string &room_id,
+                                        const OutboundGroupSessionData &data,
+                                        OlmOutboundGroupSession *session);
+
+        //! Keep the to_device messages until they are processed, after the saved ones.
+        void savePendingToDevice(lmdb::txn &txn, const std::vector<nlohmann::json> &msgs);
+
         void setNextBatchToken(lmdb::txn &txn, const std::string &token);
         void setNextBatchToken(lmdb::txn &txn, const QString &token);
 
+        using Write = std::function<void(lmdb::txn &txn)>;
+
+        //! Queue a small write to be committed along with others by the flusher.
+        //! A write queued with a non-empty key replaces the pending one with the same key.
+        void queueWrite(const std::string &key, Write write, std::size_t bytes);
+        //! Commit the queued writes in a single transaction.
+        void commitQueuedWrites();
+        //! Sync the environment before returning. Crypto state can't wait for the flusher:
+        //! once it has been used, losing it breaks the sessions it belongs to.
+        void syncToDisk();
+
+        //! Drop the messages of a room that fall outside its policy, along with their receipts.
+        //! Store the messages saved by older versions under their full message key.
+        void upgradeMessageKeys();
+
+        void trimRoom(const std::string &room_id);
+        //! The most messages a room can keep, so the messages of all the rooms fit the map.
+        std::size_t maxStoredMessages();
+        //! Drop the markers of notifications sent long ago.
+        void trimNotifications();
+        //! Drop the media no room or member refers to, once the media outgrow their budget.
+        void sweepMedia();
+        void startFlusher();
+        void stopFlusher();
+        void runFlusher();
+
+        struct QueuedWrite
+        {
+                std::string key;
+                Write write;
+        };
+
+        Durability durability_ = Durability::GroupCommit;
+
+        std::vector<QueuedWrite> queuedWrites_;
+        std::size_t queuedBytes_ = 0;
+        bool stopFlusher_        = false;
+
+        //! Guards the write queue and the flusher's state.
+        std::mutex writesMtx_;
+        //! Serializes the commits of queued writes.
+        std::mutex commitMtx_;
+        std::condition_variable writesCv_;
+        std::thread flusher_;
+
         lmdb::env env_;
         lmdb::dbi syncStateDb_;
         lmdb::dbi roomsDb_;
@@ -713,8 +1022,37 @@ private:
         lmdb::dbi inboundMegolmSessionDb_;
         lmdb::dbi outboundMegolmSessionDb_;
 
+        lmdb::dbi retentionDb_;
+        lmdb::dbi pendingReceiptsDb_;
+        lmdb::dbi encryptedRoomsDb_;
+        lmdb::dbi pendingToDeviceDb_;
+        lmdb::dbi pinnedMediaDb_;
+
+        //! user_id -> number of times the device list was invalidated.
+        std::map<std::string, uint64_t> deviceListGenerations_;
+        std::mutex deviceListsMtx_;
+
+        //! Handles of the databases opened on demand, by name.
+        std::map<std::string, MDB_dbi> dbis_;
+        //! LMDB doesn't allow databases to be opened concurrently.
+        std::mutex dbisMtx_;
+        RetentionPolicy defaultRetention_;
+
+        //! Rooms whose timeline changed since the last retention pass.
+        std::set<std::string> dirtyRooms_;
+        bool notificationsDirty_          = false;
+        std::size_t mediaBytesSinceSweep_ = 0;
+        //! Guards the retention state.
+        std::mutex retentionMtx_;
+        QFuture<void> retention_;
+
         QString localUserId_;
         QString cacheDirectory_;
+
+        //! Reset read-only transactions waiting to be renewed.
+        //! Declared after the environment so they are aborted before it closes.
+        mutable std::vector<lmdb::txn> readTxns_;
+        mutable std::mutex readTxnsMtx_;
 };
 
 namespace cache {
@@ -20,6 +20,7 @@
 #include <QSettings>
 #include <QtConcurrent>
 
+#include "AsyncCache.h"
 #include "AvatarProvider.h"
 #include "Cache.h"
 #include "ChatPage.h"
@@ -31,9 +32,11 @@
 #include "RoomList.h"
 #include "SideBarActions.h"
 #include "Splitter.h"
+#include "StartupProfile.h"
 #include "TextInputWidget.h"
 #include "TopRoomBar.h"
 #include "TypingDisplay.h"
+#include "UiSnapshot.h"
 #include "UserInfoWidget.h"
 #include "UserSettingsPage.h"
 #include "Utils.h"
@@ -52,6 +55,61 @@ ChatPage *ChatPage::instance_             = nullptr;
 constexpr int CHECK_CONNECTIVITY_INTERVAL = 15'000;
 constexpr int RETRY_TIMEOUT               = 5'000;
 constexpr size_t MAX_ONETIME_KEYS         = 50;
+constexpr int SNAPSHOT_INTERVAL           = 5 * 60'000;
+
+namespace {
+//! Outcome of a stage of the state restoration.
+struct RestoreStatus
+{
+        bool ok = true;
+        //! Shown on the login page when the session can't be restored.
+        QString error;
+};
+
+//! Run a stage of the state restoration and record how long it took.
+template<typename Stage>
+RestoreStatus
+restoreStage(const char *name, Stage stage)
+{
+        startup::Span span(name);
+
+        try {
+                stage();
+                return RestoreStatus();
+        } catch (const mtx::crypto::olm_exception &e) {
+                nhlog::crypto()->critical("failed to restore olm account: {}", e.what());
+                return RestoreStatus{
+                  false, ChatPage::tr("Failed to restore OLM account. Please login again.")};
+        } catch (const lmdb::error &e) {
+                nhlog::db()->critical("failed to restore cache: {}", e.what());
+                return RestoreStatus{
+                  false, ChatPage::tr("Failed to restore save data. Please login again.")};
+        } catch (const json::exception &e) {
+                nhlog::db()->critical("failed to parse cache data: {}", e.what());
+                return RestoreStatus{false, QString()};
+        }
+}
+
+//! Room details that are read and decoded off the GUI thread.
+struct RoomHeader
+{
+        bool found = false;
+        RoomInfo info;
+        QImage avatar;
+};
+
+RoomHeader
+readRoomHeader(Cache *cache, const std::string &room_id)
+{
+        auto room_info = cache->getRoomInfo({room_id});
+        auto it        = room_info.find(QString::fromStdString(room_id));
+
+        if (it == room_info.end())
+                return RoomHeader{};
+
+        return RoomHeader{true, std::move(it->second), cache->getRoomAvatar(room_id)};
+}
+}
 
 ChatPage::ChatPage(QSharedPointer<UserSettings> userSettings, QWidget *parent)
   : QWidget(parent)
@@ -117,6 +175,10 @@ ChatPage::ChatPage(QSharedPointer<UserSettings> userSettings, QWidget *parent)
                 &ChatPage::removeTimelineEvent,
                 view_manager_,
                 &TimelineViewManager::removeTimelineEvent);
+        connect(this,
+                &ChatPage::megolmSessionsReceived,
+                view_manager_,
+                &TimelineViewManager::retryDecryption);
 
         // Splitter
         splitter->addWidget(sideBar_);
@@ -150,6 +212,10 @@ ChatPage::ChatPage(QSharedPointer<UserSettings> userSettings, QWidget *parent)
                 trySync();
         });
 
+        snapshotTimer_.setInterval(SNAPSHOT_INTERVAL);
+        connect(&snapshotTimer_, &QTimer::timeout, this, [this]() { saveSnapshot(false); });
+        connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() { saveSnapshot(true); });
+
         connectivityTimer_.setInterval(CHECK_CONNECTIVITY_INTERVAL);
         connect(&connectivityTimer_, &QTimer::timeout, this, [=]() {
                 if (http::client()->access_token().empty()) {
@@ -216,6 +282,12 @@ ChatPage::ChatPage(QSharedPointer<UserSettings> userSettings, QWidget *parent)
         connect(room_list_, &RoomList::roomChanged, text_input_, &TextInputWidget::focusLineEdit);
         connect(
           room_list_, &RoomList::roomChanged, view_manager_, &TimelineViewManager::setHistoryView);
+        connect(
+          room_list_, &RoomList::roomHovered, view_manager_, &TimelineViewManager::prefetchHistory);
+        connect(room_list_,
+                &RoomList::roomUnhovered,
+                view_manager_,
+                &TimelineViewManager::cancelPrefetch);
 
         connect(room_list_, &RoomList::acceptInvite, this, [this](const QString &room_id) {
                 view_manager_->addRoom(room_id);
@@ -230,6 +302,22 @@ ChatPage::ChatPage(QSharedPointer<UserSettings> userSettings, QWidget *parent)
 
         connect(
           text_input_, &TextInputWidget::startedTyping, this, &ChatPage::sendTypingNotifications);
+        connect(text_input_, &TextInputWidget::startedTyping, this, [this]() {
+                if (current_room_.isEmpty())
+                        return;
+
+                // Get the megolm session ready before the message is sent. Looking up the
+                // devices can hit the cache and the crypto, so it stays off the GUI thread.
+                QtConcurrent::run([room_id = current_room_.toStdString()]() {
+                        try {
+                                if (cache::client()->isRoomEncrypted(room_id))
+                                        olm::prepare_megolm_session(room_id);
+                        } catch (const lmdb::error &e) {
+                                nhlog::db()->warn(
+                                  "failed to check encryption of {}: {}", room_id, e.what());
+                        }
+                });
+        });
         connect(typingRefresher_, &QTimer::timeout, this, &ChatPage::sendTypingNotifications);
         connect(text_input_, &TextInputWidget::stoppedTyping, this, [this]() {
                 if (!userSettings_->isTypingNotificationsEnabled())
@@ -605,6 +693,7 @@ ChatPage::logout()
 
         emit closing();
         connectivityTimer_.stop();
+        snapshotTimer_.stop();
 }
 
 void
@@ -617,10 +706,32 @@ ChatPage::dropToLoginPage(const QString &msg)
 
         http::client()->shutdown();
         connectivityTimer_.stop();
+        snapshotTimer_.stop();
 
         emit showLoginPage(msg);
 }
 
+void
+ChatPage::saveSnapshot(bool wait)
+{
+        if (!http::is_logged_in() || !cache::client())
+                return;
+
+        const auto user_id = QString::fromStdString(http::client()->user_id().to_string());
+        const auto state   = room_list_->snapshot();
+
+        if (state.rooms.empty())
+                return;
+
+        // The client is about to quit, there won't be a chance to write it later.
+        if (wait) {
+                snapshot::save(user_id, state);
+                return;
+        }
+
+        QtConcurrent::run([user_id, state]() { snapshot::save(user_id, state); });
+}
+
 void
 ChatPage::resetUI()
 {
@@ -665,11 +776,23 @@ ChatPage::bootstrap(QString userid, QString homeserver, QString token)
         http::client()->set_server(homeserver.toStdString());
         http::client()->set_access_token(token.toStdString());
 
+        {
+                std::lock_guard<std::mutex> lock(restoreMtx_);
+                restoreState_ = RestoreState::Restored;
+                pendingSync_  = boost::none;
+        }
+
         // The Olm client needs the user_id & device_id that will be included
         // in the generated payloads & keys.
         olm::client()->set_user_id(http::client()->user_id().to_string());
         olm::client()->set_device_id(http::client()->device_id());
 
+        // Paint the rooms of the previous session. They are reconciled once the cache is loaded.
+        if (auto previous = snapshot::load(userid))
+                room_list_->restore(*previous);
+
+        snapshotTimer_.start();
+
         try {
                 cache::init(userid);
 
@@ -741,28 +864,28 @@ ChatPage::changeTopRoomInfo(const QString &room_id)
                 return;
         }
 
-        try {
-                auto room_info = cache::client()->getRoomInfo({room_id.toStdString()});
-
-                if (room_info.find(room_id) == room_info.end())
-                        return;
-
-                const auto name       = QString::fromStdString(room_info[room_id].name);
-                const auto avatar_url = QString::fromStdString(room_info[room_id].avatar_url);
+        cache::read(
+          this,
+          [id = room_id.toStdString()](Cache *cache) { return readRoomHeader(cache, id); },
+          [this, room_id](const RoomHeader &header) {
+                  // The user moved to another room in the meantime.
+                  if (!header.found || room_id != current_room_)
+                          return;
 
-                top_bar_->updateRoomName(name);
-                top_bar_->updateRoomTopic(QString::fromStdString(room_info[room_id].topic));
+                  const auto name = QString::fromStdString(header.info.name);
 
-                auto img = cache::client()->getRoomAvatar(room_id);
+                  top_bar_->updateRoomName(name);
+                  top_bar_->updateRoomTopic(QString::fromStdString(header.info.topic));
 
-                if (img.isNull())
-                        top_bar_->updateRoomAvatarFromName(name);
-                else
-                        top_bar_->updateRoomAvatar(img);
+                  if (header.avatar.isNull())
+                          top_bar_->updateRoomAvatarFromName(name);
+                  else
+                          top_bar_->updateRoomAvatar(header.avatar);
+          });
 
-        } catch (const lmdb::error &e) {
-                nhlog::ui()->error("failed to change top bar room info: {}", e.what());
-        }
+        // The user switched rooms before sending anything.
+        if (!current_room_.isEmpty() && current_room_ != room_id)
+                olm::cancel_megolm_session_share(current_room_.toStdString());
 
         current_room_ = room_id;
 }
@@ -788,43 +911,123 @@ ChatPage::loadStateFromCache()
 
         getProfileInfo();
 
-        QtConcurrent::run([this]() {
-                try {
+        {
+                std::lock_guard<std::mutex> lock(restoreMtx_);
+                restoreState_ = RestoreState::Restoring;
+                pendingSync_  = boost::none;
+        }
+
+        // The request only needs the next batch token. Its response waits for the rest.
+        {
+                startup::Span span("first sync request");
+                trySync();
+        }
+
+        // Stages only wait on stages that were queued before them, so they can't starve
+        // the pool of the threads they are waiting for.
+
+        // The databases of all the rooms are opened together, before the stages that read
+        // them run side by side.
+        auto handles = QtConcurrent::run([]() {
+                return restoreStage("database handles", []() { cache::client()->openRoomDbs(); });
+        });
+
+        auto crypto = QtConcurrent::run([handles]() {
+                const auto handlesStatus = handles.result();
+                if (!handlesStatus.ok)
+                        return handlesStatus;
+
+                return restoreStage("crypto restore", []() {
                         cache::client()->restoreSessions();
                         olm::client()->load(cache::client()->restoreOlmAccount(),
                                             STORAGE_SECRET_KEY);
+                });
+        });
 
-                        cache::client()->populateMembers();
+        auto members = QtConcurrent::run([handles]() {
+                const auto handlesStatus = handles.result();
+                if (!handlesStatus.ok)
+                        return handlesStatus;
 
-                        emit initializeEmptyViews(cache::client()->roomMessages());
-                        emit initializeRoomList(cache::client()->roomInfo());
-                        emit syncTags(cache::client()->roomInfo().toStdMap());
+                return restoreStage("member load", []() { cache::client()->populateMembers(); });
+        });
 
-                        cache::client()->calculateRoomReadStatus();
+        auto rooms = QtConcurrent::run([this, handles, members]() {
+                const auto handlesStatus = handles.result();
+                if (!handlesStatus.ok)
+                        return handlesStatus;
+
+                QMap<QString, RoomInfo> info;
+                std::map<QString, mtx::responses::Timeline> messages;
+
+                const auto status = restoreStage("room list read", [&info, &messages]() {
+                        info     = cache::client()->roomInfo();
+                        messages = cache::client()->roomMessages();
+                });
+
+                // The room list shows the display names of the members.
+                const auto membersStatus = members.result();
+                if (!membersStatus.ok)
+                        return membersStatus;
+
+                if (!status.ok)
+                        return status;
+
+                emit initializeEmptyViews(messages);
+                emit initializeRoomList(info);
+                emit syncTags(info.toStdMap());
+
+                return restoreStage("read status",
+                                    []() { cache::client()->calculateRoomReadStatus(); });
+        });
+
+        QtConcurrent::run([this, crypto, rooms]() {
+                const auto cryptoStatus = crypto.result();
+                const auto roomsStatus  = rooms.result();
+
+                const auto status = cryptoStatus.ok ? roomsStatus : cryptoStatus;
+
+                if (!status.ok) {
+                        finishRestore(false);
+
+                        if (!status.error.isEmpty())
+                                emit dropToLoginPageCb(status.error);
 
-                } catch (const mtx::crypto::olm_exception &e) {
-                        nhlog::crypto()->critical("failed to restore olm account: {}", e.what());
-                        emit dropToLoginPageCb(
-                          tr("Failed to restore OLM account. Please login again."));
-                        return;
-                } catch (const lmdb::error &e) {
-                        nhlog::db()->critical("failed to restore cache: {}", e.what());
-                        emit dropToLoginPageCb(
-                          tr("Failed to restore save data. Please login again."));
-                        return;
-                } catch (const json::exception &e) {
-                        nhlog::db()->critical("failed to parse cache data: {}", e.what());
                         return;
                 }
 
                 nhlog::crypto()->info("ed25519   : {}", olm::client()->identity_keys().ed25519);
                 nhlog::crypto()->info("curve25519: {}", olm::client()->identity_keys().curve25519);
 
+                startup::finish();
+
                 // Start receiving events.
-                emit trySyncCb();
+                finishRestore(true);
         });
 }
 
+void
+ChatPage::finishRestore(bool isRestored)
+{
+        boost::optional<mtx::responses::Sync> res;
+
+        {
+                std::lock_guard<std::mutex> lock(restoreMtx_);
+                restoreState_ = isRestored ? RestoreState::Restored : RestoreState::Failed;
+
+                std::swap(res, pendingSync_);
+        }
+
+        if (!isRestored)
+                return;
+
+        // The to_device messages left over by the previous run.
+        handleToDeviceMessages();
+
+        if (res)
+                processSync(*res);
+}
+
 void
 ChatPage::showQuickSwitcher()
 {
@@ -936,14 +1139,24 @@ ChatPage::sendDesktopNotifications(const mtx::responses::Notifications &res)
                                 if (isRoomActive(room_id))
                                         continue;
 
-                                notificationsManager.postNotification(
-                                  room_id,
-                                  QString::fromStdString(event_id),
-                                  QString::fromStdString(
-                                    cache::client()->singleRoomInfo(item.room_id).name),
-                                  Cache::displayName(room_id, user_id),
-                                  utils::event_body(item.event),
-                                  cache::client()->getRoomAvatar(room_id));
+                                const auto sender = Cache::displayName(room_id, user_id);
+                                const auto body   = utils::event_body(item.event);
+
+                                cache::read(
+                                  this,
+                                  [id = item.room_id](Cache *cache) {
+                                          return readRoomHeader(cache, id);
+                                  },
+                                  [this, room_id, event_id, sender, body](
+                                    const RoomHeader &header) {
+                                          notificationsManager.postNotification(
+                                            room_id,
+                                            QString::fromStdString(event_id),
+                                            QString::fromStdString(header.info.name),
+                                            sender,
+                                            body,
+                                            header.avatar);
+                                  });
                         }
                 } catch (const lmdb::error &e) {
                         nhlog::db()->warn("error while sending desktop notification: {}", e.what());
@@ -1026,6 +1239,19 @@ ChatPage::trySync()
 
         http::client()->sync(
           opts, [this](const mtx::responses::Sync &res, mtx::http::RequestErr err) {
+                  {
+                          std::lock_guard<std::mutex> lock(restoreMtx_);
+
+                          if (restoreState_ == RestoreState::Failed)
+                                  return;
+
+                          // Processed once the cached state has been restored.
+                          if (!err && restoreState_ == RestoreState::Restoring) {
+                                  pendingSync_ = res;
+                                  return;
+                          }
+                  }
+
                   if (err) {
                           const auto error      = QString::fromStdString(err->matrix_error.error);
                           const auto msg        = tr("Please try to login again: %1").arg(error);
@@ -1064,35 +1290,41 @@ ChatPage::trySync()
                           }
                   }
 
-                  nhlog::net()->debug("sync completed: {}", res.next_batch);
+                  processSync(res);
+          });
+}
 
-                  // Ensure that we have enough one-time keys available.
-                  ensureOneTimeKeyCount(res.device_one_time_keys_count);
+void
+ChatPage::processSync(const mtx::responses::Sync &res)
+{
+        nhlog::net()->debug("sync completed: {}", res.next_batch);
 
-                  // TODO: fine grained error handling
-                  try {
-                          cache::client()->saveState(res);
-                          olm::handle_to_device_messages(res.to_device);
+        // Ensure that we have enough one-time keys available.
+        ensureOneTimeKeyCount(res.device_one_time_keys_count);
 
-                          emit syncUI(res.rooms);
+        // TODO: fine grained error handling
+        try {
+                cache::client()->saveState(res);
+                handleToDeviceMessages();
 
-                          auto updates = cache::client()->roomUpdates(res);
+                emit syncUI(res.rooms);
 
-                          emit syncTopBar(updates);
-                          emit syncRoomlist(updates);
+                auto updates = cache::client()->roomUpdates(res);
 
-                          emit syncTags(cache::client()->roomTagUpdates(res));
+                emit syncTopBar(updates);
+                emit syncRoomlist(updates);
 
-                          cache::client()->deleteOldData();
-                  } catch (const lmdb::map_full_error &e) {
-                          nhlog::db()->error("lmdb is full: {}", e.what());
-                          cache::client()->deleteOldData();
-                  } catch (const lmdb::error &e) {
-                          nhlog::db()->error("saving sync response: {}", e.what());
-                  }
+                emit syncTags(cache::client()->roomTagUpdates(res));
 
-                  emit trySyncCb();
-          });
+                cache::client()->scheduleRetention();
+        } catch (const lmdb::map_full_error &e) {
+                nhlog::db()->error("lmdb is full: {}", e.what());
+                cache::client()->runRetention(true);
+        } catch (const lmdb::error &e) {
+                nhlog::db()->error("saving sync response: {}", e.what());
+        }
+
+        emit trySyncCb();
 }
 
 void
@@ -1211,7 +1443,7 @@ ChatPage::initialSyncHandler(const mtx::responses::Sync &res, mtx::http::Request
         try {
                 cache::client()->saveState(res);
 
-                olm::handle_to_device_messages(res.to_device);
+                handleToDeviceMessages();
 
                 emit initializeViews(std::move(res.rooms));
                 emit initializeRoomList(cache::client()->roomInfo());
@@ -1236,10 +1468,9 @@ ChatPage::ensureOneTimeKeyCount(const std::map<std::string, uint16_t> &counts)
                         const int nkeys = MAX_ONETIME_KEYS - entry.second;
 
                         nhlog::crypto()->info("uploading {} {} keys", nkeys, entry.first);
-                        olm::client()->generate_one_time_keys(nkeys);
 
                         http::client()->upload_keys(
-                          olm::client()->create_upload_keys_request(),
+                          olm::generate_one_time_keys(nkeys),
                           [](const mtx::responses::UploadKeys &, mtx::http::RequestErr err) {
                                   if (err) {
                                           nhlog::crypto()->warn(
@@ -1255,6 +1486,20 @@ ChatPage::ensureOneTimeKeyCount(const std::map<std::string, uint16_t> &counts)
         }
 }
 
+void
+ChatPage::handleToDeviceMessages()
+{
+        olm::handle_to_device_messages([this](const std::vector<MegolmSessionIndex> &sessions) {
+                std::map<QString, std::vector<std::string>> rooms;
+                for (const auto &session : sessions)
+                        rooms[QString::fromStdString(session.room_id)].push_back(
+                          session.session_id);
+
+                for (const auto &room : rooms)
+                        emit megolmSessionsReceived(room.first, room.second);
+        });
+}
+
 void
 ChatPage::getProfileInfo()
 {
@@ -1270,6 +1515,8 @@ ChatPage::getProfileInfo()
                   emit setUserDisplayName(QString::fromStdString(res.display_name));
 
                   if (cache::client()) {
+                          cache::client()->pinMedia("profile", res.avatar_url);
+
                           auto data = cache::client()->image(res.avatar_url);
                           if (!data.isNull()) {
                                   emit setUserAvatar(QImage::fromData(data));
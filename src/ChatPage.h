@@ -18,7 +18,9 @@
 #pragma once
 
 #include <atomic>
+#include <boost/optional.hpp>
 #include <boost/variant.hpp>
+#include <mutex>
 
 #include <QFrame>
 #include <QHBoxLayout>
@@ -120,6 +122,9 @@ signals:
         void showOverlayProgressBar();
 
         void removeTimelineEvent(const QString &room_id, const QString &event_id);
+        //! New megolm sessions are available for decrypting the events of the room.
+        void megolmSessionsReceived(const QString &room_id,
+                                    const std::vector<std::string> &session_ids);
 
         void ownProfileOk();
         void setUserDisplayName(const QString &name);
@@ -169,7 +174,13 @@ private:
         void startInitialSync();
         void tryInitialSync();
         void trySync();
+        //! Store a sync response and hand it over to the UI.
+        void processSync(const mtx::responses::Sync &res);
+        //! Process the sync response that was held back while the state was restored.
+        void finishRestore(bool isRestored);
         void ensureOneTimeKeyCount(const std::map<std::string, uint16_t> &counts);
+        //! Hand the to_device messages saved with the syncs over to the olm workers.
+        void handleToDeviceMessages();
         void getProfileInfo();
 
         //! Check if the given room is currently open.
@@ -188,6 +199,8 @@ private:
         void updateTypingUsers(const QString &roomid, const std::vector<std::string> &user_ids);
 
         void loadStateFromCache();
+        //! Save what the room list shows, so the next launch can paint it right away.
+        void saveSnapshot(bool wait);
         void resetUI();
         //! Decides whether or not to hide the group's sidebar.
         void setGroupViewState(bool isEnabled);
@@ -227,6 +240,22 @@ private:
         QTimer connectivityTimer_;
         std::atomic_bool isConnected_;
 
+        //! Refreshes the snapshot, in case the client doesn't get to shut down cleanly.
+        QTimer snapshotTimer_;
+
+        enum class RestoreState
+        {
+                Restoring,
+                Restored,
+                Failed,
+        };
+
+        //! The first sync is sent while the cached state is restored, but its response is
+        //! only processed afterwards.
+        std::mutex restoreMtx_;
+        RestoreState restoreState_ = RestoreState::Restored;
+        boost::optional<mtx::responses::Sync> pendingSync_;
+
         QString current_room_;
         QString current_community_;
 
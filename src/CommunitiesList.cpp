@@ -1,4 +1,5 @@
 #include "CommunitiesList.h"
+#include "AsyncCache.h"
 #include "Cache.h"
 #include "Logging.h"
 #include "MatrixClient.h"
@@ -6,6 +7,8 @@
 
 #include <QLabel>
 
+#include <algorithm>
+
 CommunitiesList::CommunitiesList(QWidget *parent)
   : QWidget(parent)
 {
@@ -55,6 +58,12 @@ CommunitiesList::setCommunities(const mtx::responses::JoinedGroups &response)
                 if (it->second->is_tag()) {
                         ++it;
                 } else {
+                        const auto group_id = it->first.toStdString();
+                        if (std::find(response.groups.begin(),
+                                      response.groups.end(),
+                                      group_id) == response.groups.end())
+                                cache::client()->pinMedia("community/" + group_id, "");
+
                         it = communities_.erase(it);
                 }
         }
@@ -139,6 +148,8 @@ CommunitiesList::addCommunity(const std::string &group_id)
                                 return;
 
                         communities_.at(id)->setName(QString::fromStdString(profile.name));
+                        cache::client()->pinMedia("community/" + id.toStdString(),
+                                                  profile.avatar_url);
 
                         if (!profile.avatar_url.empty())
                                 fetchCommunityAvatar(id,
@@ -215,17 +226,27 @@ CommunitiesList::highlightSelectedCommunity(const QString &community_id)
 void
 CommunitiesList::fetchCommunityAvatar(const QString &id, const QString &avatarUrl)
 {
-        auto savedImgData = cache::client()->image(avatarUrl);
-        if (!savedImgData.isNull()) {
-                QPixmap pix;
-                pix.loadFromData(savedImgData);
-                emit avatarRetrieved(id, pix);
-                return;
-        }
-
         if (avatarUrl.isEmpty())
                 return;
 
+        // The image is read and decoded on the cache pool; only a miss goes to the network.
+        cache::read(this,
+                    [url = avatarUrl.toStdString()](Cache *cache) {
+                            QImage img;
+                            img.loadFromData(cache->image(url));
+                            return img;
+                    },
+                    [this, id, avatarUrl](const QImage &img) {
+                            if (!img.isNull())
+                                    emit avatarRetrieved(id, QPixmap::fromImage(img));
+                            else
+                                    downloadCommunityAvatar(id, avatarUrl);
+                    });
+}
+
+void
+CommunitiesList::downloadCommunityAvatar(const QString &id, const QString &avatarUrl)
+{
         mtx::http::ThumbOpts opts;
         opts.mxc_url = avatarUrl.toStdString();
         http::client()->get_thumbnail(
@@ -37,6 +37,7 @@ public slots:
 
 private:
         void fetchCommunityAvatar(const QString &id, const QString &avatarUrl);
+        void downloadCommunityAvatar(const QString &id, const QString &avatarUrl);
         void addGlobalItem() { addCommunity("world"); }
         void sortEntries();
 
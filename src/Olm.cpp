@@ -1,5 +1,16 @@
 #include <boost/variant.hpp>
 
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+
 #include "Olm.h"
 
 #include "Cache.h"
@@ -10,71 +21,303 @@
 static const std::string STORAGE_SECRET_KEY("secret");
 constexpr auto MEGOLM_ALGO = "m.megolm.v1.aes-sha2";
 
+//! Outbound megolm sessions are replaced after that many messages or that much time,
+//! unless the room sets its own limits.
+constexpr uint64_t MEGOLM_ROTATION_MSGS = 100;
+constexpr std::chrono::hours MEGOLM_ROTATION_PERIOD(24 * 7);
+
 namespace {
 auto client_ = std::make_unique<mtx::crypto::OlmClient>();
+//! Serializes the uses of the olm client.
+std::recursive_mutex client_mtx;
+
+//! Runs the given function when the last copy of the shared_ptr is gone.
+class StateKeeper
+{
+public:
+        StateKeeper(std::function<void()> &&fn)
+          : fn_(std::move(fn))
+        {}
+
+        ~StateKeeper() { fn_(); }
+
+private:
+        std::function<void()> fn_;
+};
+
+//! A key distribution in progress for the outbound session of a room.
+struct PendingShare
+{
+        //! Functions to run once the key has been distributed (e.g sending queued messages).
+        //! They are told whether the distribution succeeded.
+        std::vector<std::function<void(bool)>> callbacks;
+        //! Nothing needs the distribution anymore, so it should stop at the next step.
+        bool cancelled = false;
+        //! The distribution was stopped before completion because it was cancelled.
+        bool interrupted = false;
+        //! The session was ready and the key was sent out to the missing devices.
+        bool distributed = false;
+};
+
+std::mutex pending_shares_mtx;
+std::map<std::string, PendingShare> pending_shares;
+
+//! One-time keys of the account were used by inbound sessions since it was last saved.
+//! Guarded by client_mtx.
+bool account_changed = false;
+
+//! The keys of the pending to_device messages that were handed to the workers.
+std::set<std::string> dispatched_to_device;
+std::mutex dispatched_mtx;
+
+//! The to_device messages handed to the workers at once.
+struct ToDeviceBatch
+{
+        std::chrono::steady_clock::time_point start;
+        std::size_t size = 0;
+
+        //! The megolm sessions established and saved by the workers.
+        std::vector<MegolmSessionIndex> indices;
+        std::mutex mtx;
+};
+
+//! The worker that processes the to_device messages with the given key.
+//! Each worker runs a single thread so the messages of a sender are kept in order.
+QThreadPool *
+to_device_worker(const std::string &key)
+{
+        static std::vector<std::unique_ptr<QThreadPool>> workers = []() {
+                std::vector<std::unique_ptr<QThreadPool>> pools(
+                  std::max(1, std::min(QThread::idealThreadCount(), 4)));
+
+                for (auto &pool : pools) {
+                        pool = std::make_unique<QThreadPool>();
+                        pool->setMaxThreadCount(1);
+                }
+
+                return pools;
+        }();
+
+        return workers[std::hash<std::string>{}(key) % workers.size()].get();
+}
+
+uint64_t
+current_timestamp()
+{
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
 }
 
 namespace olm {
 
-mtx::crypto::OlmClient *
+ClientLock
 client()
 {
-        return client_.get();
+        return ClientLock(client_.get(), client_mtx);
 }
 
-void
-handle_to_device_messages(const std::vector<nlohmann::json> &msgs)
+//! Handle a single to_device message. The inbound megolm sessions it establishes
+//! are added to `sessions`.
+static void
+handle_to_device_message(const nlohmann::json &msg, InboundMegolmSessions &sessions)
 {
-        if (msgs.empty())
+        if (msg.count("type") == 0) {
+                nhlog::crypto()->warn("received message with no type field from {}",
+                                      msg.value("sender", ""));
                 return;
+        }
 
-        nhlog::crypto()->info("received {} to_device messages", msgs.size());
+        std::string msg_type = msg.at("type");
 
-        for (const auto &msg : msgs) {
-                if (msg.count("type") == 0) {
-                        nhlog::crypto()->warn("received message with no type field: {}",
-                                              msg.dump(2));
-                        continue;
+        if (msg_type == to_string(mtx::events::EventType::RoomEncrypted)) {
+                try {
+                        OlmMessage olm_msg = msg;
+                        handle_olm_message(std::move(olm_msg), sessions);
+                } catch (const nlohmann::json::exception &e) {
+                        nhlog::crypto()->warn("parsing error for olm message: {}", e.what());
+                } catch (const std::invalid_argument &e) {
+                        nhlog::crypto()->warn("validation error for olm message: {}", e.what());
                 }
 
-                std::string msg_type = msg.at("type");
-
-                if (msg_type == to_string(mtx::events::EventType::RoomEncrypted)) {
-                        try {
-                                OlmMessage olm_msg = msg;
-                                handle_olm_message(std::move(olm_msg));
-                        } catch (const nlohmann::json::exception &e) {
-                                nhlog::crypto()->warn(
-                                  "parsing error for olm message: {} {}", e.what(), msg.dump(2));
-                        } catch (const std::invalid_argument &e) {
-                                nhlog::crypto()->warn(
-                                  "validation error for olm message: {} {}", e.what(), msg.dump(2));
-                        }
+        } else if (msg_type == to_string(mtx::events::EventType::RoomKeyRequest)) {
+                nhlog::crypto()->debug("handling key request event from {}",
+                                       msg.value("sender", ""));
+                try {
+                        mtx::events::msg::KeyRequest req = msg;
+                        if (req.action == mtx::events::msg::RequestAction::Request)
+                                handle_key_request_message(std::move(req));
+                        else
+                                nhlog::crypto()->warn("ignore key request (unhandled action): {}",
+                                                      req.request_id);
+                } catch (const nlohmann::json::exception &e) {
+                        nhlog::crypto()->warn("parsing error for key_request message: {}",
+                                              e.what());
+                }
+        } else {
+                nhlog::crypto()->warn("unhandled to_device event: {}", msg_type);
+        }
+}
 
-                } else if (msg_type == to_string(mtx::events::EventType::RoomKeyRequest)) {
-                        nhlog::crypto()->warn("handling key request event: {}", msg.dump(2));
-                        try {
-                                mtx::events::msg::KeyRequest req = msg;
-                                if (req.action == mtx::events::msg::RequestAction::Request)
-                                        handle_key_request_message(std::move(req));
-                                else
-                                        nhlog::crypto()->warn(
-                                          "ignore key request (unhandled action): {}",
-                                          req.request_id);
-                        } catch (const nlohmann::json::exception &e) {
-                                nhlog::crypto()->warn(
-                                  "parsing error for key_request message: {} {}",
-                                  e.what(),
-                                  msg.dump(2));
-                        }
-                } else {
-                        nhlog::crypto()->warn("unhandled event: {}", msg.dump(2));
+//! The messages with the same key are handled by the same worker, in order.
+static std::string
+to_device_partition(const nlohmann::json &msg)
+{
+        try {
+                if (msg.count("content") != 0 && msg.at("content").count("sender_key") != 0)
+                        return msg.at("content").at("sender_key").get<std::string>();
+
+                return msg.at("sender").get<std::string>();
+        } catch (const nlohmann::json::exception &) {
+                return {};
+        }
+}
+
+//! Save what the to_device messages of a worker established. The megolm sessions go
+//! first, so if we stop before the olm sessions are saved the messages can still be
+//! decrypted again.
+static bool
+save_to_device_state(const std::string &key, InboundMegolmSessions sessions)
+{
+        try {
+                cache::client()->saveInboundMegolmSessions(std::move(sessions));
+                cache::client()->flushOlmSessions({key});
+        } catch (const lmdb::error &e) {
+                nhlog::db()->critical("failed to save to_device state of {}: {}", key, e.what());
+                return false;
+        } catch (const mtx::crypto::olm_exception &e) {
+                nhlog::crypto()->critical("failed to pickle to_device state of {}: {}",
+                                          key,
+                                          e.what());
+                return false;
+        }
+
+        return true;
+}
+
+//! Save the olm account if inbound sessions used some of its one-time keys.
+static void
+save_changed_account()
+{
+        auto client = olm::client();
+        if (!account_changed)
+                return;
+
+        try {
+                cache::client()->saveOlmAccount(client->save(STORAGE_SECRET_KEY));
+                account_changed = false;
+        } catch (const lmdb::error &e) {
+                nhlog::db()->critical("failed to save olm account: {}", e.what());
+        }
+}
+
+void
+handle_to_device_messages(std::function<void(const std::vector<MegolmSessionIndex> &)> callback)
+{
+        using PendingMessage = std::pair<std::string, nlohmann::json>;
+
+        std::map<std::string, std::vector<PendingMessage>> partitions;
+        std::size_t count = 0;
+        {
+                // Held until the messages are marked, so a worker can't drop one from the
+                // cache in between and have it handed out again.
+                std::unique_lock<std::mutex> lock(dispatched_mtx);
+
+                std::map<std::string, nlohmann::json> msgs;
+                try {
+                        msgs = cache::client()->pendingToDevice();
+                } catch (const lmdb::error &e) {
+                        nhlog::db()->critical("failed to read pending to_device messages: {}",
+                                              e.what());
+                        return;
+                }
+
+                for (auto &msg : msgs) {
+                        if (!dispatched_to_device.insert(msg.first).second)
+                                continue;
+
+                        const auto partition = to_device_partition(msg.second);
+                        partitions[partition].emplace_back(msg.first, std::move(msg.second));
+                        ++count;
                 }
         }
+
+        if (count == 0)
+                return;
+
+        nhlog::crypto()->info("received {} to_device messages", count);
+
+        auto batch   = std::make_shared<ToDeviceBatch>();
+        batch->start = std::chrono::steady_clock::now();
+        batch->size  = count;
+
+        // Runs once every worker is done with its messages.
+        auto keeper = std::make_shared<StateKeeper>([batch, callback]() {
+                // The one-time keys are dropped from the saved account only now, as the
+                // messages that used them are handled again otherwise.
+                save_changed_account();
+
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - batch->start);
+                nhlog::crypto()->info(
+                  "processed {} to_device messages in {} ms ({} us/msg), {} new megolm sessions",
+                  batch->size,
+                  elapsed.count() / 1000,
+                  elapsed.count() / static_cast<long>(batch->size),
+                  batch->indices.size());
+
+                if (!batch->indices.empty() && callback)
+                        callback(batch->indices);
+        });
+
+        for (auto &partition : partitions) {
+                QtConcurrent::run(
+                  to_device_worker(partition.first),
+                  [key = partition.first, msgs = std::move(partition.second), batch, keeper]() {
+                          InboundMegolmSessions sessions;
+                          for (const auto &msg : msgs)
+                                  handle_to_device_message(msg.second, sessions);
+
+                          std::vector<MegolmSessionIndex> indices;
+                          for (const auto &session : sessions)
+                                  indices.push_back(session.first);
+
+                          const bool saved = save_to_device_state(key, std::move(sessions));
+
+                          {
+                                  std::unique_lock<std::mutex> lock(dispatched_mtx);
+
+                                  std::vector<std::string> keys;
+                                  for (const auto &msg : msgs) {
+                                          keys.push_back(msg.first);
+                                          dispatched_to_device.erase(msg.first);
+                                  }
+
+                                  // Otherwise the messages are handed out again with the
+                                  // next sync.
+                                  try {
+                                          if (saved)
+                                                  cache::client()->removePendingToDevice(keys);
+                                  } catch (const lmdb::error &e) {
+                                          nhlog::db()->critical(
+                                            "failed to drop handled to_device messages: {}",
+                                            e.what());
+                                  }
+                          }
+
+                          if (!saved)
+                                  return;
+
+                          std::unique_lock<std::mutex> lock(batch->mtx);
+                          std::move(indices.begin(),
+                                    indices.end(),
+                                    std::back_inserter(batch->indices));
+                  });
+        }
 }
 
 void
-handle_olm_message(const OlmMessage &msg)
+handle_olm_message(const OlmMessage &msg, InboundMegolmSessions &sessions)
 {
         nhlog::crypto()->info("sender    : {}", msg.sender);
         nhlog::crypto()->info("sender_key: {}", msg.sender_key);
@@ -92,8 +335,10 @@ handle_olm_message(const OlmMessage &msg)
                 auto payload = try_olm_decryption(msg.sender_key, cipher.second);
 
                 if (!payload.is_null()) {
-                        nhlog::crypto()->debug("decrypted olm payload: {}", payload.dump(2));
-                        create_inbound_megolm_session(msg.sender, msg.sender_key, payload);
+                        nhlog::crypto()->debug("decrypted olm payload of type {}",
+                                               payload.value("type", ""));
+                        create_inbound_megolm_session(
+                          msg.sender, msg.sender_key, payload, sessions);
                         return;
                 }
 
@@ -103,25 +348,27 @@ handle_olm_message(const OlmMessage &msg)
                         return;
                 }
 
-                handle_pre_key_olm_message(msg.sender, msg.sender_key, cipher.second);
+                handle_pre_key_olm_message(msg.sender, msg.sender_key, cipher.second, sessions);
         }
 }
 
 void
 handle_pre_key_olm_message(const std::string &sender,
                            const std::string &sender_key,
-                           const mtx::events::msg::OlmCipherContent &content)
+                           const mtx::events::msg::OlmCipherContent &content,
+                           InboundMegolmSessions &sessions)
 {
         nhlog::crypto()->info("opening olm session with {}", sender);
 
         mtx::crypto::OlmSessionPtr inbound_session = nullptr;
         try {
-                inbound_session =
-                  olm::client()->create_inbound_session_from(sender_key, content.body);
+                auto client = olm::client();
+
+                inbound_session = client->create_inbound_session_from(sender_key, content.body);
 
-                // We also remove the one time key used to establish that
-                // session so we'll have to update our copy of the account object.
-                cache::client()->saveOlmAccount(olm::client()->save("secret"));
+                // We also remove the one time key used to establish that session, so the
+                // account is saved once the sessions from the message are.
+                account_changed = true;
         } catch (const mtx::crypto::olm_exception &e) {
                 nhlog::crypto()->critical(
                   "failed to create inbound session with {}: {}", sender, e.what());
@@ -135,27 +382,28 @@ handle_pre_key_olm_message(const std::string &sender,
                 return;
         }
 
-        mtx::crypto::BinaryBuf output;
+        json plaintext;
         try {
-                output =
+                auto output =
                   olm::client()->decrypt_message(inbound_session.get(), content.type, content.body);
+                plaintext = json::parse(std::string((char *)output.data(), output.size()));
         } catch (const mtx::crypto::olm_exception &e) {
-                nhlog::crypto()->critical(
-                  "failed to decrypt olm message {}: {}", content.body, e.what());
+                nhlog::crypto()->critical("failed to decrypt olm message from {}: {}",
+                                          sender,
+                                          e.what());
+                return;
+        } catch (const json::exception &e) {
+                nhlog::crypto()->critical("failed to parse the decrypted olm message: {}",
+                                          e.what());
                 return;
         }
 
-        auto plaintext = json::parse(std::string((char *)output.data(), output.size()));
-        nhlog::crypto()->debug("decrypted message: \n {}", plaintext.dump(2));
+        nhlog::crypto()->debug("decrypted message of type {}", plaintext.value("type", ""));
 
-        try {
-                cache::client()->saveOlmSession(sender_key, std::move(inbound_session));
-        } catch (const lmdb::error &e) {
-                nhlog::db()->warn(
-                  "failed to save inbound olm session from {}: {}", sender, e.what());
-        }
+        // Saved by the worker along with the others, after the megolm session.
+        cache::client()->touchOlmSession(sender_key, OlmSessionRef(std::move(inbound_session)));
 
-        create_inbound_megolm_session(sender, sender_key, plaintext);
+        create_inbound_megolm_session(sender, sender_key, plaintext, sessions);
 }
 
 mtx::events::msg::Encrypted
@@ -186,43 +434,85 @@ encrypt_group_message(const std::string &room_id,
         return data;
 }
 
-nlohmann::json
-try_olm_decryption(const std::string &sender_key, const mtx::events::msg::OlmCipherContent &msg)
+//! Decrypt the message with the given session, which is then marked as the most recent one.
+static bool
+decrypt_olm_message(const std::string &sender_key,
+                    const OlmSessionRef &session,
+                    const mtx::events::msg::OlmCipherContent &msg,
+                    mtx::crypto::BinaryBuf &text)
 {
-        auto session_ids = cache::client()->getOlmSessions(sender_key);
-
-        nhlog::crypto()->info("attempt to decrypt message with {} known session_ids",
-                              session_ids.size());
+        try {
+                text = olm::client()->decrypt_message(session.get(), msg.type, msg.body);
+        } catch (const mtx::crypto::olm_exception &e) {
+                nhlog::crypto()->debug("failed to decrypt olm message ({}, {}) with {}: {}",
+                                       msg.type,
+                                       sender_key,
+                                       mtx::crypto::session_id(session.get()),
+                                       e.what());
+                return false;
+        }
 
-        for (const auto &id : session_ids) {
-                auto session = cache::client()->getOlmSession(sender_key, id);
+        cache::client()->touchOlmSession(sender_key, session);
+        return true;
+}
 
-                if (!session)
-                        continue;
+nlohmann::json
+try_olm_decryption(const std::string &sender_key, const mtx::events::msg::OlmCipherContent &msg)
+{
+        mtx::crypto::BinaryBuf text;
+        bool decrypted = false;
+
+        // The sessions that were used recently are the most likely to match.
+        std::set<std::string> tried;
+        for (const auto &session : cache::client()->getCachedOlmSessions(sender_key)) {
+                if (decrypt_olm_message(sender_key, session, msg, text)) {
+                        decrypted = true;
+                        break;
+                }
 
-                mtx::crypto::BinaryBuf text;
+                tried.insert(mtx::crypto::session_id(session.get()));
+        }
 
-                try {
-                        text = olm::client()->decrypt_message(session->get(), msg.type, msg.body);
-                        cache::client()->saveOlmSession(id, std::move(session.value()));
-                } catch (const mtx::crypto::olm_exception &e) {
-                        nhlog::crypto()->debug("failed to decrypt olm message ({}, {}) with {}: {}",
-                                               msg.type,
-                                               sender_key,
-                                               id,
-                                               e.what());
-                        continue;
-                } catch (const lmdb::error &e) {
-                        nhlog::crypto()->critical("failed to save session: {}", e.what());
-                        return {};
+        try {
+                if (!decrypted) {
+                        auto session_ids = cache::client()->getOlmSessions(sender_key);
+
+                        nhlog::crypto()->info(
+                          "attempt to decrypt message with {} stored session_ids ({} cached)",
+                          session_ids.size(),
+                          tried.size());
+
+                        for (const auto &id : session_ids) {
+                                if (tried.find(id) != tried.end())
+                                        continue;
+
+                                auto session = cache::client()->getOlmSession(sender_key, id);
+                                if (!session)
+                                        continue;
+
+                                if (decrypt_olm_message(
+                                      sender_key, OlmSessionRef(std::move(*session)), msg, text)) {
+                                        decrypted = true;
+                                        break;
+                                }
+                        }
                 }
+        } catch (const lmdb::error &e) {
+                nhlog::db()->critical("failed to retrieve olm sessions: {}", e.what());
+                return {};
+        } catch (const mtx::crypto::olm_exception &e) {
+                nhlog::crypto()->critical("failed to unpickle olm session: {}", e.what());
+                return {};
+        }
 
-                try {
-                        return json::parse(std::string((char *)text.data(), text.size()));
-                } catch (const json::exception &e) {
-                        nhlog::crypto()->critical("failed to parse the decrypted session msg: {}",
-                                                  e.what());
-                }
+        if (!decrypted)
+                return {};
+
+        try {
+                return json::parse(std::string((char *)text.data(), text.size()));
+        } catch (const json::exception &e) {
+                nhlog::crypto()->critical("failed to parse the decrypted session msg: {}",
+                                          e.what());
         }
 
         return {};
@@ -231,7 +521,8 @@ try_olm_decryption(const std::string &sender_key, const mtx::events::msg::OlmCip
 void
 create_inbound_megolm_session(const std::string &sender,
                               const std::string &sender_key,
-                              const nlohmann::json &payload)
+                              const nlohmann::json &payload,
+                              InboundMegolmSessions &sessions)
 {
         std::string room_id, session_id, session_key;
 
@@ -240,8 +531,7 @@ create_inbound_megolm_session(const std::string &sender,
                 session_id  = payload.at("content").at("session_id");
                 session_key = payload.at("content").at("session_key");
         } catch (const nlohmann::json::exception &e) {
-                nhlog::crypto()->critical(
-                  "failed to parse plaintext olm message: {} {}", e.what(), payload.dump(2));
+                nhlog::crypto()->critical("failed to parse plaintext olm message: {}", e.what());
                 return;
         }
 
@@ -252,10 +542,7 @@ create_inbound_megolm_session(const std::string &sender,
 
         try {
                 auto megolm_session = olm::client()->init_inbound_group_session(session_key);
-                cache::client()->saveInboundMegolmSession(index, std::move(megolm_session));
-        } catch (const lmdb::error &e) {
-                nhlog::crypto()->critical("failed to save inbound megolm session: {}", e.what());
-                return;
+                sessions.emplace_back(std::move(index), std::move(megolm_session));
         } catch (const mtx::crypto::olm_exception &e) {
                 nhlog::crypto()->critical("failed to create inbound megolm session: {}", e.what());
                 return;
@@ -267,8 +554,19 @@ create_inbound_megolm_session(const std::string &sender,
 void
 mark_keys_as_published()
 {
-        olm::client()->mark_keys_as_published();
-        cache::client()->saveOlmAccount(olm::client()->save(STORAGE_SECRET_KEY));
+        auto client = olm::client();
+
+        client->mark_keys_as_published();
+        cache::client()->saveOlmAccount(client->save(STORAGE_SECRET_KEY));
+}
+
+mtx::requests::UploadKeys
+generate_one_time_keys(int nkeys)
+{
+        auto client = olm::client();
+
+        client->generate_one_time_keys(nkeys);
+        return client->create_upload_keys_request();
 }
 
 void
@@ -400,145 +698,602 @@ send_megolm_key_to_device(const std::string &user_id,
                           const std::string &device_id,
                           const json &payload)
 {
+        get_device_keys({user_id}, [payload, user_id, device_id](const UserDeviceKeys &devices) {
+                if (devices.find(user_id) == devices.end() ||
+                    devices.at(user_id).find(device_id) == devices.at(user_id).end()) {
+                        nhlog::net()->warn("no verified keys found for device {}:{}",
+                                           user_id,
+                                           device_id);
+                        return;
+                }
+
+                const auto pks = devices.at(user_id).at(device_id);
+
+                auto room_key = olm::client()
+                                  ->create_room_key_event(UserId(user_id), pks.ed25519, payload)
+                                  .dump();
+
+                http::client()->claim_keys(
+                  user_id,
+                  {device_id},
+                  [room_key, user_id, device_id, pks](const mtx::responses::ClaimKeys &res,
+                                                      mtx::http::RequestErr err) {
+                          if (err) {
+                                  nhlog::net()->warn("claim keys error: {} {} {}",
+                                                     err->matrix_error.error,
+                                                     err->parse_error,
+                                                     static_cast<int>(err->status_code));
+                                  return;
+                          }
+
+                          nhlog::net()->info("claimed keys for {}", user_id);
+
+                          if (res.one_time_keys.size() == 0) {
+                                  nhlog::net()->info("no one-time keys found for user_id: {}",
+                                                     user_id);
+                                  return;
+                          }
+
+                          if (res.one_time_keys.find(user_id) == res.one_time_keys.end()) {
+                                  nhlog::net()->info("no one-time keys found for user_id: {}",
+                                                     user_id);
+                                  return;
+                          }
+
+                          auto retrieved_devices = res.one_time_keys.at(user_id);
+                          if (retrieved_devices.empty()) {
+                                  nhlog::net()->info("claiming keys for {}: no retrieved devices",
+                                                     device_id);
+                                  return;
+                          }
+
+                          json body;
+                          body["messages"][user_id] = json::object();
+
+                          auto device = retrieved_devices.begin()->second;
+                          nhlog::net()->debug("{} : \n {}", device_id, device.dump(2));
+
+                          json device_msg;
+
+                          try {
+                                  auto olm_session = olm::client()->create_outbound_session(
+                                    pks.curve25519, device.begin()->at("key"));
+
+                                  device_msg = olm::client()->create_olm_encrypted_content(
+                                    olm_session.get(), room_key, pks.curve25519);
+
+                                  cache::client()->saveOlmSession(pks.curve25519,
+                                                                  std::move(olm_session));
+                          } catch (const json::exception &e) {
+                                  nhlog::crypto()->warn("creating outbound session: {}",
+                                                        e.what());
+                                  return;
+                          } catch (const mtx::crypto::olm_exception &e) {
+                                  nhlog::crypto()->warn("creating outbound session: {}",
+                                                        e.what());
+                                  return;
+                          }
+
+                          body["messages"][user_id][device_id] = device_msg;
+
+                          nhlog::net()->info(
+                            "sending m.room_key event to {}:{}", user_id, device_id);
+                          http::client()->send_to_device(
+                            "m.room.encrypted", body, [user_id](mtx::http::RequestErr err) {
+                                    if (err) {
+                                            nhlog::net()->warn("failed to send "
+                                                               "send_to_device "
+                                                               "message: {}",
+                                                               err->matrix_error.error);
+                                    }
+
+                                    nhlog::net()->info("m.room_key send to {}", user_id);
+                            });
+                  });
+        });
+}
+
+void
+get_device_keys(const std::vector<std::string> &users,
+                std::function<void(const UserDeviceKeys &)> callback)
+{
+        UserDeviceKeys devices;
+        std::vector<std::string> outdated;
+
+        try {
+                devices = cache::client()->getDeviceKeys(users, outdated);
+        } catch (const lmdb::error &e) {
+                nhlog::db()->warn("failed to retrieve saved device keys: {}", e.what());
+
+                devices.clear();
+                outdated = users;
+        }
+
+        if (outdated.empty()) {
+                callback(devices);
+                return;
+        }
+
+        nhlog::crypto()->info("querying device keys for {} users ({} up-to-date)",
+                              outdated.size(),
+                              devices.size());
+
+        // A device list that changes while the query runs isn't saved as up-to-date.
+        std::map<std::string, uint64_t> generations;
+
         mtx::requests::QueryKeys req;
-        req.device_keys[user_id] = {device_id};
+        for (const auto &user : outdated) {
+                req.device_keys[user] = {};
+                generations[user]     = cache::client()->deviceListGeneration(user);
+        }
 
         http::client()->query_keys(
           req,
-          [payload, user_id, device_id](const mtx::responses::QueryKeys &res,
-                                        mtx::http::RequestErr err) {
+          [devices = std::move(devices), generations, callback](
+            const mtx::responses::QueryKeys &res, mtx::http::RequestErr err) mutable {
                   if (err) {
                           nhlog::net()->warn("failed to query device keys: {} {}",
                                              err->matrix_error.error,
                                              static_cast<int>(err->status_code));
+                          // TODO: Mark the event as failed. Communicate with the UI.
                           return;
                   }
 
-                  nhlog::net()->warn("retrieved device keys from {}, {}", user_id, device_id);
+                  for (const auto &user : res.device_keys) {
+                          auto generation = generations.find(user.first);
+                          if (generation == generations.end()) {
+                                  nhlog::crypto()->warn("ignoring unrequested device keys of {}",
+                                                        user.first);
+                                  continue;
+                          }
 
-                  if (res.device_keys.empty()) {
-                          nhlog::net()->warn("no devices retrieved {}", user_id);
-                          return;
-                  }
+                          DeviceKeysList verified;
+
+                          for (const auto &dev : user.second) {
+                                  // The server can't hand out the keys of a device under
+                                  // another user or device id.
+                                  if (dev.second.user_id != user.first ||
+                                      dev.second.device_id != dev.first) {
+                                          nhlog::crypto()->warn(
+                                            "ignoring mismatched keys for device {} of {}",
+                                            dev.first,
+                                            user.first);
+                                          continue;
+                                  }
+
+                                  const auto user_id   = UserId(dev.second.user_id);
+                                  const auto device_id = DeviceId(dev.second.device_id);
+
+                                  const auto device_keys = dev.second.keys;
+                                  const auto curveKey    = "curve25519:" + device_id.get();
+                                  const auto edKey       = "ed25519:" + device_id.get();
+
+                                  if ((device_keys.find(curveKey) == device_keys.end()) ||
+                                      (device_keys.find(edKey) == device_keys.end())) {
+                                          nhlog::net()->debug(
+                                            "ignoring malformed keys for device {}",
+                                            device_id.get());
+                                          continue;
+                                  }
+
+                                  DevicePublicKeys pks;
+                                  pks.ed25519    = device_keys.at(edKey);
+                                  pks.curve25519 = device_keys.at(curveKey);
+
+                                  try {
+                                          if (!mtx::crypto::verify_identity_signature(
+                                                json(dev.second), device_id, user_id)) {
+                                                  nhlog::crypto()->warn(
+                                                    "failed to verify identity keys: {}",
+                                                    json(dev.second).dump(2));
+                                                  continue;
+                                          }
+                                  } catch (const json::exception &e) {
+                                          nhlog::crypto()->warn(
+                                            "failed to parse device key json: {}", e.what());
+                                          continue;
+                                  } catch (const mtx::crypto::olm_exception &e) {
+                                          nhlog::crypto()->warn(
+                                            "failed to verify device key json: {}", e.what());
+                                          continue;
+                                  }
+
+                                  verified.emplace(device_id.get(), pks);
+                          }
 
-                  auto device = res.device_keys.begin()->second;
-                  if (device.empty()) {
-                          nhlog::net()->warn("no keys retrieved from user, device {}", user_id);
-                          return;
+                          try {
+                                  cache::client()->setDeviceList(
+                                    user.first, verified, generation->second);
+                          } catch (const lmdb::error &e) {
+                                  nhlog::db()->warn(
+                                    "failed to save device list of {}: {}", user.first, e.what());
+                          }
+
+                          devices[user.first] = std::move(verified);
                   }
 
-                  const auto device_keys = device.begin()->second.keys;
-                  const auto curveKey    = "curve25519:" + device_id;
-                  const auto edKey       = "ed25519:" + device_id;
+                  callback(devices);
+          });
+}
+
+bool
+outbound_session_expired(const OutboundGroupSessionData &data,
+                         const MegolmRotation &rotation,
+                         const std::vector<std::string> &members,
+                         const UserDeviceKeys &devices)
+{
+        const auto max_msgs =
+          rotation.period_msgs > 0 ? rotation.period_msgs : MEGOLM_ROTATION_MSGS;
+        if (data.message_index >= max_msgs)
+                return true;
+
+        const uint64_t default_age =
+          std::chrono::duration_cast<std::chrono::milliseconds>(MEGOLM_ROTATION_PERIOD).count();
+        const auto max_age = rotation.period_ms > 0 ? rotation.period_ms : default_age;
+        if (current_timestamp() - data.timestamp >= max_age)
+                return true;
+
+        // Devices that are no longer part of the room shouldn't be able to read new messages.
+        for (const auto &user : data.shared_with) {
+                if (std::find(members.begin(), members.end(), user.first) == members.end())
+                        return true;
+
+                // The device list couldn't be retrieved, nothing says a device is gone.
+                const auto current = devices.find(user.first);
+                if (current == devices.end())
+                        continue;
+
+                for (const auto &device_id : user.second) {
+                        if (current->second.find(device_id) == current->second.end())
+                                return true;
+                }
+        }
+
+        return false;
+}
+
+//! Whether the key distribution of the room was cancelled. It is then marked as interrupted.
+static bool
+share_interrupted(const std::string &room_id)
+{
+        std::unique_lock<std::mutex> lock(pending_shares_mtx);
+
+        auto it = pending_shares.find(room_id);
+        if (it == pending_shares.end() || !it->second.cancelled)
+                return false;
+
+        it->second.interrupted = true;
+        return true;
+}
+
+static void
+finish_share(const std::string &room_id)
+{
+        PendingShare share;
+        {
+                std::unique_lock<std::mutex> lock(pending_shares_mtx);
+
+                auto it = pending_shares.find(room_id);
+                if (it == pending_shares.end())
+                        return;
+
+                share = std::move(it->second);
+
+                // The distribution stays in progress while the messages are encrypted, so a
+                // concurrent call joins it instead of rotating the session under them.
+                if (share.distributed && !share.interrupted && !share.callbacks.empty())
+                        it->second = PendingShare();
+                else
+                        pending_shares.erase(it);
+        }
+
+        if (share.callbacks.empty())
+                return;
+
+        // Messages were queued while the distribution was being cancelled, so we
+        // start over to reach the devices that were skipped.
+        if (share.interrupted) {
+                share_megolm_session(room_id,
+                                     [callbacks = std::move(share.callbacks)](bool shared) {
+                                             for (const auto &callback : callbacks)
+                                                     callback(shared);
+                                     });
+                return;
+        }
+
+        if (!share.distributed)
+                nhlog::crypto()->warn("failing {} pending messages for {}: "
+                                      "the megolm session couldn't be shared",
+                                      share.callbacks.size(),
+                                      room_id);
+
+        for (const auto &callback : share.callbacks)
+                callback(share.distributed);
+
+        if (!share.distributed)
+                return;
+
+        // The calls that joined in the meantime need a distribution of their own.
+        std::vector<std::function<void(bool)>> joined;
+        {
+                std::unique_lock<std::mutex> lock(pending_shares_mtx);
+
+                auto it = pending_shares.find(room_id);
+                if (it != pending_shares.end()) {
+                        joined = std::move(it->second.callbacks);
+                        pending_shares.erase(it);
+                }
+        }
+
+        if (joined.empty())
+                return;
+
+        share_megolm_session(room_id, [joined = std::move(joined)](bool shared) {
+                for (const auto &callback : joined)
+                        callback(shared);
+        });
+}
+
+static void
+create_outbound_megolm_session(const std::string &room_id)
+{
+        nhlog::crypto()->info("creating new outbound megolm session for {}", room_id);
+
+        auto session = olm::client()->init_outbound_group_session();
+
+        OutboundGroupSessionData data;
+        data.session_id    = mtx::crypto::session_id(session.get());
+        data.session_key   = mtx::crypto::session_key(session.get());
+        data.message_index = 0;
+        data.timestamp     = current_timestamp();
+
+        cache::client()->saveOutboundMegolmSession(room_id, data, std::move(session));
+}
+
+static void
+handle_claimed_keys(std::shared_ptr<StateKeeper> keeper,
+                    const std::string &room_id,
+                    const std::string &session_id,
+                    const std::map<std::string, std::string> &room_keys,
+                    const DeviceKeysList &pks,
+                    const std::string &user_id,
+                    const mtx::responses::ClaimKeys &res,
+                    mtx::http::RequestErr err)
+{
+        if (err) {
+                nhlog::net()->warn("claim keys error: {} {} {}",
+                                   err->matrix_error.error,
+                                   err->parse_error,
+                                   static_cast<int>(err->status_code));
+                return;
+        }
+
+        nhlog::net()->debug("claimed keys for {}", user_id);
+
+        if (res.one_time_keys.find(user_id) == res.one_time_keys.end()) {
+                nhlog::net()->debug("no one-time keys found for user_id: {}", user_id);
+                return;
+        }
+
+        auto retrieved_devices = res.one_time_keys.at(user_id);
+
+        // Payload with all the to_device message to be sent.
+        json body;
+        body["messages"][user_id] = json::object();
+
+        std::vector<std::string> sent_devices;
+
+        for (const auto &rd : retrieved_devices) {
+                const auto device_id = rd.first;
+
+                if (pks.find(device_id) == pks.end()) {
+                        nhlog::net()->critical("couldn't find public key for device: {}",
+                                               device_id);
+                        continue;
+                }
+
+                if (room_keys.find(device_id) == room_keys.end()) {
+                        nhlog::net()->critical("couldn't find m.room_key for device: {}",
+                                               device_id);
+                        continue;
+                }
+
+                const auto id_key = pks.at(device_id).curve25519;
+
+                try {
+                        // TODO: Verify signatures
+                        auto otk = rd.second.begin()->at("key");
+                        auto s   = olm::client()->create_outbound_session(id_key, otk);
+
+                        auto device_msg = olm::client()->create_olm_encrypted_content(
+                          s.get(), room_keys.at(device_id), id_key);
+
+                        cache::client()->saveOlmSession(id_key, std::move(s));
+
+                        body["messages"][user_id][device_id] = device_msg;
+                        sent_devices.push_back(device_id);
+                } catch (const json::exception &e) {
+                        nhlog::crypto()->warn(
+                          "invalid one-time key for {}: {}", device_id, e.what());
+                } catch (const lmdb::error &e) {
+                        nhlog::db()->critical("failed to save outbound olm session: {}", e.what());
+                } catch (const mtx::crypto::olm_exception &e) {
+                        nhlog::crypto()->critical("failed to create outbound olm session: {}",
+                                                  e.what());
+                }
+        }
+
+        if (sent_devices.empty() || share_interrupted(room_id))
+                return;
+
+        nhlog::net()->info("send_to_device: {} ({} devices)", user_id, sent_devices.size());
+
+        http::client()->send_to_device(
+          "m.room.encrypted",
+          body,
+          [keeper, room_id, session_id, user_id, sent_devices](mtx::http::RequestErr err) {
+                  // The pending message is only sent after the key has been delivered.
+                  (void)keeper;
 
-                  if ((device_keys.find(curveKey) == device_keys.end()) ||
-                      (device_keys.find(edKey) == device_keys.end())) {
-                          nhlog::net()->debug("ignoring malformed keys for device {}", device_id);
+                  if (err) {
+                          nhlog::net()->warn("failed to send "
+                                             "send_to_device "
+                                             "message: {}",
+                                             err->matrix_error.error);
                           return;
                   }
 
-                  DevicePublicKeys pks;
-                  pks.ed25519    = device_keys.at(edKey);
-                  pks.curve25519 = device_keys.at(curveKey);
-
                   try {
-                          if (!mtx::crypto::verify_identity_signature(json(device.begin()->second),
-                                                                      DeviceId(device_id),
-                                                                      UserId(user_id))) {
-                                  nhlog::crypto()->warn("failed to verify identity keys: {}",
-                                                        json(device).dump(2));
-                                  return;
-                          }
-                  } catch (const json::exception &e) {
-                          nhlog::crypto()->warn("failed to parse device key json: {}", e.what());
-                          return;
-                  } catch (const mtx::crypto::olm_exception &e) {
-                          nhlog::crypto()->warn("failed to verify device key json: {}", e.what());
-                          return;
+                          cache::client()->markOutboundMegolmSessionShared(
+                            room_id, session_id, user_id, sent_devices);
+                  } catch (const lmdb::error &e) {
+                          nhlog::db()->warn("failed to save shared devices of {}: {}",
+                                            session_id,
+                                            e.what());
                   }
+          });
+}
+
+void
+share_megolm_session(const std::string &room_id, std::function<void(bool)> callback)
+{
+        using namespace mtx::identifiers;
+
+        {
+                std::unique_lock<std::mutex> lock(pending_shares_mtx);
+
+                const bool in_progress = pending_shares.find(room_id) != pending_shares.end();
+
+                auto &share     = pending_shares[room_id];
+                share.cancelled = false;
+
+                if (callback)
+                        share.callbacks.push_back(std::move(callback));
+
+                // Join the distribution that is already running.
+                if (in_progress)
+                        return;
+        }
+
+        // Completes the distribution once every request below has finished.
+        auto keeper = std::make_shared<StateKeeper>([room_id]() { finish_share(room_id); });
 
-                  auto room_key = olm::client()
-                                    ->create_room_key_event(UserId(user_id), pks.ed25519, payload)
+        std::vector<std::string> members;
+        try {
+                members = cache::client()->roomMembers(room_id);
+        } catch (const lmdb::error &e) {
+                nhlog::db()->critical("failed to retrieve members of {}: {}", room_id, e.what());
+                return;
+        }
+
+        get_device_keys(members, [room_id, members, keeper](const UserDeviceKeys &devices) {
+                if (share_interrupted(room_id))
+                        return;
+
+                OutboundGroupSessionDataRef res;
+
+                try {
+                        if (!cache::client()->outboundMegolmSessionExists(room_id) ||
+                            outbound_session_expired(
+                              cache::client()->getOutboundMegolmSession(room_id).data,
+                              cache::client()->megolmRotation(room_id),
+                              members,
+                              devices))
+                                create_outbound_megolm_session(room_id);
+
+                        res = cache::client()->getOutboundMegolmSession(room_id);
+                } catch (const lmdb::error &e) {
+                        nhlog::db()->critical(
+                          "failed to open outbound megolm session ({}): {}", room_id, e.what());
+                        return;
+                } catch (const mtx::crypto::olm_exception &e) {
+                        nhlog::crypto()->critical(
+                          "failed to open outbound megolm session ({}): {}", room_id, e.what());
+                        return;
+                }
+
+                // The key is shared at the current ratchet index so that new
+                // devices can't decrypt the messages sent before they joined.
+                const auto megolm_payload =
+                  json{{"algorithm", MEGOLM_ALGO},
+                       {"room_id", room_id},
+                       {"session_id", res.data.session_id},
+                       {"session_key", mtx::crypto::session_key(res.session)}};
+
+                {
+                        std::unique_lock<std::mutex> lock(pending_shares_mtx);
+                        pending_shares[room_id].distributed = true;
+                }
+
+                for (const auto &user : devices) {
+                        const auto shared = res.data.shared_with.find(user.first);
+
+                        // Mapping from a device_id with valid identity keys to the
+                        // generated room_key event used for sharing the megolm session.
+                        std::map<std::string, std::string> room_key_msgs;
+                        DeviceKeysList deviceKeys;
+
+                        for (const auto &dev : user.second) {
+                                if (shared != res.data.shared_with.end() &&
+                                    shared->second.count(dev.first) != 0)
+                                        continue;
+
+                                auto room_key =
+                                  olm::client()
+                                    ->create_room_key_event(
+                                      UserId(user.first), dev.second.ed25519, megolm_payload)
                                     .dump();
 
-                  http::client()->claim_keys(
-                    user_id,
-                    {device_id},
-                    [room_key, user_id, device_id, pks](const mtx::responses::ClaimKeys &res,
-                                                        mtx::http::RequestErr err) {
-                            if (err) {
-                                    nhlog::net()->warn("claim keys error: {} {} {}",
-                                                       err->matrix_error.error,
-                                                       err->parse_error,
-                                                       static_cast<int>(err->status_code));
-                                    return;
-                            }
-
-                            nhlog::net()->info("claimed keys for {}", user_id);
-
-                            if (res.one_time_keys.size() == 0) {
-                                    nhlog::net()->info("no one-time keys found for user_id: {}",
-                                                       user_id);
-                                    return;
-                            }
-
-                            if (res.one_time_keys.find(user_id) == res.one_time_keys.end()) {
-                                    nhlog::net()->info("no one-time keys found for user_id: {}",
-                                                       user_id);
-                                    return;
-                            }
-
-                            auto retrieved_devices = res.one_time_keys.at(user_id);
-                            if (retrieved_devices.empty()) {
-                                    nhlog::net()->info("claiming keys for {}: no retrieved devices",
-                                                       device_id);
-                                    return;
-                            }
-
-                            json body;
-                            body["messages"][user_id] = json::object();
-
-                            auto device = retrieved_devices.begin()->second;
-                            nhlog::net()->debug("{} : \n {}", device_id, device.dump(2));
-
-                            json device_msg;
-
-                            try {
-                                    auto olm_session = olm::client()->create_outbound_session(
-                                      pks.curve25519, device.begin()->at("key"));
-
-                                    device_msg = olm::client()->create_olm_encrypted_content(
-                                      olm_session.get(), room_key, pks.curve25519);
-
-                                    cache::client()->saveOlmSession(pks.curve25519,
-                                                                    std::move(olm_session));
-                            } catch (const json::exception &e) {
-                                    nhlog::crypto()->warn("creating outbound session: {}",
-                                                          e.what());
-                                    return;
-                            } catch (const mtx::crypto::olm_exception &e) {
-                                    nhlog::crypto()->warn("creating outbound session: {}",
-                                                          e.what());
-                                    return;
-                            }
-
-                            body["messages"][user_id][device_id] = device_msg;
-
-                            nhlog::net()->info(
-                              "sending m.room_key event to {}:{}", user_id, device_id);
-                            http::client()->send_to_device(
-                              "m.room.encrypted", body, [user_id](mtx::http::RequestErr err) {
-                                      if (err) {
-                                              nhlog::net()->warn("failed to send "
-                                                                 "send_to_device "
-                                                                 "message: {}",
-                                                                 err->matrix_error.error);
-                                      }
-
-                                      nhlog::net()->info("m.room_key send to {}", user_id);
-                              });
-                    });
-          });
+                                room_key_msgs.emplace(dev.first, room_key);
+                                deviceKeys.emplace(dev.first, dev.second);
+                        }
+
+                        if (room_key_msgs.empty())
+                                continue;
+
+                        std::vector<std::string> valid_devices;
+                        valid_devices.reserve(room_key_msgs.size());
+                        for (auto const &d : room_key_msgs)
+                                valid_devices.push_back(d.first);
+
+                        nhlog::net()->info("sending claim request for user {} with {} devices",
+                                           user.first,
+                                           valid_devices.size());
+
+                        http::client()->claim_keys(user.first,
+                                                   valid_devices,
+                                                   std::bind(&handle_claimed_keys,
+                                                             keeper,
+                                                             room_id,
+                                                             res.data.session_id,
+                                                             room_key_msgs,
+                                                             deviceKeys,
+                                                             user.first,
+                                                             std::placeholders::_1,
+                                                             std::placeholders::_2));
+                }
+        });
+}
+
+void
+prepare_megolm_session(const std::string &room_id)
+{
+        share_megolm_session(room_id, nullptr);
+}
+
+void
+cancel_megolm_session_share(const std::string &room_id)
+{
+        std::unique_lock<std::mutex> lock(pending_shares_mtx);
+
+        auto it = pending_shares.find(room_id);
+
+        // Pending messages still need the key.
+        if (it == pending_shares.end() || !it->second.callbacks.empty())
+                return;
+
+        nhlog::crypto()->debug("cancelling megolm session preparation for {}", room_id);
+        it->second.cancelled = true;
 }
 
 } // namespace olm
@@ -2,10 +2,14 @@
 
 #include <boost/optional.hpp>
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <mtx.hpp>
 #include <mtxclient/crypto/client.hpp>
 
+#include "Cache.h"
+
 constexpr auto OLM_ALGO = "m.olm.v1.curve25519-aes-sha2";
 
 namespace olm {
@@ -35,29 +39,57 @@ from_json(const nlohmann::json &obj, OlmMessage &msg)
                            .get<std::map<std::string, mtx::events::msg::OlmCipherContent>>();
 }
 
-mtx::crypto::OlmClient *
+//! Exclusive access to the olm client, which can't be used by several threads at once.
+//! The lock is held as long as the object lives, i.e for the whole statement with
+//! `olm::client()->...`, or for a scope with `auto client = olm::client();`.
+class ClientLock
+{
+public:
+        ClientLock(mtx::crypto::OlmClient *client, std::recursive_mutex &mtx)
+          : client_(client)
+          , lock_(mtx)
+        {}
+
+        mtx::crypto::OlmClient *operator->() const { return client_; }
+
+private:
+        mtx::crypto::OlmClient *client_;
+        std::unique_lock<std::recursive_mutex> lock_;
+};
+
+ClientLock
 client();
 
+//! Handle the to_device messages that the cache saved along with the syncs, on
+//! background workers outside of the sync path. Messages already being handled are
+//! skipped. A message is dropped from the cache only once the sessions it established
+//! have been saved, so the ones interrupted by a restart are handled by the next call.
+//!
+//! The callback receives the indices of the new inbound megolm sessions, so the events
+//! waiting on them can be decrypted.
 void
-handle_to_device_messages(const std::vector<nlohmann::json> &msgs);
+handle_to_device_messages(std::function<void(const std::vector<MegolmSessionIndex> &)> callback);
 
 nlohmann::json
 try_olm_decryption(const std::string &sender_key,
                    const mtx::events::msg::OlmCipherContent &content);
 
 void
-handle_olm_message(const OlmMessage &msg);
+handle_olm_message(const OlmMessage &msg, InboundMegolmSessions &sessions);
 
 //! Establish a new inbound megolm session with the decrypted payload from olm.
+//! The session is added to `sessions` so it can be saved along with the others.
 void
 create_inbound_megolm_session(const std::string &sender,
                               const std::string &sender_key,
-                              const nlohmann::json &payload);
+                              const nlohmann::json &payload,
+                              InboundMegolmSessions &sessions);
 
 void
 handle_pre_key_olm_message(const std::string &sender,
                            const std::string &sender_key,
-                           const mtx::events::msg::OlmCipherContent &content);
+                           const mtx::events::msg::OlmCipherContent &content,
+                           InboundMegolmSessions &sessions);
 
 mtx::events::msg::Encrypted
 encrypt_group_message(const std::string &room_id,
@@ -67,6 +99,10 @@ encrypt_group_message(const std::string &room_id,
 void
 mark_keys_as_published();
 
+//! Generate new one-time keys and create the request to upload them.
+mtx::requests::UploadKeys
+generate_one_time_keys(int nkeys);
+
 //! Request the encryption keys from sender's device for the given event.
 void
 request_keys(const std::string &room_id, const std::string &event_id);
@@ -83,4 +119,44 @@ send_megolm_key_to_device(const std::string &user_id,
                           const std::string &device_id,
                           const json &payload);
 
+//! user_id -> verified keys of the user's devices.
+using UserDeviceKeys = std::map<std::string, DeviceKeysList>;
+
+//! Retrieve the verified keys of all the devices of the given users.
+//!
+//! Device lists that are up-to-date in the cache are reused, so only users
+//! whose devices have changed (or were never seen) are queried from the server.
+void
+get_device_keys(const std::vector<std::string> &users,
+                std::function<void(const UserDeviceKeys &)> callback);
+
+//! Whether the outbound session should be replaced, either because it reached the
+//! message count or age limit of the room or because it was shared with devices no
+//! longer present. Users missing from `devices` (e.g their key query failed) don't count
+//! as gone, only users missing from `members` do.
+bool
+outbound_session_expired(const OutboundGroupSessionData &data,
+                         const MegolmRotation &rotation,
+                         const std::vector<std::string> &members,
+                         const UserDeviceKeys &devices);
+
+//! Make sure the key of the room's outbound megolm session has been sent to every
+//! device of the room members, creating or rotating the session when needed.
+//!
+//! Only the devices that haven't received the key yet are contacted. The callback is
+//! invoked once all the pending to_device messages have been sent, and is told whether
+//! the key could be distributed at all. Calls made while a distribution is running for
+//! the room join it instead of starting a new one.
+void
+share_megolm_session(const std::string &room_id, std::function<void(bool)> callback);
+
+//! Create and distribute the outbound session of the room in the background,
+//! so that the next message can be encrypted and sent right away.
+void
+prepare_megolm_session(const std::string &room_id);
+
+//! Stop the preparation of the room's outbound session, unless messages are waiting on it.
+void
+cancel_megolm_session_share(const std::string &room_id);
+
 } // namespace olm
@@ -20,11 +20,14 @@
 #include <QStringListModel>
 #include <QStyleOption>
 #include <QTimer>
-#include <QtConcurrent>
 
 #include "QuickSwitcher.h"
+#include "SearchSession.h"
 #include "SuggestionsPopup.h"
 
+//! Number of rooms suggested at a time.
+constexpr std::size_t MAX_SUGGESTIONS = 5;
+
 RoomSearchInput::RoomSearchInput(QWidget *parent)
   : TextField(parent)
 {}
@@ -60,7 +63,6 @@ RoomSearchInput::hideEvent(QHideEvent *event)
 QuickSwitcher::QuickSwitcher(QWidget *parent)
   : QWidget(parent)
 {
-        qRegisterMetaType<std::vector<RoomSearchResult>>();
         setMaximumWidth(450);
 
         QFont font;
@@ -73,10 +75,22 @@ QuickSwitcher::QuickSwitcher(QWidget *parent)
         topLayout_ = new QVBoxLayout(this);
         topLayout_->addWidget(roomSearch_);
 
-        connect(this,
-                &QuickSwitcher::queryResults,
+        search_ = new SearchSession(MAX_SUGGESTIONS, this);
+        search_->setSource([](Cache *cache) { return cache->roomSearchCandidates(); });
+
+        connect(search_,
+                &SearchSession::resultsReady,
                 this,
-                [this](const std::vector<RoomSearchResult> &rooms) {
+                [this](const std::vector<SearchCandidate> &results) {
+                        std::vector<RoomSearchResult> rooms;
+                        for (const auto &result : results) {
+                                RoomInfo info;
+                                info.name       = result.name;
+                                info.avatar_url = result.avatar_url;
+
+                                rooms.push_back(RoomSearchResult{result.id, std::move(info)});
+                        }
+
                         auto pos = mapToGlobal(roomSearch_->geometry().bottomLeft());
 
                         popup_.setFixedWidth(width());
@@ -87,18 +101,12 @@ QuickSwitcher::QuickSwitcher(QWidget *parent)
 
         connect(roomSearch_, &QLineEdit::textEdited, this, [this](const QString &query) {
                 if (query.isEmpty()) {
+                        search_->cancel();
                         popup_.hide();
                         return;
                 }
 
-                QtConcurrent::run([this, query = query.toLower()]() {
-                        try {
-                                emit queryResults(
-                                  cache::client()->searchRooms(query.toStdString()));
-                        } catch (const lmdb::error &e) {
-                                qWarning() << "room search failed:" << e.what();
-                        }
-                });
+                search_->setQuery(query.toLower().toStdString());
         });
 
         connect(roomSearch_,
@@ -120,6 +128,16 @@ QuickSwitcher::QuickSwitcher(QWidget *parent)
         });
 }
 
+void
+QuickSwitcher::reset()
+{
+        // The rooms might have changed by the next time the switcher is opened.
+        search_->reset();
+
+        emit closing();
+        roomSearch_->clear();
+}
+
 void
 QuickSwitcher::paintEvent(QPaintEvent *)
 {
@@ -25,7 +25,7 @@
 #include "SuggestionsPopup.h"
 #include "ui/TextField.h"
 
-Q_DECLARE_METATYPE(std::vector<RoomSearchResult>)
+class SearchSession;
 
 class RoomSearchInput : public TextField
 {
@@ -54,7 +54,6 @@ public:
 signals:
         void closing();
         void roomSelected(const QString &roomid);
-        void queryResults(const std::vector<RoomSearchResult> &rooms);
 
 protected:
         void keyPressEvent(QKeyEvent *event) override;
@@ -62,11 +61,7 @@ protected:
         void paintEvent(QPaintEvent *event) override;
 
 private:
-        void reset()
-        {
-                emit closing();
-                roomSearch_->clear();
-        }
+        void reset();
 
         // Current highlighted selection from the completer.
         int selection_ = -1;
@@ -74,6 +69,9 @@ private:
         QVBoxLayout *topLayout_;
         RoomSearchInput *roomSearch_;
 
+        //! The rooms are read once every time the switcher opens.
+        SearchSession *search_;
+
         //! Autocomplete popup box with the room suggestions.
         SuggestionsPopup popup_;
 };
@@ -30,9 +30,6 @@
 
 constexpr int MaxUnreadCountDisplayed = 99;
 
-constexpr int IconSize = 44;
-// constexpr int MaxHeight        = IconSize + 2 * Padding;
-
 struct WidgetMetrics
 {
         int maxHeight;
@@ -133,14 +130,13 @@ RoomInfoListItem::resizeEvent(QResizeEvent *)
 
         ripple_overlay_->setClipPath(path);
         ripple_overlay_->setClipping(true);
+
+        invalidateStaticContent();
 }
 
 void
-RoomInfoListItem::paintEvent(QPaintEvent *event)
+RoomInfoListItem::paintStaticContent(QPainter &p, VisualState state)
 {
-        Q_UNUSED(event);
-
-        QPainter p(this);
         p.setRenderHint(QPainter::TextAntialiasing);
         p.setRenderHint(QPainter::SmoothPixmapTransform);
         p.setRenderHint(QPainter::Antialiasing);
@@ -152,11 +148,11 @@ RoomInfoListItem::paintEvent(QPaintEvent *event)
 
         auto wm = getMetrics(QFont{});
 
-        if (isPressed_) {
+        if (state == Pressed) {
                 p.fillRect(rect(), highlightedBackgroundColor_);
                 titlePen.setColor(highlightedTitleColor_);
                 subtitlePen.setColor(highlightedSubtitleColor_);
-        } else if (underMouse()) {
+        } else if (state == Hovered) {
                 p.fillRect(rect(), hoverBackgroundColor_);
                 titlePen.setColor(hoverTitleColor_);
                 subtitlePen.setColor(hoverSubtitleColor_);
@@ -173,6 +169,12 @@ RoomInfoListItem::paintEvent(QPaintEvent *event)
 
         const auto sidebarSizes = utils::calculateSidebarSizes(QFont{});
 
+        padding_          = wm.padding;
+        bottomY_          = bottom_y;
+        smallWidth_       = sidebarSizes.small;
+        unreadLineWidth_  = wm.unreadLineWidth;
+        unreadLineOffset_ = wm.unreadLineOffset;
+
         if (width() > sidebarSizes.small) {
                 QFont headingFont;
                 headingFont.setWeight(QFont::Medium);
@@ -227,9 +229,9 @@ RoomInfoListItem::paintEvent(QPaintEvent *event)
 
                         // We show the last message timestamp.
                         p.save();
-                        if (isPressed_) {
+                        if (state == Pressed) {
                                 p.setPen(QPen(highlightedTimestampColor_));
-                        } else if (underMouse()) {
+                        } else if (state == Hovered) {
                                 p.setPen(QPen(hoverTimestampColor_));
                         } else {
                                 p.setPen(QPen(timestampColor_));
@@ -297,6 +299,33 @@ RoomInfoListItem::paintEvent(QPaintEvent *event)
                 p.drawPixmap(avatarRegion, roomAvatar_);
                 p.restore();
         }
+}
+
+void
+RoomInfoListItem::paintEvent(QPaintEvent *event)
+{
+        Q_UNUSED(event);
+
+        const auto state = isPressed_ ? Pressed : (underMouse() ? Hovered : Normal);
+        const auto ratio = devicePixelRatioF();
+
+        // The text is laid out again only when what it shows changes.
+        auto &content = staticContent_[state];
+        if (content.isNull() || content.devicePixelRatioF() != ratio ||
+            content.size() != size() * ratio) {
+                content = QPixmap(size() * ratio);
+                content.setDevicePixelRatio(ratio);
+                content.fill(Qt::transparent);
+
+                QPainter painter(&content);
+                paintStaticContent(painter, state);
+        }
+
+        QPainter p(this);
+        p.drawPixmap(0, 0, content);
+
+        p.setRenderHint(QPainter::TextAntialiasing);
+        p.setRenderHint(QPainter::Antialiasing);
 
         if (unreadMsgCount_ > 0) {
                 QBrush brush;
@@ -316,12 +345,12 @@ RoomInfoListItem::paintEvent(QPaintEvent *event)
                                       ? QFontMetrics(p.font()).averageCharWidth()
                                       : 0;
 
-                QRectF r(width() - bubbleDiameter_ - wm.padding - x_width,
-                         bottom_y - bubbleDiameter_ / 2 - 5,
+                QRectF r(width() - bubbleDiameter_ - padding_ - x_width,
+                         bottomY_ - bubbleDiameter_ / 2 - 5,
                          bubbleDiameter_ + x_width,
                          bubbleDiameter_);
 
-                if (width() == sidebarSizes.small)
+                if (width() == smallWidth_)
                         r = QRectF(width() - bubbleDiameter_ - 5,
                                    height() - bubbleDiameter_ - 5,
                                    bubbleDiameter_ + x_width,
@@ -345,21 +374,54 @@ RoomInfoListItem::paintEvent(QPaintEvent *event)
 
         if (!isPressed_ && hasUnreadMessages_) {
                 QPen pen;
-                pen.setWidth(wm.unreadLineWidth);
+                pen.setWidth(unreadLineWidth_);
                 pen.setColor(highlightedBackgroundColor_);
 
                 p.setPen(pen);
-                p.drawLine(0, wm.unreadLineOffset, 0, height() - wm.unreadLineOffset);
+                p.drawLine(0, unreadLineOffset_, 0, height() - unreadLineOffset_);
         }
 }
 
 void
 RoomInfoListItem::updateUnreadMessageCount(int count)
 {
+        // The timestamp leaves room for the unread bubble.
+        if ((count > 0) != (unreadMsgCount_ > 0))
+                invalidateStaticContent();
+
         unreadMsgCount_ = count;
         update();
 }
 
+void
+RoomInfoListItem::invalidateStaticContent()
+{
+        for (auto &content : staticContent_)
+                content = QPixmap();
+
+        update();
+}
+
+void
+RoomInfoListItem::hideEvent(QHideEvent *event)
+{
+        // Only the items in the viewport of the room list keep their rendering.
+        invalidateStaticContent();
+
+        QWidget::hideEvent(event);
+}
+
+void
+RoomInfoListItem::changeEvent(QEvent *event)
+{
+        // The theme sets the colors through the style sheet.
+        if (event->type() == QEvent::StyleChange || event->type() == QEvent::FontChange ||
+            event->type() == QEvent::PaletteChange)
+                invalidateStaticContent();
+
+        QWidget::changeEvent(event);
+}
+
 void
 RoomInfoListItem::setPressedState(bool state)
 {
@@ -380,6 +442,24 @@ RoomInfoListItem::contextMenuEvent(QContextMenuEvent *event)
         menu_->popup(event->globalPos());
 }
 
+void
+RoomInfoListItem::enterEvent(QEvent *event)
+{
+        if (roomType_ == RoomType::Joined)
+                emit hovered(roomId_);
+
+        QWidget::enterEvent(event);
+}
+
+void
+RoomInfoListItem::leaveEvent(QEvent *event)
+{
+        if (roomType_ == RoomType::Joined)
+                emit unhovered(roomId_);
+
+        QWidget::leaveEvent(event);
+}
+
 void
 RoomInfoListItem::mousePressEvent(QMouseEvent *event)
 {
@@ -423,12 +503,12 @@ void
 RoomInfoListItem::setAvatar(const QImage &img)
 {
         roomAvatar_ = utils::scaleImageToPixmap(img, IconSize);
-        update();
+        invalidateStaticContent();
 }
 
 void
 RoomInfoListItem::setDescriptionMessage(const DescInfo &info)
 {
         lastMsgInfo_ = info;
-        update();
+        invalidateStaticContent();
 }
@@ -63,12 +63,18 @@ class RoomInfoListItem : public QWidget
         Q_PROPERTY(QColor btnTextColor READ btnTextColor WRITE setBtnTextColor)
 
 public:
+        //! Size of the room avatar, in device independent pixels.
+        static constexpr int IconSize = 44;
+
         RoomInfoListItem(QString room_id, RoomInfo info, QWidget *parent = 0);
 
         void updateUnreadMessageCount(int count);
         void clearUnreadMessageCount() { updateUnreadMessageCount(0); };
 
-        QString roomId() { return roomId_; }
+        QString roomId() const { return roomId_; }
+        QString roomName() const { return roomName_; }
+        //! The avatar as it is drawn, already scaled.
+        QPixmap avatar() const { return roomAvatar_; }
         bool isPressed() const { return isPressed_; }
         int unreadMessageCount() const { return unreadMsgCount_; }
 
@@ -121,16 +127,23 @@ public:
         void setBubbleFgColor(QColor &color) { bubbleFgColor_ = color; }
         void setBubbleBgColor(QColor &color) { bubbleBgColor_ = color; }
 
-        void setRoomName(const QString &name) { roomName_ = name; }
+        void setRoomName(const QString &name)
+        {
+                roomName_ = name;
+                invalidateStaticContent();
+        }
         void setRoomType(bool isInvite)
         {
                 if (isInvite)
                         roomType_ = RoomType::Invited;
                 else
                         roomType_ = RoomType::Joined;
+
+                invalidateStaticContent();
         }
 
-        bool isInvite() { return roomType_ == RoomType::Invited; }
+        bool isInvite() const { return roomType_ == RoomType::Invited; }
+        bool hasUnreadMessages() const { return hasUnreadMessages_; }
         void setReadState(bool hasUnreadMessages)
         {
                 if (hasUnreadMessages_ != hasUnreadMessages) {
@@ -144,19 +157,48 @@ signals:
         void leaveRoom(const QString &room_id);
         void acceptInvite(const QString &room_id);
         void declineInvite(const QString &room_id);
+        void hovered(const QString &room_id);
+        void unhovered(const QString &room_id);
 
 public slots:
         void setPressedState(bool state);
 
 protected:
         void mousePressEvent(QMouseEvent *event) override;
+        void enterEvent(QEvent *event) override;
+        void leaveEvent(QEvent *event) override;
         void paintEvent(QPaintEvent *event) override;
         void resizeEvent(QResizeEvent *event) override;
+        void hideEvent(QHideEvent *event) override;
+        void changeEvent(QEvent *event) override;
         void contextMenuEvent(QContextMenuEvent *event) override;
 
 private:
         void init(QWidget *parent);
-        QString roomName() { return roomName_; }
+
+        //! How the item looks depending on the interaction with it.
+        enum VisualState
+        {
+                Normal,
+                Hovered,
+                Pressed,
+                VisualStates,
+        };
+
+        //! Draw the background, the avatar and the text of the item.
+        void paintStaticContent(QPainter &p, VisualState state);
+        //! Drop the cached rendering after a change in what it shows.
+        void invalidateStaticContent();
+
+        //! Rendering of the parts that change only with the room info, the size or the theme.
+        QPixmap staticContent_[VisualStates];
+
+        // Geometry computed along with the static content, used by the unread indicators.
+        int padding_          = 0;
+        int bottomY_          = 0;
+        int smallWidth_       = 0;
+        int unreadLineWidth_  = 0;
+        int unreadLineOffset_ = 0;
 
         RippleOverlay *ripple_overlay_;
 
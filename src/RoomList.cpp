@@ -15,21 +15,46 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+
 #include <QApplication>
 #include <QBuffer>
+#include <QDesktopWidget>
 #include <QObject>
+#include <QScrollBar>
 #include <QTimer>
 
+#include "AsyncCache.h"
 #include "Cache.h"
 #include "Logging.h"
 #include "MainWindow.h"
 #include "MatrixClient.h"
 #include "RoomInfoListItem.h"
 #include "RoomList.h"
+#include "StartupProfile.h"
+#include "UiSnapshot.h"
 #include "UserSettingsPage.h"
 #include "Utils.h"
 #include "ui/OverlayModal.h"
 
+//! How long the pointer has to rest on a room before it's reported as hovered.
+constexpr int HOVER_DELAY_MS = 150;
+//! Number of avatars read from the cache and handed to the room list at a time.
+constexpr std::size_t AVATAR_BATCH_SIZE = 32;
+
+namespace {
+//! Timestamp the room list is sorted by.
+uint64_t
+lastActivity(const RoomInfoListItem *room)
+{
+        // Not a room message.
+        if (room->lastMessageInfo().userid.isEmpty())
+                return 0;
+
+        return room->lastMessageInfo().datetime.toMSecsSinceEpoch();
+}
+}
+
 RoomList::RoomList(QWidget *parent)
   : QWidget(parent)
 {
@@ -49,38 +74,212 @@ RoomList::RoomList(QWidget *parent)
         scrollArea_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 #endif
 
+        // Only the rooms in the viewport have their widget placed and shown.
         scrollAreaContents_ = new QWidget(this);
         scrollAreaContents_->setObjectName("roomlist_area");
-
-        contentsLayout_ = new QVBoxLayout(scrollAreaContents_);
-        contentsLayout_->setAlignment(Qt::AlignTop);
-        contentsLayout_->setSpacing(0);
-        contentsLayout_->setMargin(0);
+        scrollAreaContents_->installEventFilter(this);
 
         scrollArea_->setWidget(scrollAreaContents_);
         topLayout_->addWidget(scrollArea_);
 
+        connect(scrollArea_->verticalScrollBar(),
+                &QScrollBar::valueChanged,
+                this,
+                &RoomList::layoutRooms);
+
+        layoutTimer_ = new QTimer(this);
+        layoutTimer_->setSingleShot(true);
+        layoutTimer_->setInterval(0);
+        connect(layoutTimer_, &QTimer::timeout, this, &RoomList::layoutRooms);
+
+        hoverTimer_ = new QTimer(this);
+        hoverTimer_->setSingleShot(true);
+        hoverTimer_->setInterval(HOVER_DELAY_MS);
+        connect(hoverTimer_, &QTimer::timeout, this, [this]() { emit roomHovered(hoveredRoom_); });
+
+        avatarTimer_ = new QTimer(this);
+        avatarTimer_->setSingleShot(true);
+        avatarTimer_->setInterval(0);
+        connect(avatarTimer_, &QTimer::timeout, this, &RoomList::loadAvatars);
+
         connect(this, &RoomList::updateRoomAvatarCb, this, &RoomList::updateRoomAvatar);
 }
 
+bool
+RoomList::eventFilter(QObject *obj, QEvent *event)
+{
+        if (obj == scrollAreaContents_ && event->type() == QEvent::Resize)
+                layoutRooms();
+
+        return QWidget::eventFilter(obj, event);
+}
+
+bool
+RoomList::isBefore(const RoomInfoListItem *a, const RoomInfoListItem *b) const
+{
+        const auto first  = activity_.at(a->roomId());
+        const auto second = activity_.at(b->roomId());
+
+        if (first != second)
+                return first > second;
+
+        return a->roomId() < b->roomId();
+}
+
+void
+RoomList::insertRoom(RoomInfoListItem *room)
+{
+        activity_[room->roomId()] = lastActivity(room);
+
+        const auto before = [this](const RoomInfoListItem *a, const RoomInfoListItem *b) {
+                return isBefore(a, b);
+        };
+
+        order_.insert(std::lower_bound(order_.begin(), order_.end(), room, before), room);
+
+        if (isInFilter(room->roomId()))
+                visible_.insert(std::lower_bound(visible_.begin(), visible_.end(), room, before),
+                                room);
+
+        layoutTimer_->start();
+}
+
+void
+RoomList::takeRoom(RoomInfoListItem *room)
+{
+        if (activity_.find(room->roomId()) == activity_.end())
+                return;
+
+        const auto before = [this](const RoomInfoListItem *a, const RoomInfoListItem *b) {
+                return isBefore(a, b);
+        };
+
+        auto it = std::lower_bound(order_.begin(), order_.end(), room, before);
+        if (it != order_.end() && *it == room)
+                order_.erase(it);
+
+        it = std::lower_bound(visible_.begin(), visible_.end(), room, before);
+        if (it != visible_.end() && *it == room)
+                visible_.erase(it);
+
+        layoutTimer_->start();
+}
+
+void
+RoomList::repositionRoom(const QString &room_id)
+{
+        if (!roomExists(room_id) || rooms_.at(room_id).isNull())
+                return;
+
+        auto room = rooms_.at(room_id).data();
+
+        if (activity_[room_id] == lastActivity(room))
+                return;
+
+        takeRoom(room);
+        insertRoom(room);
+}
+
+void
+RoomList::eraseRoom(const QString &room_id)
+{
+        if (!roomExists(room_id))
+                return;
+
+        auto room = rooms_.at(room_id);
+
+        if (room) {
+                takeRoom(room.data());
+                shown_.erase(std::remove(shown_.begin(), shown_.end(), room.data()),
+                             shown_.end());
+        }
+
+        activity_.erase(room_id);
+        unsorted_.erase(room_id);
+        rooms_.erase(room_id);
+}
+
+void
+RoomList::clear()
+{
+        shown_.clear();
+        order_.clear();
+        visible_.clear();
+        activity_.clear();
+        unsorted_.clear();
+        rooms_.clear();
+        selectedRoom_.clear();
+
+        pendingAvatars_.clear();
+        isDecorating_ = false;
+
+        setInteractive(true);
+}
+
+void
+RoomList::layoutRooms()
+{
+        if (itemHeight_ == 0)
+                return;
+
+        scrollAreaContents_->setMinimumHeight(static_cast<int>(visible_.size()) * itemHeight_);
+
+        const int top    = scrollArea_->verticalScrollBar()->value();
+        const int bottom = top + scrollArea_->viewport()->height();
+
+        const auto first = std::min(static_cast<std::size_t>(top / itemHeight_), visible_.size());
+        const auto last =
+          std::min(static_cast<std::size_t>(bottom / itemHeight_ + 1), visible_.size());
+
+        std::vector<RoomInfoListItem *> shown(visible_.begin() + first, visible_.begin() + last);
+
+        for (const auto room : shown_) {
+                if (std::find(shown.begin(), shown.end(), room) == shown.end())
+                        room->hide();
+        }
+
+        const int width = scrollAreaContents_->width();
+        for (std::size_t i = 0; i < shown.size(); ++i) {
+                shown[i]->setGeometry(
+                  0, static_cast<int>(first + i) * itemHeight_, width, itemHeight_);
+                shown[i]->show();
+        }
+
+        shown_ = std::move(shown);
+}
+
 void
 RoomList::addRoom(const QString &room_id, const RoomInfo &info)
 {
-        auto room_item = new RoomInfoListItem(room_id, info, scrollArea_);
+        auto room_item = new RoomInfoListItem(room_id, info, scrollAreaContents_);
+        room_item->hide();
         room_item->setRoomName(QString::fromStdString(std::move(info.name)));
 
         connect(room_item, &RoomInfoListItem::clicked, this, &RoomList::highlightSelectedRoom);
         connect(room_item, &RoomInfoListItem::leaveRoom, this, [](const QString &room_id) {
                 MainWindow::instance()->openLeaveRoomDialog(room_id);
         });
+        connect(room_item, &RoomInfoListItem::hovered, this, [this](const QString &room_id) {
+                hoveredRoom_ = room_id;
+                hoverTimer_->start();
+        });
+        connect(room_item, &RoomInfoListItem::unhovered, this, [this](const QString &room_id) {
+                // The pointer only passed over the room.
+                if (hoverTimer_->isActive() && hoveredRoom_ == room_id) {
+                        hoverTimer_->stop();
+                        return;
+                }
+
+                emit roomUnhovered(room_id);
+        });
 
         rooms_.emplace(room_id, QSharedPointer<RoomInfoListItem>(room_item));
+        itemHeight_ = room_item->height();
 
         if (!info.avatar_url.empty())
                 updateAvatar(room_id, QString::fromStdString(info.avatar_url));
 
-        int pos = contentsLayout_->count() - 1;
-        contentsLayout_->insertWidget(pos, room_item);
+        insertRoom(room_item);
 }
 
 void
@@ -89,46 +288,126 @@ RoomList::updateAvatar(const QString &room_id, const QString &url)
         if (url.isEmpty())
                 return;
 
-        QByteArray savedImgData;
-
-        if (cache::client())
-                savedImgData = cache::client()->image(url);
-
-        if (savedImgData.isEmpty()) {
-                mtx::http::ThumbOpts opts;
-                opts.mxc_url = url.toStdString();
-                http::client()->get_thumbnail(
-                  opts, [room_id, opts, this](const std::string &res, mtx::http::RequestErr err) {
-                          if (err) {
-                                  nhlog::net()->warn(
-                                    "failed to download room avatar: {} {} {}",
-                                    opts.mxc_url,
-                                    mtx::errors::to_string(err->matrix_error.errcode),
-                                    err->matrix_error.error);
-                                  return;
-                          }
-
-                          if (cache::client())
-                                  cache::client()->saveImage(opts.mxc_url, res);
-
-                          auto data = QByteArray(res.data(), res.size());
-                          QPixmap pixmap;
-                          pixmap.loadFromData(data);
-
-                          emit updateRoomAvatarCb(room_id, pixmap);
-                  });
-        } else {
-                QPixmap img;
-                img.loadFromData(savedImgData);
-
-                updateRoomAvatar(room_id, img);
-        }
+        pendingAvatars_[room_id] = url;
+
+        if (!isLoadingAvatars_)
+                avatarTimer_->start();
+}
+
+void
+RoomList::loadAvatars()
+{
+        if (isLoadingAvatars_ || pendingAvatars_.empty())
+                return;
+
+        // The rooms in the viewport come first, then the rest of the list in order.
+        std::vector<std::pair<QString, QString>> batch;
+
+        auto take = [this, &batch](const QString &room_id) {
+                auto avatar = pendingAvatars_.find(room_id);
+                if (avatar == pendingAvatars_.end() || batch.size() == AVATAR_BATCH_SIZE)
+                        return;
+
+                batch.emplace_back(avatar->first, avatar->second);
+                pendingAvatars_.erase(avatar);
+        };
+
+        for (const auto room : shown_)
+                take(room->roomId());
+
+        for (auto it = visible_.begin(); it != visible_.end() && batch.size() < AVATAR_BATCH_SIZE;
+             ++it)
+                take((*it)->roomId());
+
+        while (!pendingAvatars_.empty() && batch.size() < AVATAR_BATCH_SIZE)
+                take(QString(pendingAvatars_.begin()->first));
+
+        std::vector<std::string> urls;
+        for (const auto &avatar : batch)
+                urls.emplace_back(avatar.second.toStdString());
+
+        // Scaled to the size the room items draw them with, so it's a no-op on the GUI thread.
+        const int size = std::ceil(QApplication::desktop()->screen()->devicePixelRatioF() *
+                                   RoomInfoListItem::IconSize);
+
+        isLoadingAvatars_ = true;
+
+        cache::read(
+          this,
+          [urls, size](Cache *cache) {
+                  std::map<std::string, QImage> images;
+
+                  for (const auto &data : cache->images(urls)) {
+                          QImage img;
+                          if (!img.loadFromData(data.second))
+                                  continue;
+
+                          img = img.scaled(
+                            size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                          images.emplace(data.first, std::move(img));
+                  }
+
+                  return images;
+          },
+          [this, batch](const std::map<std::string, QImage> &images) {
+                  isLoadingAvatars_ = false;
+
+                  for (const auto &avatar : batch) {
+                          if (!roomExists(avatar.first))
+                                  continue;
+
+                          auto img = images.find(avatar.second.toStdString());
+
+                          if (img == images.end())
+                                  downloadAvatar(avatar.first, avatar.second);
+                          else
+                                  updateRoomAvatar(avatar.first, QPixmap::fromImage(img->second));
+                  }
+
+                  // Let the event loop paint the chunk before the next one is delivered.
+                  if (!pendingAvatars_.empty()) {
+                          avatarTimer_->start();
+                          return;
+                  }
+
+                  if (isDecorating_) {
+                          isDecorating_ = false;
+                          nhlog::ui()->info("room list fully decorated in {} ms",
+                                            decorationTimer_.elapsed());
+                  }
+          });
+}
+
+void
+RoomList::downloadAvatar(const QString &room_id, const QString &url)
+{
+        mtx::http::ThumbOpts opts;
+        opts.mxc_url = url.toStdString();
+        http::client()->get_thumbnail(
+          opts, [room_id, opts, this](const std::string &res, mtx::http::RequestErr err) {
+                  if (err) {
+                          nhlog::net()->warn("failed to download room avatar: {} {} {}",
+                                             opts.mxc_url,
+                                             mtx::errors::to_string(err->matrix_error.errcode),
+                                             err->matrix_error.error);
+                          return;
+                  }
+
+                  if (cache::client())
+                          cache::client()->saveImage(opts.mxc_url, res);
+
+                  auto data = QByteArray(res.data(), res.size());
+                  QPixmap pixmap;
+                  pixmap.loadFromData(data);
+
+                  emit updateRoomAvatarCb(room_id, pixmap);
+          });
 }
 
 void
 RoomList::removeRoom(const QString &room_id, bool reset)
 {
-        rooms_.erase(room_id);
+        eraseRoom(room_id);
 
         if (rooms_.empty() || !reset)
                 return;
@@ -173,49 +452,143 @@ void
 RoomList::initialize(const QMap<QString, RoomInfo> &info)
 {
         nhlog::ui()->info("initialize room list");
+        startup::Span span("room list build");
 
-        rooms_.clear();
-
+        decorationTimer_.start();
         setUpdatesEnabled(false);
 
-        for (auto it = info.begin(); it != info.end(); it++) {
-                if (it.value().is_invite)
-                        addInvitedRoom(it.key(), it.value());
-                else
-                        addRoom(it.key(), it.value());
+        // The rooms that are already listed, e.g. from a snapshot, are updated in place.
+        std::vector<QString> stale;
+        for (const auto &room : rooms_) {
+                if (room.second.isNull() || !info.contains(room.first) ||
+                    room.second->isInvite() != info.value(room.first).is_invite)
+                        stale.push_back(room.first);
         }
 
+        for (const auto &room_id : stale)
+                eraseRoom(room_id);
+
+        for (auto it = info.begin(); it != info.end(); it++)
+                updateRoom(it.key(), it.value());
+
         for (auto it = info.begin(); it != info.end(); it++)
                 updateRoomDescription(it.key(), it.value().msgInfo);
 
+        calculateUnreadMessageCount();
+
         setUpdatesEnabled(true);
+        setInteractive(true);
+
+        isDecorating_ = !pendingAvatars_.empty();
 
         if (rooms_.empty())
                 return;
 
+        // Keep the room that was open in the snapshot.
+        if (roomExists(selectedRoom_) && !rooms_.at(selectedRoom_).isNull()) {
+                emit roomChanged(selectedRoom_);
+                return;
+        }
+
         auto room = firstRoom();
         if (room.second.isNull())
                 return;
 
+        selectedRoom_ = room.first;
+
         room.second->setPressedState(true);
         emit roomChanged(room.first);
 }
 
+void
+RoomList::restore(const snapshot::State &state)
+{
+        nhlog::ui()->info("restoring room list from snapshot");
+        startup::Span span("room list snapshot");
+
+        clear();
+
+        setUpdatesEnabled(false);
+
+        for (const auto &room : state.rooms) {
+                if (roomExists(room.room_id))
+                        continue;
+
+                // The avatar comes from the snapshot, not from the cache.
+                RoomInfo info;
+                info.name      = room.name.toStdString();
+                info.is_invite = room.is_invite;
+
+                if (room.is_invite)
+                        addInvitedRoom(room.room_id, info);
+                else
+                        addRoom(room.room_id, info);
+
+                // The mapped file is released after the restoration, so the pixels are copied.
+                auto item = rooms_.at(room.room_id);
+                item->setAvatar(room.avatar.copy());
+                item->updateUnreadMessageCount(room.unreadCount);
+                item->setReadState(room.hasUnreadMessages);
+
+                updateRoomDescription(room.room_id, room.msgInfo);
+        }
+
+        calculateUnreadMessageCount();
+
+        setUpdatesEnabled(true);
+        setInteractive(false);
+
+        if (roomExists(state.current_room)) {
+                selectedRoom_ = state.current_room;
+                rooms_.at(selectedRoom_)->setPressedState(true);
+        }
+}
+
+snapshot::State
+RoomList::snapshot() const
+{
+        snapshot::State state;
+        state.current_room = selectedRoom_;
+
+        for (const auto room : order_) {
+                snapshot::Room entry;
+                entry.room_id           = room->roomId();
+                entry.name              = room->roomName();
+                entry.is_invite         = room->isInvite();
+                entry.msgInfo           = room->lastMessageInfo();
+                entry.unreadCount       = room->unreadMessageCount();
+                entry.hasUnreadMessages = room->hasUnreadMessages();
+                entry.avatar            = room->avatar().toImage();
+
+                state.rooms.push_back(std::move(entry));
+        }
+
+        return state;
+}
+
+void
+RoomList::setInteractive(bool isInteractive)
+{
+        // Scrolling still works, the events reach the scroll area instead.
+        scrollAreaContents_->setAttribute(Qt::WA_TransparentForMouseEvents, !isInteractive);
+}
+
 void
 RoomList::cleanupInvites(const std::map<QString, bool> &invites)
 {
         if (invites.size() == 0)
                 return;
 
-        utils::erase_if(rooms_, [invites](auto &room) {
-                auto room_id = room.first;
-                auto item    = room.second;
+        std::vector<QString> removed;
 
-                if (!item)
-                        return false;
+        for (const auto &room : rooms_) {
+                if (room.second && room.second->isInvite() &&
+                    invites.find(room.first) == invites.end())
+                        removed.push_back(room.first);
+        }
 
-                return item->isInvite() && (invites.find(room_id) == invites.end());
-        });
+        for (const auto &room_id : removed)
+                eraseRoom(room_id);
 }
 
 void
@@ -240,15 +613,21 @@ RoomList::highlightSelectedRoom(const QString &room_id)
                 if (room.second.isNull())
                         continue;
 
-                if (room.first != room_id) {
-                        room.second->setPressedState(false);
-                } else {
-                        room.second->setPressedState(true);
-                        scrollArea_->ensureWidgetVisible(room.second.data());
-                }
+                room.second->setPressedState(room.first == room_id);
         }
 
         selectedRoom_ = room_id;
+
+        // The widget of the room might not be placed, scroll to its position instead.
+        const auto room = rooms_.at(room_id).data();
+        const auto it   = std::find(visible_.begin(), visible_.end(), room);
+
+        if (it != visible_.end() && itemHeight_ > 0) {
+                layoutRooms();
+
+                const int y = static_cast<int>(std::distance(visible_.begin(), it)) * itemHeight_;
+                scrollArea_->ensureVisible(0, y + itemHeight_ / 2, 0, itemHeight_ / 2);
+        }
 }
 
 void
@@ -280,13 +659,12 @@ RoomList::updateRoomDescription(const QString &roomid, const DescInfo &info)
 
         if (underMouse()) {
                 // When the user hover out of the roomlist a sort will be triggered.
+                unsorted_.insert(roomid);
                 isSortPending_ = true;
                 return;
         }
 
-        isSortPending_ = false;
-
-        emit sortRoomsByLastMessage();
+        repositionRoom(roomid);
 }
 
 void
@@ -294,32 +672,11 @@ RoomList::sortRoomsByLastMessage()
 {
         isSortPending_ = false;
 
-        std::multimap<uint64_t, RoomInfoListItem *, std::greater<uint64_t>> times;
-
-        for (int ii = 0; ii < contentsLayout_->count(); ++ii) {
-                auto room = qobject_cast<RoomInfoListItem *>(contentsLayout_->itemAt(ii)->widget());
-
-                if (!room)
-                        continue;
+        // Only the rooms with new activity move.
+        for (const auto &room_id : unsorted_)
+                repositionRoom(room_id);
 
-                // Not a room message.
-                if (room->lastMessageInfo().userid.isEmpty())
-                        times.emplace(0, room);
-                else
-                        times.emplace(room->lastMessageInfo().datetime.toMSecsSinceEpoch(), room);
-        }
-
-        for (auto it = times.cbegin(); it != times.cend(); ++it) {
-                const auto roomWidget   = it->second;
-                const auto currentIndex = contentsLayout_->indexOf(roomWidget);
-                const auto newIndex     = std::distance(times.cbegin(), it);
-
-                if (currentIndex == newIndex)
-                        continue;
-
-                contentsLayout_->removeWidget(roomWidget);
-                contentsLayout_->insertWidget(newIndex, roomWidget);
-        }
+        unsorted_.clear();
 }
 
 void
@@ -343,38 +700,27 @@ RoomList::closeJoinRoomDialog(bool isJoining, QString roomAlias)
 void
 RoomList::removeFilter()
 {
-        setUpdatesEnabled(false);
-        for (int i = 0; i < contentsLayout_->count(); i++) {
-                auto widget =
-                  qobject_cast<RoomInfoListItem *>(contentsLayout_->itemAt(i)->widget());
-                if (widget)
-                        widget->show();
-        }
-        setUpdatesEnabled(true);
+        filter_.clear();
+        isFilterActive_ = false;
+
+        visible_ = order_;
+        layoutRooms();
 }
 
 void
 RoomList::applyFilter(const std::map<QString, bool> &filter)
 {
-        // Disabling paint updates will resolve issues with screen flickering on big room lists.
-        setUpdatesEnabled(false);
-
-        for (int i = 0; i < contentsLayout_->count(); i++) {
-                // If filter contains the room for the current RoomInfoListItem,
-                // show the list item, otherwise hide it
-                auto listitem =
-                  qobject_cast<RoomInfoListItem *>(contentsLayout_->itemAt(i)->widget());
+        filter_         = filter;
+        isFilterActive_ = true;
 
-                if (!listitem)
-                        continue;
-
-                if (filter.find(listitem->roomId()) != filter.end())
-                        listitem->show();
-                else
-                        listitem->hide();
-        }
+        // The rooms of the community keep their order, only the placed widgets change.
+        visible_.clear();
+        std::copy_if(order_.begin(),
+                     order_.end(),
+                     std::back_inserter(visible_),
+                     [this](const RoomInfoListItem *room) { return isInFilter(room->roomId()); });
 
-        setUpdatesEnabled(true);
+        layoutRooms();
 
         // If the already selected room is part of the group, make sure it's visible.
         if (!selectedRoom_.isEmpty() && (filter.find(selectedRoom_) != filter.end()))
@@ -386,14 +732,8 @@ RoomList::applyFilter(const std::map<QString, bool> &filter)
 void
 RoomList::selectFirstVisibleRoom()
 {
-        for (int i = 0; i < contentsLayout_->count(); i++) {
-                auto item = qobject_cast<RoomInfoListItem *>(contentsLayout_->itemAt(i)->widget());
-
-                if (item && item->isVisible()) {
-                        highlightSelectedRoom(item->roomId());
-                        break;
-                }
-        }
+        if (!visible_.empty())
+                highlightSelectedRoom(visible_.front()->roomId());
 }
 
 void
@@ -427,17 +767,18 @@ RoomList::updateRoom(const QString &room_id, const RoomInfo &info)
 void
 RoomList::addInvitedRoom(const QString &room_id, const RoomInfo &info)
 {
-        auto room_item = new RoomInfoListItem(room_id, info, scrollArea_);
+        auto room_item = new RoomInfoListItem(room_id, info, scrollAreaContents_);
+        room_item->hide();
 
         connect(room_item, &RoomInfoListItem::acceptInvite, this, &RoomList::acceptInvite);
         connect(room_item, &RoomInfoListItem::declineInvite, this, &RoomList::declineInvite);
 
         rooms_.emplace(room_id, QSharedPointer<RoomInfoListItem>(room_item));
+        itemHeight_ = room_item->height();
 
         updateAvatar(room_id, QString::fromStdString(info.avatar_url));
 
-        int pos = contentsLayout_->count() - 1;
-        contentsLayout_->insertWidget(pos, room_item);
+        insertRoom(room_item);
 }
 
 std::pair<QString, QSharedPointer<RoomInfoListItem>>
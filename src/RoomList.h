@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <set>
+#include <vector>
+
+#include <QElapsedTimer>
 #include <QMetaType>
 #include <QPushButton>
 #include <QScrollArea>
@@ -28,11 +32,16 @@
 
 class LeaveRoomDialog;
 class OverlayModal;
+class QTimer;
 class RoomInfoListItem;
 class Sync;
 struct DescInfo;
 struct RoomInfo;
 
+namespace snapshot {
+struct State;
+}
+
 class RoomList : public QWidget
 {
         Q_OBJECT
@@ -40,10 +49,15 @@ class RoomList : public QWidget
 public:
         explicit RoomList(QWidget *parent = 0);
 
+        //! Show the rooms from the live state, updating the ones already in the list.
         void initialize(const QMap<QString, RoomInfo> &info);
+        //! Show the rooms of a snapshot until the live state is loaded.
+        void restore(const snapshot::State &state);
+        //! What the room list shows, in order.
+        snapshot::State snapshot() const;
         void sync(const std::map<QString, RoomInfo> &info);
 
-        void clear() { rooms_.clear(); };
+        void clear();
         void updateAvatar(const QString &room_id, const QString &url);
 
         void addRoom(const QString &room_id, const RoomInfo &info);
@@ -58,6 +72,10 @@ public:
 
 signals:
         void roomChanged(const QString &room_id);
+        //! The pointer rested on a room long enough to prepare it.
+        void roomHovered(const QString &room_id);
+        //! The pointer left a room that was reported as hovered.
+        void roomUnhovered(const QString &room_id);
         void totalUnreadMessageCountUpdated(int count);
         void acceptInvite(const QString &room_id);
         void declineInvite(const QString &room_id);
@@ -76,6 +94,7 @@ public slots:
 protected:
         void paintEvent(QPaintEvent *event) override;
         void leaveEvent(QEvent *event) override;
+        bool eventFilter(QObject *obj, QEvent *event) override;
 
 private slots:
         void sortRoomsByLastMessage();
@@ -87,9 +106,33 @@ private:
         bool roomExists(const QString &room_id) { return rooms_.find(room_id) != rooms_.end(); }
         //! Select the first visible room in the room list.
         void selectFirstVisibleRoom();
+        //! Whether the rooms react to the pointer. They don't while they come from a snapshot.
+        void setInteractive(bool isInteractive);
+
+        //! Place the widgets of the rooms in the viewport and hide the others.
+        void layoutRooms();
+        //! Insert a room at its sorted position.
+        void insertRoom(RoomInfoListItem *room);
+        //! Take a room out of the sorted list, using the activity it was sorted with.
+        void takeRoom(RoomInfoListItem *room);
+        //! Move a room whose last activity changed.
+        void repositionRoom(const QString &room_id);
+        //! Remove a room along with its widget.
+        void eraseRoom(const QString &room_id);
+        //! Whether the room belongs to the selected community.
+        bool isInFilter(const QString &room_id) const
+        {
+                return !isFilterActive_ || filter_.find(room_id) != filter_.end();
+        }
+        //! Whether the first room is listed before the second.
+        bool isBefore(const RoomInfoListItem *a, const RoomInfoListItem *b) const;
+
+        //! Read, decode and scale the next batch of queued avatars off the GUI thread.
+        void loadAvatars();
+        //! Fetch an avatar that isn't in the cache yet.
+        void downloadAvatar(const QString &room_id, const QString &url);
 
         QVBoxLayout *topLayout_;
-        QVBoxLayout *contentsLayout_;
         QScrollArea *scrollArea_;
         QWidget *scrollAreaContents_;
 
@@ -100,5 +143,38 @@ private:
         std::map<QString, QSharedPointer<RoomInfoListItem>> rooms_;
         QString selectedRoom_;
 
+        //! Last activity of each room, as it was when the room was sorted.
+        std::map<QString, uint64_t> activity_;
+        //! All the rooms, from the most recently active.
+        std::vector<RoomInfoListItem *> order_;
+        //! The rooms of the selected community, in the same order.
+        std::vector<RoomInfoListItem *> visible_;
+        //! Widgets currently placed in the viewport.
+        std::vector<RoomInfoListItem *> shown_;
+        //! Rooms whose activity changed while the pointer was on the list.
+        std::set<QString> unsorted_;
+
+        std::map<QString, bool> filter_;
+        bool isFilterActive_ = false;
+
+        //! All the rooms have the same height.
+        int itemHeight_ = 0;
+        //! Coalesces the layout requests of a batch of changes.
+        QTimer *layoutTimer_;
+
+        //! Delays the hover notification while the pointer sweeps across the list.
+        QTimer *hoverTimer_;
+        QString hoveredRoom_;
+
         bool isSortPending_ = false;
+
+        //! Avatar urls waiting to be loaded, by room.
+        std::map<QString, QString> pendingAvatars_;
+        //! Coalesces the avatar requests into batches.
+        QTimer *avatarTimer_;
+        bool isLoadingAvatars_ = false;
+
+        //! Time it takes for the room list to get its cached avatars after an initialization.
+        QElapsedTimer decorationTimer_;
+        bool isDecorating_ = false;
 };
@@ -0,0 +1,193 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTimer>
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+#include "AsyncCache.h"
+#include "Cache.h"
+#include "SearchSession.h"
+#include "Utils.h"
+
+//! How long the input has to settle before a search starts.
+constexpr int DEBOUNCE_MS = 25;
+//! How many candidates are scored between checks for a newer search.
+constexpr std::size_t CANCEL_CHECK_INTERVAL = 64;
+
+struct SearchState
+{
+        std::shared_ptr<const std::vector<SearchCandidate>> candidates;
+        //! Lower bound of the distance between each candidate and the query.
+        std::vector<int> bounds;
+        std::string query;
+};
+
+struct SearchRanking
+{
+        uint64_t generation = 0;
+        std::shared_ptr<const SearchState> state;
+        std::vector<SearchCandidate> results;
+};
+
+namespace {
+SearchRanking
+rank(Cache *cache,
+     const SearchSession::Loader &loader,
+     const std::shared_ptr<const SearchState> &previous,
+     const std::string &query,
+     std::size_t maxItems,
+     const std::atomic<uint64_t> &current,
+     uint64_t generation)
+{
+        if (current != generation)
+                return SearchRanking();
+
+        auto state   = std::make_shared<SearchState>();
+        state->query = query;
+
+        // A distance can't change by more than the distance between the two queries, so
+        // the previous distances still bound the new ones.
+        if (previous) {
+                state->candidates = previous->candidates;
+                state->bounds     = previous->bounds;
+
+                const int delta = utils::levenshtein_distance(previous->query, query);
+                for (auto &bound : state->bounds)
+                        bound = std::max(0, bound - delta);
+        } else {
+                state->candidates =
+                  std::make_shared<const std::vector<SearchCandidate>>(loader(cache));
+                state->bounds.assign(state->candidates->size(), 0);
+        }
+
+        const auto &candidates = *state->candidates;
+        auto &bounds           = state->bounds;
+
+        // Candidates are scored from the most promising one, ties keep the stored order.
+        std::vector<std::size_t> order(candidates.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&bounds](std::size_t a, std::size_t b) {
+                return std::tie(bounds[a], a) < std::tie(bounds[b], b);
+        });
+
+        // Max-heap of the closest candidates so far, as (distance, index).
+        std::vector<std::pair<int, std::size_t>> best;
+
+        for (std::size_t n = 0; n < order.size(); ++n) {
+                if (n % CANCEL_CHECK_INTERVAL == 0 && current != generation)
+                        return SearchRanking();
+
+                const auto i = order[n];
+
+                // None of the remaining candidates can beat the ones that were kept.
+                if (!best.empty() && best.size() == maxItems && bounds[i] > best.front().first)
+                        break;
+
+                bounds[i] = utils::levenshtein_distance(query, candidates[i].key);
+
+                best.emplace_back(bounds[i], i);
+                std::push_heap(best.begin(), best.end());
+
+                if (best.size() > maxItems) {
+                        std::pop_heap(best.begin(), best.end());
+                        best.pop_back();
+                }
+        }
+
+        std::sort_heap(best.begin(), best.end());
+
+        SearchRanking ranking;
+        ranking.generation = generation;
+
+        for (const auto &candidate : best)
+                ranking.results.push_back(candidates[candidate.second]);
+
+        ranking.state = std::move(state);
+
+        return ranking;
+}
+}
+
+SearchSession::SearchSession(std::size_t maxItems, QObject *parent)
+  : QObject(parent)
+  , maxItems_{maxItems}
+  , generation_{std::make_shared<std::atomic<uint64_t>>(0)}
+{
+        debounceTimer_ = new QTimer(this);
+        debounceTimer_->setSingleShot(true);
+        debounceTimer_->setInterval(DEBOUNCE_MS);
+        connect(debounceTimer_, &QTimer::timeout, this, &SearchSession::search);
+}
+
+void
+SearchSession::setSource(Loader loader)
+{
+        reset();
+        loader_ = std::move(loader);
+}
+
+void
+SearchSession::setQuery(const std::string &query)
+{
+        query_ = query;
+        debounceTimer_->start();
+}
+
+void
+SearchSession::cancel()
+{
+        debounceTimer_->stop();
+        ++*generation_;
+}
+
+void
+SearchSession::reset()
+{
+        cancel();
+        state_.reset();
+}
+
+void
+SearchSession::search()
+{
+        if (!loader_ || query_.empty())
+                return;
+
+        const auto generation = ++*generation_;
+
+        cache::read(this,
+                    [loader   = loader_,
+                     state    = state_,
+                     query    = query_,
+                     maxItems = maxItems_,
+                     current  = generation_,
+                     generation](Cache *cache) {
+                            return rank(
+                              cache, loader, state, query, maxItems, *current, generation);
+                    },
+                    [this](const SearchRanking &ranking) {
+                            // Superseded by a newer query or cancelled.
+                            if (ranking.generation != *generation_)
+                                    return;
+
+                            state_ = ranking.state;
+                            emit resultsReady(ranking.results);
+                    });
+}
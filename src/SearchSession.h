@@ -0,0 +1,74 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Cache.h"
+
+class QTimer;
+struct SearchState;
+
+//! A search whose query is refined one keystroke at a time.
+//!
+//! The candidates are read once per session and kept along with a lower bound of their
+//! distance to the previous query, so that a new query only has to score the candidates
+//! that might still make it to the results. The work runs on the cache read pool and a
+//! new query supersedes any ranking that is still in progress.
+class SearchSession : public QObject
+{
+        Q_OBJECT
+
+public:
+        using Loader = std::function<std::vector<SearchCandidate>(Cache *)>;
+
+        explicit SearchSession(std::size_t maxItems, QObject *parent = nullptr);
+
+        //! Search through the candidates returned by the given loader from now on.
+        void setSource(Loader loader);
+        //! Rank the candidates against the query once the input settles.
+        void setQuery(const std::string &query);
+        //! Drop the pending and running searches.
+        void cancel();
+        //! Cancel and forget the candidates, so that the next query reads them again.
+        void reset();
+
+signals:
+        //! The best candidates for the latest query, from the closest match.
+        void resultsReady(const std::vector<SearchCandidate> &results);
+
+private:
+        void search();
+
+        Loader loader_;
+        std::size_t maxItems_;
+
+        std::string query_;
+        //! Candidates and distances of the last completed search.
+        std::shared_ptr<const SearchState> state_;
+        //! Bumped with each search; rankings of older generations are dropped.
+        std::shared_ptr<std::atomic<uint64_t>> generation_;
+
+        QTimer *debounceTimer_;
+};
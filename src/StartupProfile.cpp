@@ -0,0 +1,119 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "Logging.h"
+#include "StartupProfile.h"
+
+namespace {
+struct Stage
+{
+        std::string name;
+        qint64 start;
+        qint64 duration;
+        Qt::HANDLE thread;
+};
+
+QElapsedTimer startupClock;
+bool printReport = false;
+std::atomic_bool isFinished{false};
+
+std::mutex stagesMtx;
+std::vector<Stage> stages;
+}
+
+namespace startup {
+void
+init(bool report)
+{
+        printReport = report;
+        startupClock.start();
+}
+
+qint64
+elapsed()
+{
+        return startupClock.isValid() ? startupClock.elapsed() : 0;
+}
+
+Span::Span(std::string name)
+  : name_{std::move(name)}
+  , start_{elapsed()}
+{}
+
+Span::~Span()
+{
+        const auto duration = elapsed() - start_;
+
+        nhlog::ui()->debug("startup: {} took {} ms", name_, duration);
+
+        std::lock_guard<std::mutex> lock(stagesMtx);
+        stages.push_back(Stage{std::move(name_), start_, duration, QThread::currentThreadId()});
+}
+
+void
+finish()
+{
+        if (isFinished.exchange(true))
+                return;
+
+        const auto total = elapsed();
+        nhlog::ui()->info("interactive after {} ms", total);
+
+        if (!printReport)
+                return;
+
+        std::vector<Stage> sorted;
+        {
+                std::lock_guard<std::mutex> lock(stagesMtx);
+                sorted = stages;
+        }
+
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Stage &a, const Stage &b) {
+                return a.start < b.start;
+        });
+
+        // Threads are numbered in the order they show up.
+        std::vector<Qt::HANDLE> threads;
+
+        std::printf("startup profile (ms)\n");
+        std::printf("%8s %8s %7s  %s\n", "start", "duration", "thread", "stage");
+
+        for (const auto &stage : sorted) {
+                auto thread = std::find(threads.begin(), threads.end(), stage.thread);
+                if (thread == threads.end())
+                        thread = threads.insert(threads.end(), stage.thread);
+
+                std::printf("%8lld %8lld %7d  %s\n",
+                            static_cast<long long>(stage.start),
+                            static_cast<long long>(stage.duration),
+                            static_cast<int>(std::distance(threads.begin(), thread)),
+                            stage.name.c_str());
+        }
+
+        std::printf("%8s %8lld %7s  %s\n", "", static_cast<long long>(total), "", "interactive");
+        std::fflush(stdout);
+}
+}
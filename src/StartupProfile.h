@@ -0,0 +1,53 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <string>
+
+//! Timing of the stages the client goes through until it becomes interactive.
+namespace startup {
+//! Start the clock the stages are measured against.
+//! With `report` a breakdown is printed once the client is interactive.
+void
+init(bool report);
+
+//! Milliseconds since init().
+qint64
+elapsed();
+
+//! Records how long a stage took, from its construction to its destruction.
+class Span
+{
+public:
+        explicit Span(std::string name);
+        ~Span();
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+private:
+        std::string name_;
+        qint64 start_;
+};
+
+//! Mark the client as interactive and report the recorded stages. Only the first call counts.
+void
+finish();
+}
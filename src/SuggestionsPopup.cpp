@@ -2,6 +2,7 @@
 #include <QPainter>
 #include <QStyleOption>
 
+#include "AsyncCache.h"
 #include "Config.h"
 #include "SuggestionsPopup.h"
 #include "Utils.h"
@@ -117,8 +118,7 @@ RoomItem::RoomItem(QWidget *parent, const RoomSearchResult &res)
         topLayout_->addWidget(avatar_);
         topLayout_->addWidget(roomName_, 1);
 
-        if (!res.img.isNull())
-                avatar_->setImage(res.img);
+        resolveAvatar(res.info.avatar_url);
 }
 
 void
@@ -132,11 +132,26 @@ RoomItem::updateItem(const RoomSearchResult &result)
                                            parentWidget()->width() - 10);
 
         roomName_->setText(name);
+        avatar_->setLetter(utils::firstChar(name));
 
-        if (!result.img.isNull())
-                avatar_->setImage(result.img);
-        else
-                avatar_->setLetter(utils::firstChar(name));
+        resolveAvatar(result.info.avatar_url);
+}
+
+void
+RoomItem::resolveAvatar(const std::string &avatar_url)
+{
+        if (avatar_url.empty())
+                return;
+
+        cache::read(this,
+                    [avatar_url](Cache *cache) {
+                            return QImage::fromData(cache->image(avatar_url));
+                    },
+                    [this, room_id = roomId_](const QImage &img) {
+                            // The widget might have been reused for another room in the meantime.
+                            if (room_id == roomId_ && !img.isNull())
+                                    avatar_->setImage(img);
+                    });
 }
 
 void
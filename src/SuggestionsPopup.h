@@ -77,6 +77,9 @@ protected:
         void mousePressEvent(QMouseEvent *event) override;
 
 private:
+        //! Read and decode the room avatar in the background.
+        void resolveAvatar(const std::string &avatar_url);
+
         QLabel *roomName_;
         QString roomId_;
         RoomSearchResult info_;
@@ -27,11 +27,11 @@
 #include <QMimeType>
 #include <QPainter>
 #include <QStyleOption>
-#include <QtConcurrent>
 
 #include "Cache.h"
 #include "ChatPage.h"
 #include "Config.h"
+#include "SearchSession.h"
 #include "TextInputWidget.h"
 #include "Utils.h"
 #include "ui/FlatButton.h"
@@ -44,6 +44,8 @@
 static constexpr size_t INPUT_HISTORY_SIZE = 127;
 static constexpr int MAX_TEXTINPUT_HEIGHT  = 120;
 static constexpr int ButtonHeight          = 22;
+//! Number of members suggested at a time by the completion.
+static constexpr size_t MAX_SUGGESTIONS = 5;
 
 FilteredTextEdit::FilteredTextEdit(QWidget *parent)
   : QTextEdit{parent}
@@ -74,9 +76,23 @@ FilteredTextEdit::FilteredTextEdit(QWidget *parent)
                 this,
                 &FilteredTextEdit::uploadData);
 
+        userSearch_ = new SearchSession(MAX_SUGGESTIONS, this);
+        connect(userSearch_,
+                &SearchSession::resultsReady,
+                this,
+                [this](const std::vector<SearchCandidate> &results) {
+                        QVector<SearchResult> users;
+                        for (const auto &result : results)
+                                users.push_back(SearchResult{QString::fromStdString(result.id),
+                                                             QString::fromStdString(result.name)});
+
+                        emit resultsRetrieved(users);
+                });
+
+        connect(this, &FilteredTextEdit::showSuggestions, this, &FilteredTextEdit::searchUsers);
         connect(this, &FilteredTextEdit::resultsRetrieved, this, &FilteredTextEdit::showResults);
         connect(&popup_, &SuggestionsPopup::itemSelected, this, [this](const QString &text) {
-                popup_.hide();
+                closeSuggestions();
 
                 auto cursor   = textCursor();
                 const int end = cursor.position();
@@ -103,6 +119,31 @@ FilteredTextEdit::FilteredTextEdit(QWidget *parent)
         previewDialog_.hide();
 }
 
+void
+FilteredTextEdit::searchUsers(const QString &query)
+{
+        if (query.isEmpty() || !cache::client())
+                return;
+
+        const auto room_id = ChatPage::instance()->currentRoom();
+
+        if (room_id != searchRoom_) {
+                searchRoom_ = room_id;
+                userSearch_->setSource([room_id = room_id.toStdString()](Cache *cache) {
+                        return cache->userSearchCandidates(room_id);
+                });
+        }
+
+        userSearch_->setQuery(query.toLower().toStdString());
+}
+
+void
+FilteredTextEdit::closeSuggestions()
+{
+        popup_.hide();
+        userSearch_->reset();
+}
+
 void
 FilteredTextEdit::showResults(const QVector<SearchResult> &results)
 {
@@ -491,20 +532,6 @@ TextInputWidget::TextInputWidget(QWidget *parent)
 
                         emit heightChanged(widgetHeight);
                 });
-        connect(input_, &FilteredTextEdit::showSuggestions, this, [this](const QString &q) {
-                if (q.isEmpty() || !cache::client())
-                        return;
-
-                QtConcurrent::run([this, q = q.toLower().toStdString()]() {
-                        try {
-                                emit input_->resultsRetrieved(cache::client()->searchUsers(
-                                  ChatPage::instance()->currentRoom().toStdString(), q));
-                        } catch (const lmdb::error &e) {
-                                std::cout << e.what() << '\n';
-                        }
-                });
-        });
-
         sendMessageBtn_ = new FlatButton(this);
         sendMessageBtn_->setToolTip(tr("Send a message"));
 
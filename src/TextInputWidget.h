@@ -35,10 +35,12 @@ namespace dialogs {
 class PreviewUploadOverlay;
 }
 
+struct SearchCandidate;
 struct SearchResult;
 
 class FlatButton;
 class LoadingIndicator;
+class SearchSession;
 
 class FilteredTextEdit : public QTextEdit
 {
@@ -82,7 +84,7 @@ protected:
         void insertFromMimeData(const QMimeData *source) override;
         void focusOutEvent(QFocusEvent *event) override
         {
-                popup_.hide();
+                closeSuggestions();
                 QTextEdit::focusOutEvent(event);
         }
 
@@ -93,6 +95,11 @@ private:
 
         SuggestionsPopup popup_;
 
+        //! Members of the current room matching the completion query.
+        SearchSession *userSearch_;
+        //! The room whose members the search was set up for.
+        QString searchRoom_;
+
         enum class AnchorType
         {
                 Tab   = 0,
@@ -103,7 +110,9 @@ private:
 
         int anchorWidth(AnchorType anchor) { return static_cast<int>(anchor); }
 
-        void closeSuggestions() { popup_.hide(); }
+        //! Hide the popup and end the search session, the members are read again next time.
+        void closeSuggestions();
+        void searchUsers(const QString &query);
         void resetAnchor() { atTriggerPosition_ = -1; }
         bool isAnchorValid() { return atTriggerPosition_ != -1; }
         bool hasAnchor(int pos, AnchorType anchor)
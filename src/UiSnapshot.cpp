@@ -0,0 +1,202 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "Logging.h"
+#include "UiSnapshot.h"
+
+namespace {
+constexpr quint32 MAGIC   = 0x6e68736e;
+constexpr quint32 VERSION = 1;
+
+//! Magic, version and the offset of the avatar pixels.
+constexpr quint64 HEADER_SIZE = 16;
+//! Alignment of the pixels of every avatar, so they can be used in place.
+constexpr quint64 PIXEL_ALIGNMENT = 16;
+
+quint64
+align(quint64 offset)
+{
+        return (offset + PIXEL_ALIGNMENT - 1) / PIXEL_ALIGNMENT * PIXEL_ALIGNMENT;
+}
+
+//! The snapshot lives next to the cache it mirrors, so it goes away along with it.
+QString
+directory(const QString &user_id)
+{
+        return QString("%1/%2")
+          .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+          .arg(QString::fromUtf8(user_id.toUtf8().toHex()));
+}
+
+QString
+path(const QString &user_id)
+{
+        return directory(user_id) + "/ui-snapshot";
+}
+}
+
+namespace snapshot {
+void
+save(const QString &user_id, const State &state)
+{
+        if (!QDir(directory(user_id)).exists())
+                return;
+
+        QByteArray records;
+        QByteArray pixels;
+
+        {
+                QDataStream out(&records, QIODevice::WriteOnly);
+                out.setVersion(QDataStream::Qt_5_7);
+
+                out << state.current_room << static_cast<quint32>(state.rooms.size());
+
+                for (const auto &room : state.rooms) {
+                        const auto avatar =
+                          room.avatar.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+                        out << room.room_id << room.name << room.is_invite;
+                        out << room.msgInfo.event_id << room.msgInfo.username
+                            << room.msgInfo.userid << room.msgInfo.body << room.msgInfo.timestamp
+                            << room.msgInfo.datetime;
+                        out << static_cast<qint32>(room.unreadCount) << room.hasUnreadMessages;
+                        out << static_cast<qint32>(avatar.width())
+                            << static_cast<qint32>(avatar.height())
+                            << static_cast<qint32>(avatar.bytesPerLine())
+                            << static_cast<quint64>(pixels.size());
+
+                        pixels.append(reinterpret_cast<const char *>(avatar.constBits()),
+                                      avatar.byteCount());
+                        pixels.append(QByteArray(align(pixels.size()) - pixels.size(), '\0'));
+                }
+        }
+
+        const quint64 pixelsOffset = align(HEADER_SIZE + records.size());
+
+        QSaveFile file(path(user_id));
+        if (!file.open(QIODevice::WriteOnly)) {
+                nhlog::ui()->warn("failed to write the ui snapshot: {}",
+                                  file.errorString().toStdString());
+                return;
+        }
+
+        {
+                QDataStream out(&file);
+                out << MAGIC << VERSION << pixelsOffset;
+        }
+
+        file.write(records);
+        file.write(QByteArray(pixelsOffset - HEADER_SIZE - records.size(), '\0'));
+        file.write(pixels);
+
+        if (!file.commit()) {
+                nhlog::ui()->warn("failed to write the ui snapshot: {}",
+                                  file.errorString().toStdString());
+                return;
+        }
+
+        nhlog::ui()->debug("saved ui snapshot of {} rooms ({} bytes)",
+                           state.rooms.size(),
+                           pixelsOffset + pixels.size());
+}
+
+boost::optional<State>
+load(const QString &user_id)
+{
+        auto file = std::make_shared<QFile>(path(user_id));
+        if (!file->open(QIODevice::ReadOnly))
+                return boost::none;
+
+        const auto size = static_cast<quint64>(file->size());
+        if (size < HEADER_SIZE)
+                return boost::none;
+
+        const uchar *data = file->map(0, size);
+        if (!data) {
+                nhlog::ui()->warn("failed to map the ui snapshot: {}",
+                                  file->errorString().toStdString());
+                return boost::none;
+        }
+
+        QDataStream in(QByteArray::fromRawData(reinterpret_cast<const char *>(data), size));
+        in.setVersion(QDataStream::Qt_5_7);
+
+        quint32 magic, version;
+        quint64 pixelsOffset;
+        in >> magic >> version >> pixelsOffset;
+
+        if (magic != MAGIC || version != VERSION || pixelsOffset > size) {
+                nhlog::ui()->info("discarding ui snapshot with an unknown format");
+                return boost::none;
+        }
+
+        State state;
+        quint32 count = 0;
+        in >> state.current_room >> count;
+
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                Room room;
+                qint32 unreadCount, width, height, bytesPerLine;
+                quint64 offset;
+
+                in >> room.room_id >> room.name >> room.is_invite;
+                in >> room.msgInfo.event_id >> room.msgInfo.username >> room.msgInfo.userid >>
+                  room.msgInfo.body >> room.msgInfo.timestamp >> room.msgInfo.datetime;
+                in >> unreadCount >> room.hasUnreadMessages;
+                in >> width >> height >> bytesPerLine >> offset;
+
+                if (in.status() != QDataStream::Ok)
+                        break;
+
+                room.unreadCount = unreadCount;
+
+                if (width > 0 && height > 0) {
+                        const auto bytes = static_cast<quint64>(bytesPerLine) * height;
+
+                        if (bytesPerLine < width * 4 || offset > size - pixelsOffset ||
+                            bytes > size - pixelsOffset - offset) {
+                                in.setStatus(QDataStream::ReadCorruptData);
+                                break;
+                        }
+
+                        // Stored in the format of the pixmaps, nothing has to be decoded.
+                        room.avatar = QImage(data + pixelsOffset + offset,
+                                             width,
+                                             height,
+                                             bytesPerLine,
+                                             QImage::Format_ARGB32_Premultiplied);
+                }
+
+                state.rooms.push_back(std::move(room));
+        }
+
+        if (in.status() != QDataStream::Ok) {
+                nhlog::ui()->warn("discarding corrupted ui snapshot");
+                return boost::none;
+        }
+
+        state.file = std::move(file);
+
+        return state;
+}
+}
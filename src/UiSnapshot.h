@@ -0,0 +1,67 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "Cache.h"
+
+//! A compact copy of what the chat page showed, so the next launch can paint it
+//! before the cache is open.
+namespace snapshot {
+//! A room as the room list last showed it.
+struct Room
+{
+        QString room_id;
+        QString name;
+        bool is_invite = false;
+        //! Metadata describing the last message in the timeline.
+        DescInfo msgInfo;
+        int unreadCount        = 0;
+        bool hasUnreadMessages = false;
+        //! Already scaled to the size the room list draws it with.
+        //! When loaded it refers to the mapped file instead of owning its pixels.
+        QImage avatar;
+};
+
+struct State
+{
+        //! The room that was open.
+        QString current_room;
+        //! The rooms in the order of the room list.
+        std::vector<Room> rooms;
+
+        //! Keeps the mapped file alive for the avatars that refer to it.
+        std::shared_ptr<QFile> file;
+};
+
+//! Replace the snapshot of the user. Nothing is written once the cache of the user is gone.
+void
+save(const QString &user_id, const State &state);
+
+//! Map the snapshot of the user, if there is a valid one.
+boost::optional<State>
+load(const QString &user_id);
+}
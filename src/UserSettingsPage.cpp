@@ -24,9 +24,15 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QFutureWatcher>
 #include <QSettings>
+#include <QtConcurrent>
+
+#include <chrono>
+#include <memory>
 
 #include "Config.h"
+#include "Logging.h"
 #include "MatrixClient.h"
 #include "Olm.h"
 #include "UserSettingsPage.h"
@@ -280,6 +286,24 @@ UserSettingsPage::UserSettingsPage(QSharedPointer<UserSettings> settings, QWidge
         sessionKeysLayout->addWidget(sessionKeysExportBtn, 0, Qt::AlignRight);
         sessionKeysLayout->addWidget(sessionKeysImportBtn, 0, Qt::AlignRight);
 
+        connect(
+          this, &UserSettingsPage::sessionKeysProgress, this, [this](int processed, int total) {
+                  if (!sessionKeysProgress_)
+                          return;
+
+                  sessionKeysProgress_->setMaximum(total);
+                  sessionKeysProgress_->setValue(processed);
+          });
+        connect(this, &UserSettingsPage::sessionKeysFinished, this, [this](const QString &error) {
+                if (sessionKeysProgress_) {
+                        sessionKeysProgress_->deleteLater();
+                        sessionKeysProgress_ = nullptr;
+                }
+
+                if (!error.isEmpty())
+                        QMessageBox::warning(this, tr("Error"), error);
+        });
+
         encryptionLayout_->addLayout(deviceIdLayout);
         encryptionLayout_->addLayout(deviceFingerprintLayout);
         encryptionLayout_->addWidget(new HorizontalLine{this});
@@ -432,9 +456,29 @@ UserSettingsPage::paintEvent(QPaintEvent *)
         style()->drawPrimitive(QStyle::PE_Widget, &opt, &p, this);
 }
 
+static void
+logSessionKeysThroughput(const std::string &action,
+                         std::size_t count,
+                         std::chrono::steady_clock::time_point start)
+{
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+        nhlog::crypto()->info("{} {} session keys in {} ms ({} sessions/s)",
+                              action,
+                              count,
+                              elapsed,
+                              elapsed > 0 ? count * 1000 / static_cast<std::size_t>(elapsed)
+                                          : count);
+}
+
 void
 UserSettingsPage::importSessionKeys()
 {
+        if (sessionKeysProgress_)
+                return;
+
         auto fileName = QFileDialog::getOpenFileName(this, tr("Open Sessions File"), "", "");
 
         QFile file(fileName);
@@ -461,22 +505,46 @@ UserSettingsPage::importSessionKeys()
                 return;
         }
 
-        try {
-                auto sessions = mtx::crypto::decrypt_exported_sessions(
-                  mtx::crypto::base642bin(payload), password.toStdString());
-                cache::client()->importSessionKeys(std::move(sessions));
-        } catch (const mtx::crypto::sodium_exception &e) {
-                QMessageBox::warning(this, tr("Error"), e.what());
-        } catch (const lmdb::error &e) {
-                QMessageBox::warning(this, tr("Error"), e.what());
-        } catch (const nlohmann::json::exception &e) {
-                QMessageBox::warning(this, tr("Error"), e.what());
-        }
+        showSessionKeysProgress(tr("Importing session keys..."));
+
+        auto proxy = std::make_shared<SessionKeysProxy>();
+        connect(proxy.get(),
+                &SessionKeysProxy::progress,
+                this,
+                &UserSettingsPage::sessionKeysProgress);
+
+        watchSessionKeys(QtConcurrent::run([proxy, payload = std::move(payload), password]() {
+                try {
+                        const auto start = std::chrono::steady_clock::now();
+
+                        auto sessions = mtx::crypto::decrypt_exported_sessions(
+                          mtx::crypto::base642bin(payload), password.toStdString());
+
+                        cache::client()->importSessionKeys(
+                          sessions, [proxy](std::size_t processed, std::size_t total) {
+                                  emit proxy->progress(static_cast<int>(processed),
+                                                       static_cast<int>(total));
+                          });
+
+                        logSessionKeysThroughput("imported", sessions.sessions.size(), start);
+                } catch (const mtx::crypto::sodium_exception &e) {
+                        return QString(e.what());
+                } catch (const lmdb::error &e) {
+                        return QString(e.what());
+                } catch (const nlohmann::json::exception &e) {
+                        return QString(e.what());
+                }
+
+                return QString();
+        }));
 }
 
 void
 UserSettingsPage::exportSessionKeys()
 {
+        if (sessionKeysProgress_)
+                return;
+
         // Open password dialog.
         bool ok;
         auto password = QInputDialog::getText(this,
@@ -497,25 +565,76 @@ UserSettingsPage::exportSessionKeys()
         auto fileName =
           QFileDialog::getSaveFileName(this, tr("File to save the exported session keys"), "", "");
 
-        QFile file(fileName);
-        if (!file.open(QIODevice::WriteOnly)) {
-                QMessageBox::warning(this, tr("Error"), file.errorString());
+        auto file = QSharedPointer<QFile>::create(fileName);
+        if (!file->open(QIODevice::WriteOnly)) {
+                QMessageBox::warning(this, tr("Error"), file->errorString());
                 return;
         }
 
+        showSessionKeysProgress(tr("Exporting session keys..."));
+
+        auto proxy = std::make_shared<SessionKeysProxy>();
+        connect(proxy.get(),
+                &SessionKeysProxy::progress,
+                this,
+                &UserSettingsPage::sessionKeysProgress);
+
         // Export sessions & save to file.
-        try {
-                auto encrypted_blob = mtx::crypto::encrypt_exported_sessions(
-                  cache::client()->exportSessionKeys(), password.toStdString());
-
-                auto b64 = mtx::crypto::bin2base64(encrypted_blob);
-
-                file.write(b64.data(), b64.size());
-        } catch (const mtx::crypto::sodium_exception &e) {
-                QMessageBox::warning(this, tr("Error"), e.what());
-        } catch (const lmdb::error &e) {
-                QMessageBox::warning(this, tr("Error"), e.what());
-        } catch (const nlohmann::json::exception &e) {
-                QMessageBox::warning(this, tr("Error"), e.what());
-        }
+        watchSessionKeys(QtConcurrent::run([proxy, file, password]() {
+                try {
+                        const auto start = std::chrono::steady_clock::now();
+
+                        const auto sessions = cache::client()->exportSessionKeys(
+                          [proxy](std::size_t processed, std::size_t total) {
+                                  emit proxy->progress(static_cast<int>(processed),
+                                                       static_cast<int>(total));
+                          });
+
+                        auto encrypted_blob =
+                          mtx::crypto::encrypt_exported_sessions(sessions, password.toStdString());
+
+                        // Write the encoded blob in parts instead of holding another copy of it.
+                        constexpr std::size_t CHUNK_SIZE = 3 * 64 * 1024;
+                        for (std::size_t pos = 0; pos < encrypted_blob.size(); pos += CHUNK_SIZE) {
+                                const auto len =
+                                  std::min(CHUNK_SIZE, encrypted_blob.size() - pos);
+                                const auto b64 = mtx::crypto::bin2base64(
+                                  std::string(encrypted_blob.data() + pos, len));
+
+                                if (file->write(b64.data(), b64.size()) == -1)
+                                        return file->errorString();
+                        }
+
+                        logSessionKeysThroughput("exported", sessions.sessions.size(), start);
+                } catch (const mtx::crypto::sodium_exception &e) {
+                        return QString(e.what());
+                } catch (const lmdb::error &e) {
+                        return QString(e.what());
+                } catch (const nlohmann::json::exception &e) {
+                        return QString(e.what());
+                }
+
+                return QString();
+        }));
+}
+
+void
+UserSettingsPage::showSessionKeysProgress(const QString &label)
+{
+        sessionKeysProgress_ = new QProgressDialog(label, QString(), 0, 0, this);
+        sessionKeysProgress_->setWindowModality(Qt::WindowModal);
+        sessionKeysProgress_->setMinimumDuration(0);
+        sessionKeysProgress_->setValue(0);
+}
+
+void
+UserSettingsPage::watchSessionKeys(const QFuture<QString> &future)
+{
+        // The watcher dies with the page, so a job outliving it reports to no one.
+        auto watcher = new QFutureWatcher<QString>(this);
+        connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher]() {
+                emit sessionKeysFinished(watcher->result());
+                watcher->deleteLater();
+        });
+        watcher->setFuture(future);
 }
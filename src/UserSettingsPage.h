@@ -19,13 +19,25 @@
 
 #include <QComboBox>
 #include <QFrame>
+#include <QFuture>
 #include <QLabel>
 #include <QLayout>
+#include <QProgressDialog>
 #include <QSharedPointer>
 #include <QWidget>
 
 class Toggle;
 
+//! Carries the progress of a session keys import/export out of the worker thread, so the
+//! worker never touches the settings page, which may be gone by the time it reports.
+class SessionKeysProxy : public QObject
+{
+        Q_OBJECT
+
+signals:
+        void progress(int processed, int total);
+};
+
 constexpr int OptionMargin       = 6;
 constexpr int LayoutTopMargin    = 50;
 constexpr int LayoutBottomMargin = LayoutTopMargin;
@@ -129,11 +141,21 @@ signals:
         void moveBack();
         void trayOptionChanged(bool value);
 
+        //! Progress of the session keys import/export running in the background.
+        void sessionKeysProgress(int processed, int total);
+        //! The session keys import/export finished. The error is empty on success.
+        void sessionKeysFinished(const QString &error);
+
 private slots:
         void importSessionKeys();
         void exportSessionKeys();
 
 private:
+        //! Open the progress dialog of the session keys import/export.
+        void showSessionKeysProgress(const QString &label);
+        //! Report the result of a session keys job once it finishes, unless the page is gone.
+        void watchSessionKeys(const QFuture<QString> &future);
+
         // Layouts
         QVBoxLayout *topLayout_;
         QVBoxLayout *mainLayout_;
@@ -155,5 +177,8 @@ private:
         QComboBox *scaleFactorCombo_;
         QComboBox *fontSizeCombo_;
 
+        //! Shows the progress of the session keys import/export.
+        QProgressDialog *sessionKeysProgress_ = nullptr;
+
         int sideMargin_ = 0;
 };
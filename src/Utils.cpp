@@ -3,15 +3,20 @@
 #include <QApplication>
 #include <QComboBox>
 #include <QDesktopWidget>
+#include <QCache>
+#include <QElapsedTimer>
+#include <QSet>
 #include <QSettings>
 #include <QTextDocument>
-#include <QXmlStreamReader>
+#include <algorithm>
 #include <cmath>
+#include <functional>
 
 #include <boost/variant.hpp>
 #include <cmark.h>
 
 #include "Config.h"
+#include "Logging.h"
 
 using TimelineEvent = mtx::events::collections::TimelineEvents;
 
@@ -284,70 +289,432 @@ utils::humanReadableFingerprint(const QString &ed25519)
         return fingerprintList.join(" ");
 }
 
+namespace {
+//! Tags allowed in the formatted body of a message. The others are dropped, keeping their
+//! content.
+const QSet<QString> allowedTags = {
+  "font", "del", "h1", "h2", "h3", "h4", "h5", "h6", "blockquote", "p", "a", "ul",
+  "ol", "sup", "sub", "li", "b", "i", "u", "strong", "em", "strike", "code", "hr",
+  "br", "div", "table", "thead", "tbody", "tr", "th", "td", "caption", "pre", "span", "img"};
+
+//! Tags that are dropped along with their content.
+const QSet<QString> strippedTags = {"script", "style"};
+
+//! Tags without content or closing tag.
+const QSet<QString> voidTags = {"br", "hr", "img"};
+
+//! Attributes allowed on each tag.
+const QHash<QString, QSet<QString>> allowedAttributes = {
+  {"font", {"color", "data-mx-bg-color", "data-mx-color"}},
+  {"span", {"data-mx-bg-color", "data-mx-color"}},
+  {"a", {"name", "target", "href"}},
+  {"img", {"width", "height", "alt", "title", "src"}},
+  {"ol", {"start"}},
+  {"code", {"class"}}};
+
+//! Schemes allowed in the links of a message.
+const QStringList linkSchemes = {"https://", "http://", "ftp://", "mailto:", "magnet:"};
+
+//! Formatted bodies by event id.
+struct FormattedBody
+{
+        std::size_t source;
+        QString html;
+};
+
+//! Up to this many characters of formatted bodies are kept.
+constexpr int FORMATTED_BODIES_COST = 4 * 1024 * 1024;
+QCache<QString, FormattedBody> formattedBodies(FORMATTED_BODIES_COST);
+
+//! Formatting work since the last report.
+struct FormatStats
+{
+        qint64 nsecs  = 0;
+        qint64 chars  = 0;
+        int formatted = 0;
+        int reused    = 0;
+} formatStats;
+
+//! How often the throughput of the formatter is logged, in formatted messages.
+constexpr int FORMAT_STATS_INTERVAL = 500;
+
+bool
+isSchemeChar(QChar c)
+{
+        return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '+' || c == '.' ||
+               c == '-';
+}
+
+//! Whether the URL at the given position stops there.
+bool
+isUrlEnd(const QString &text, int pos, bool escaped)
+{
+        const QChar c = text.at(pos);
+
+        if (c.isSpace() || c == '<' || c == '>' || c == '\'' || c == '"')
+                return true;
+
+        if (!escaped || c != '&')
+                return false;
+
+        const auto entity = text.midRef(pos, 6);
+        return entity.startsWith("&lt;") || entity.startsWith("&gt;") ||
+               entity.startsWith("&quot;") || entity.startsWith("&#39;") ||
+               entity.startsWith("&#34;");
+}
+
+//! Characters that can't end a URL.
+bool
+isUrlTrailing(QChar c)
+{
+        return c == '!' || c == ',' || c == '.' || c == ']' || c == ')' || c == ':';
+}
+
+void
+appendEscaped(QString &out, const QString &text, int begin, int end)
+{
+        for (int i = begin; i < end; ++i) {
+                const QChar c = text.at(i);
+
+                if (c == '<')
+                        out += QLatin1String("&lt;");
+                else if (c == '>')
+                        out += QLatin1String("&gt;");
+                else if (c == '&')
+                        out += QLatin1String("&amp;");
+                else if (c == '"')
+                        out += QLatin1String("&quot;");
+                else
+                        out += c;
+        }
+}
+
+void
+appendText(QString &out, const QString &text, int begin, int end, bool escaped)
+{
+        if (escaped)
+                out += text.midRef(begin, end - begin);
+        else
+                appendEscaped(out, text, begin, end);
+}
+
+//! Append the text between begin and end, turning the raw URLs into links. It matches the
+//! same URLs as conf::strings::url_regex, scanning the text once. Text that isn't already
+//! escaped HTML is escaped on the way.
+void
+appendLinkified(QString &out, const QString &text, int begin, int end, bool escaped)
+{
+        int written = begin;
+        int i       = begin;
+
+        // End of the run of scheme characters around i and whether "://" follows it.
+        int run        = begin;
+        bool runScheme = false;
+
+        while (i < end) {
+                const QChar c = text.at(i);
+
+                if (c < 'a' || c > 'z') {
+                        ++i;
+                        continue;
+                }
+
+                int bodyStart = -1;
+                bool isWww    = false;
+
+                if (i + 4 <= end && text.midRef(i, 4) == QLatin1String("www.") &&
+                    (i + 4 == end || text.at(i + 4) != '.')) {
+                        bodyStart = i + 4;
+                        isWww     = true;
+                } else {
+                        if (i >= run) {
+                                run = i;
+                                while (run < end && isSchemeChar(text.at(run)))
+                                        ++run;
+
+                                runScheme = run + 3 <= end &&
+                                            text.midRef(run, 3) == QLatin1String("://");
+                        }
+
+                        if (runScheme)
+                                bodyStart = run + 3;
+                }
+
+                if (bodyStart == -1) {
+                        ++i;
+                        continue;
+                }
+
+                int stop = bodyStart;
+                while (stop < end && !isUrlEnd(text, stop, escaped))
+                        ++stop;
+                while (stop > bodyStart && isUrlTrailing(text.at(stop - 1)))
+                        --stop;
+
+                // At least two characters have to follow the scheme.
+                if (stop - bodyStart < 2) {
+                        ++i;
+                        continue;
+                }
+
+                appendText(out, text, written, i, escaped);
+
+                QString url;
+                appendText(url, text, i, stop, escaped);
+
+                out += QLatin1String("<a href=\"");
+                if (isWww)
+                        out += QLatin1String("http://");
+                out += url;
+                out += QLatin1String("\">");
+                out += url;
+                out += QLatin1String("</a>");
+
+                written = i = run = stop;
+        }
+
+        appendText(out, text, written, end, escaped);
+}
+
+bool
+isAllowedAttribute(const QString &tag, const QString &name, const QString &value)
+{
+        if (!allowedAttributes.value(tag).contains(name))
+                return false;
+
+        if (tag == "a" && name == "href") {
+                const auto link = value.trimmed().toLower();
+                return std::any_of(
+                  linkSchemes.cbegin(), linkSchemes.cend(), [&link](const QString &scheme) {
+                          return link.startsWith(scheme);
+                  });
+        }
+
+        if (tag == "img" && name == "src")
+                return value.startsWith("mxc://");
+
+        return true;
+}
+}
+
 QString
 utils::linkifyMessage(const QString &body)
 {
-        // Convert to valid XML.
-        auto doc = QString("<html>%1</html>").arg(body);
+        QString out;
+        out.reserve(body.size() + body.size() / 4);
 
-        doc.replace("<mx-reply>", "");
-        doc.replace("</mx-reply>", "");
-        doc.replace("<br>", "<br></br>");
+        const int size = body.size();
 
-        QXmlStreamReader xml{doc};
+        // Links aren't nested and the content of stripped tags is skipped.
+        int anchors = 0;
+        QString skippedTag;
 
-        QString textString;
-        while (!xml.atEnd() && !xml.hasError()) {
-                auto t = xml.readNext();
+        int pos = 0;
+        while (pos < size) {
+                const int lt      = body.indexOf('<', pos);
+                const int textEnd = (lt == -1) ? size : lt;
 
-                switch (t) {
-                case QXmlStreamReader::Characters: {
-                        auto text = xml.text().toString();
-                        text.replace(conf::strings::url_regex, conf::strings::url_html);
+                if (skippedTag.isEmpty()) {
+                        if (anchors > 0)
+                                out += body.midRef(pos, textEnd - pos);
+                        else
+                                appendLinkified(out, body, pos, textEnd, true);
+                }
 
-                        textString += text;
+                if (lt == -1)
                         break;
+
+                if (body.midRef(lt, 4) == QLatin1String("<!--")) {
+                        const int commentEnd = body.indexOf("-->", lt + 4);
+                        pos                  = (commentEnd == -1) ? size : commentEnd + 3;
+                        continue;
                 }
-                case QXmlStreamReader::StartDocument:
-                case QXmlStreamReader::EndDocument:
-                        break;
-                case QXmlStreamReader::StartElement: {
-                        if (xml.name() == "html")
-                                break;
 
-                        textString += QString("<%1").arg(xml.name().toString());
+                // Parse the tag name.
+                int i              = lt + 1;
+                const bool closing = i < size && body.at(i) == '/';
+                if (closing)
+                        ++i;
+
+                const int nameStart = i;
+                while (i < size && (body.at(i).isLetterOrNumber() || body.at(i) == '-'))
+                        ++i;
+
+                // A lone '<' is text.
+                if (i == nameStart || !body.at(nameStart).isLetter()) {
+                        if (skippedTag.isEmpty())
+                                out += QLatin1String("&lt;");
+                        pos = lt + 1;
+                        continue;
+                }
 
-                        const auto attrs = xml.attributes();
-                        for (const auto &e : attrs)
-                                textString += QString(" %1=\"%2\"")
-                                                .arg(e.name().toString())
-                                                .arg(e.value().toString());
+                const auto name = body.mid(nameStart, i - nameStart).toLower();
 
-                        textString += ">";
+                // Parse the attributes, up to the end of the tag.
+                QString attributes;
+                bool selfClosing = false;
+                bool terminated  = false;
 
-                        break;
-                }
-                case QXmlStreamReader::EndElement: {
-                        if (xml.name() == "html")
+                while (i < size) {
+                        const QChar c = body.at(i);
+
+                        if (c == '>') {
+                                terminated = true;
+                                ++i;
                                 break;
+                        }
+
+                        if (c.isSpace()) {
+                                ++i;
+                                continue;
+                        }
+
+                        if (c == '/') {
+                                selfClosing = true;
+                                ++i;
+                                continue;
+                        }
+
+                        const int attrStart = i;
+                        while (i < size && !body.at(i).isSpace() && body.at(i) != '=' &&
+                               body.at(i) != '>' && body.at(i) != '/')
+                                ++i;
+                        const auto attrName = body.mid(attrStart, i - attrStart).toLower();
+
+                        QString value;
+                        if (i < size && body.at(i) == '=') {
+                                ++i;
+
+                                if (i < size && (body.at(i) == '"' || body.at(i) == '\'')) {
+                                        const QChar quote   = body.at(i);
+                                        const int valueEnd  = body.indexOf(quote, i + 1);
+                                        const int valueSize = (valueEnd == -1) ? size : valueEnd;
+
+                                        value = body.mid(i + 1, valueSize - i - 1);
+                                        i     = (valueEnd == -1) ? size : valueEnd + 1;
+                                } else {
+                                        const int valueStart = i;
+                                        while (i < size && !body.at(i).isSpace() &&
+                                               body.at(i) != '>')
+                                                ++i;
+                                        value = body.mid(valueStart, i - valueStart);
+                                }
+                        }
+
+                        selfClosing = false;
+
+                        if (closing || !isAllowedAttribute(name, attrName, value))
+                                continue;
+
+                        value.replace('"', QLatin1String("&quot;"));
+                        value.replace('<', QLatin1String("&lt;"));
+
+                        attributes += QString(" %1=\"%2\"").arg(attrName, value);
+                }
 
-                        textString += QString("</%1>").arg(xml.name().toString());
-                        break;
+                // An unterminated tag is text.
+                if (!terminated) {
+                        if (skippedTag.isEmpty())
+                                appendEscaped(out, body, lt, lt + 1);
+                        pos = lt + 1;
+                        continue;
                 }
-                default: {
-                        break;
+
+                pos = i;
+
+                if (!skippedTag.isEmpty()) {
+                        if (closing && name == skippedTag)
+                                skippedTag.clear();
+                        continue;
+                }
+
+                if (strippedTags.contains(name)) {
+                        if (!closing && !selfClosing)
+                                skippedTag = name;
+                        continue;
                 }
+
+                if (!allowedTags.contains(name))
+                        continue;
+
+                if (closing) {
+                        if (voidTags.contains(name))
+                                continue;
+
+                        if (name == "a")
+                                anchors = std::max(anchors - 1, 0);
+
+                        out += QLatin1String("</");
+                        out += name;
+                        out += '>';
+                        continue;
+                }
+
+                if (name == "a" && !selfClosing)
+                        anchors += 1;
+
+                out += '<';
+                out += name;
+                out += attributes;
+                out += '>';
+        }
+
+        return out;
+}
+
+QString
+utils::linkifyText(const QString &text)
+{
+        QString out;
+        out.reserve(text.size() + text.size() / 4);
+
+        appendLinkified(out, text, 0, text.size(), false);
+
+        return out;
+}
+
+QString
+utils::formatMessageBody(const std::string &event_id, const std::string &source, bool isHtml)
+{
+        const auto key  = QString::fromStdString(event_id);
+        const auto hash = std::hash<std::string>{}(source) ^ (isHtml ? 1 : 0);
+
+        // The same event can change its content, e.g once it's decrypted.
+        if (!key.isEmpty()) {
+                auto cached = formattedBodies.object(key);
+                if (cached && cached->source == hash) {
+                        formatStats.reused += 1;
+                        return cached->html;
                 }
         }
 
-        if (xml.hasError()) {
-                qWarning() << "error while parsing xml" << xml.errorString() << doc;
-                doc.replace("<html>", "");
-                doc.replace("</html>", "");
-                return doc;
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto body = QString::fromStdString(source).trimmed();
+        auto html       = isHtml ? linkifyMessage(body) : linkifyText(body);
+
+        formatStats.nsecs += timer.nsecsElapsed();
+        formatStats.chars += body.size();
+        formatStats.formatted += 1;
+
+        if (formatStats.formatted == FORMAT_STATS_INTERVAL) {
+                const double secs = std::max(formatStats.nsecs, qint64(1)) / 1e9;
+
+                nhlog::ui()->debug("formatted {} messages ({} characters) at {:.1f} MB/s, {} "
+                                   "served from the memo",
+                                   formatStats.formatted,
+                                   formatStats.chars,
+                                   formatStats.chars * sizeof(QChar) / secs / 1e6,
+                                   formatStats.reused);
+
+                formatStats = FormatStats();
         }
 
-        return textString;
+        if (!key.isEmpty())
+                formattedBodies.insert(key, new FormattedBody{hash, html}, html.size());
+
+        return html;
 }
 
 QString
@@ -357,14 +724,12 @@ utils::markdownToHtml(const QString &text)
         const char *tmp_buf =
           cmark_markdown_to_html(str.constData(), str.size(), CMARK_OPT_DEFAULT);
 
-        // Copy the null terminated output buffer.
-        std::string html(tmp_buf);
+        // Convert the null terminated output buffer.
+        auto result = QString::fromUtf8(tmp_buf).trimmed();
 
         // The buffer is no longer needed.
         free((char *)tmp_buf);
 
-        auto result = QString::fromStdString(html).trimmed();
-
         return result;
 }
 
@@ -215,10 +215,29 @@ getMessageBody(const RoomMessageT &event)
         return QString::fromStdString(event.content.formatted_body);
 }
 
-//! Replace raw URLs in text with HTML link tags.
+//! Sanitize an HTML message and replace the raw URLs in its text with HTML link tags.
 QString
 linkifyMessage(const QString &body);
 
+//! Escape plain text and replace the raw URLs in it with HTML link tags.
+QString
+linkifyText(const QString &text);
+
+//! Sanitize and linkify the body of a message in a single pass.
+//! The result is reused while the event keeps the same content.
+QString
+formatMessageBody(const std::string &event_id, const std::string &source, bool isHtml);
+
+template<typename RoomMessageT>
+QString
+formatMessageBody(const RoomMessageT &event)
+{
+        const bool isHtml = event.content.format == common::FORMAT_MSG_TYPE;
+
+        return formatMessageBody(
+          event.event_id, isHtml ? event.content.formatted_body : event.content.body, isHtml);
+}
+
 //! Convert the input markdown text to html.
 QString
 markdownToHtml(const QString &text);
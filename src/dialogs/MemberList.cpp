@@ -9,6 +9,7 @@
 
 #include "dialogs/MemberList.h"
 
+#include "AsyncCache.h"
 #include "AvatarProvider.h"
 #include "Cache.h"
 #include "ChatPage.h"
@@ -18,6 +19,9 @@
 
 using namespace dialogs;
 
+//! Number of members read from the cache at a time.
+constexpr std::size_t MEMBERS_PAGE_SIZE = 30;
+
 MemberItem::MemberItem(const RoomMember &member, QWidget *parent)
   : QWidget(parent)
 {
@@ -32,13 +36,24 @@ MemberItem::MemberItem(const RoomMember &member, QWidget *parent)
         avatar_->setSize(44);
         avatar_->setLetter(utils::firstChar(member.display_name));
 
-        if (!member.avatar.isNull())
-                avatar_->setImage(member.avatar);
-        else
-                AvatarProvider::resolve(ChatPage::instance()->currentRoom(),
-                                        member.user_id,
-                                        this,
-                                        [this](const QImage &img) { avatar_->setImage(img); });
+        // The row shows up with the letter avatar and the image follows once it's decoded.
+        if (!member.avatar_url.isEmpty())
+                cache::read(this,
+                            [url = member.avatar_url.toStdString()](Cache *cache) {
+                                    return QImage::fromData(cache->image(url));
+                            },
+                            [this, user_id = member.user_id](const QImage &img) {
+                                    if (!img.isNull()) {
+                                            avatar_->setImage(img);
+                                            return;
+                                    }
+
+                                    AvatarProvider::resolve(
+                                      ChatPage::instance()->currentRoom(),
+                                      user_id,
+                                      this,
+                                      [this](const QImage &img) { avatar_->setImage(img); });
+                            });
 
         QFont nameFont;
         nameFont.setPointSizeF(nameFont.pointSizeF() * 1.1);
@@ -111,26 +126,49 @@ MemberList::MemberList(const QString &room_id, QWidget *parent)
         list_->clear();
 
         connect(list_->verticalScrollBar(), &QAbstractSlider::valueChanged, this, [this](int pos) {
-                if (pos != list_->verticalScrollBar()->maximum())
-                        return;
-
-                const size_t numMembers = list_->count() - 1;
-
-                if (numMembers > 0)
-                        addUsers(cache::client()->getMembers(room_id_.toStdString(), numMembers));
+                if (pos == list_->verticalScrollBar()->maximum())
+                        loadMembers();
         });
 
-        try {
-                addUsers(cache::client()->getMembers(room_id_.toStdString()));
-        } catch (const lmdb::error &e) {
-                qCritical() << e.what();
-        }
+        loadMembers();
 
         auto closeShortcut = new QShortcut(QKeySequence(tr("ESC")), this);
         connect(closeShortcut, &QShortcut::activated, this, &MemberList::close);
         connect(okBtn, &QPushButton::clicked, this, &MemberList::close);
 }
 
+void
+MemberList::loadMembers()
+{
+        if (loadingMembers_ || !hasMoreMembers_)
+                return;
+
+        loadingMembers_ = true;
+
+        cache::read(this,
+                    [room_id = room_id_.toStdString(), after = lastMember_](Cache *cache) {
+                            return cache->getMembers(room_id, after, MEMBERS_PAGE_SIZE);
+                    },
+                    [this](const std::vector<RoomMember> &members) {
+                            loadingMembers_ = false;
+                            hasMoreMembers_ = members.size() == MEMBERS_PAGE_SIZE;
+
+                            if (!members.empty())
+                                    lastMember_ = members.back().user_id.toStdString();
+
+                            addUsers(members);
+
+                            if (list_->count() == 0)
+                                    return;
+
+                            // Keep going until the list can be scrolled.
+                            const int rowHeight =
+                              list_->item(0)->sizeHint().height() + 2 * list_->spacing();
+                            if (list_->count() * rowHeight < list_->viewport()->height())
+                                    loadMembers();
+                    });
+}
+
 void
 MemberList::addUsers(const std::vector<RoomMember> &members)
 {
@@ -142,7 +180,7 @@ MemberList::addUsers(const std::vector<RoomMember> &members)
                 item->setFlags(Qt::NoItemFlags);
                 item->setTextAlignment(Qt::AlignCenter);
 
-                list_->insertItem(list_->count() - 1, item);
+                list_->addItem(item);
                 list_->setItemWidget(item, user);
         }
 }
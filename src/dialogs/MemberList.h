@@ -3,6 +3,8 @@
 #include <QFrame>
 #include <QListWidget>
 
+#include <string>
+
 class Avatar;
 class QPushButton;
 class QHBoxLayout;
@@ -46,8 +48,16 @@ public slots:
         void addUsers(const std::vector<RoomMember> &users);
 
 private:
+        //! Read the next page of members in the background.
+        void loadMembers();
+
         QString room_id_;
         QLabel *topLabel_;
         QListWidget *list_;
+
+        //! The last member that was read, where the next page resumes from.
+        std::string lastMember_;
+        bool loadingMembers_ = false;
+        bool hasMoreMembers_ = true;
 };
 } // dialogs
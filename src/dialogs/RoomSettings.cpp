@@ -16,6 +16,7 @@
 
 #include "dialogs/RoomSettings.h"
 
+#include "AsyncCache.h"
 #include "ChatPage.h"
 #include "Config.h"
 #include "Logging.h"
@@ -476,11 +477,20 @@ RoomSettings::retrieveRoomInfo()
         try {
                 usesEncryption_ = cache::client()->isRoomEncrypted(room_id_.toStdString());
                 info_           = cache::client()->singleRoomInfo(room_id_.toStdString());
-                setAvatar(QImage::fromData(cache::client()->image(info_.avatar_url)));
         } catch (const lmdb::error &e) {
                 nhlog::db()->warn("failed to retrieve room info from cache: {}",
                                   room_id_.toStdString());
         }
+
+        // The avatar is read and decoded in the background.
+        cache::read(this,
+                    [url = QString::fromStdString(info_.avatar_url)](Cache *cache) {
+                            return QImage::fromData(cache->image(url));
+                    },
+                    [this](const QImage &img) {
+                            if (!img.isNull())
+                                    setAvatar(img);
+                    });
 }
 
 void
@@ -5,6 +5,7 @@
 #include <QShortcut>
 #include <QVBoxLayout>
 
+#include "AsyncCache.h"
 #include "AvatarProvider.h"
 #include "Cache.h"
 #include "ChatPage.h"
@@ -215,27 +216,28 @@ UserProfile::init(const QString &userId, const QString &roomId)
 
         auto localUser = utils::localUser();
 
-        try {
-                bool hasMemberRights =
-                  cache::client()->hasEnoughPowerLevel({mtx::events::EventType::RoomMember},
-                                                       roomId.toStdString(),
-                                                       localUser.toStdString());
-                if (!hasMemberRights) {
-                        kickBtn_->hide();
-                        banBtn_->hide();
-                } else {
-                        kickBtn_->show();
-                        banBtn_->show();
-                }
-        } catch (const lmdb::error &e) {
-                nhlog::db()->warn("lmdb error: {}", e.what());
-        }
+        // The moderation buttons are shown once the power levels are read.
+        kickBtn_->hide();
+        banBtn_->hide();
 
         if (localUser == userId) {
                 // TODO: click on display name & avatar to change.
-                kickBtn_->hide();
-                banBtn_->hide();
                 ignoreBtn_->hide();
+        } else {
+                cache::read(this,
+                            [room_id = roomId.toStdString(), local_user = localUser.toStdString()](
+                              Cache *cache) {
+                                    return cache->hasEnoughPowerLevel(
+                                      {mtx::events::EventType::RoomMember}, room_id, local_user);
+                            },
+                            [this, userId](bool hasMemberRights) {
+                                    // Another profile was opened in the meantime.
+                                    if (userId != userIdLabel_->text())
+                                            return;
+
+                                    kickBtn_->setVisible(hasMemberRights);
+                                    banBtn_->setVisible(hasMemberRights);
+                            });
         }
 
         mtx::requests::QueryKeys req;
@@ -18,28 +18,59 @@
 #pragma once
 
 #include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace emoji {
 
 struct Emoji
 {
-        // Unicode code.
-        QString unicode;
+        // Unicode code, UTF-8 encoded.
+        const char *unicode;
         // Keyboard shortcut e.g :emoji:
-        QString shortname;
+        const char *shortname;
+
+        QString text() const { return QString::fromUtf8(unicode); }
 };
 
+//! A slice of the generated emoji table.
+struct EmojiRange
+{
+        const Emoji *first;
+        const Emoji *last;
+
+        const Emoji *begin() const { return first; }
+        const Emoji *end() const { return last; }
+        std::size_t size() const { return last - first; }
+};
+
+//! The tables are generated by scripts/emoji_codegen.py and need no initialization at startup.
 class Provider
 {
 public:
-        static const std::vector<Emoji> people;
-        static const std::vector<Emoji> nature;
-        static const std::vector<Emoji> food;
-        static const std::vector<Emoji> activity;
-        static const std::vector<Emoji> travel;
-        static const std::vector<Emoji> objects;
-        static const std::vector<Emoji> symbols;
-        static const std::vector<Emoji> flags;
+        static const EmojiRange people;
+        static const EmojiRange nature;
+        static const EmojiRange food;
+        static const EmojiRange activity;
+        static const EmojiRange travel;
+        static const EmojiRange objects;
+        static const EmojiRange symbols;
+        static const EmojiRange flags;
+
+        //! Every emoji, grouped by category.
+        static const EmojiRange all;
+
+        //! Emoji whose shortname starts with the given prefix, from the shortest shortname.
+        //! The leading colon is optional.
+        static std::vector<const Emoji *> complete(const std::string &prefix,
+                                                   std::size_t maxItems = 10);
+
+private:
+        //! Positions in `all`, sorted by shortname.
+        static const std::uint16_t shortnameIndex[];
+        static const std::size_t shortnameIndexSize;
 };
 } // namespace emoji
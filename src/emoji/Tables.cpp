@@ -0,0 +1,1508 @@
+/*
+ * nheko Copyright (C) 2017  Konstantinos Sideris <siderisk@auth.gr>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generated by scripts/emoji_codegen.py from resources/emoji.json.
+
+#include "emoji/Provider.h"
+
+using namespace emoji;
+
+namespace {
+constexpr Emoji emojis[] = {
+  Emoji{"\xf0\x9f\x98\x80", ":grinning:"},
+  Emoji{"\xf0\x9f\x98\x81", ":grin:"},
+  Emoji{"\xf0\x9f\x98\x82", ":joy:"},
+  Emoji{"\xf0\x9f\xa4\xa3", ":rofl:"},
+  Emoji{"\xf0\x9f\x98\x83", ":smiley:"},
+  Emoji{"\xf0\x9f\x98\x84", ":smile:"},
+  Emoji{"\xf0\x9f\x98\x85", ":sweat_smile:"},
+  Emoji{"\xf0\x9f\x98\x86", ":laughing:"},
+  Emoji{"\xf0\x9f\x98\x89", ":wink:"},
+  Emoji{"\xf0\x9f\x98\x8a", ":blush:"},
+  Emoji{"\xf0\x9f\x98\x8b", ":yum:"},
+  Emoji{"\xf0\x9f\x98\x8e", ":sunglasses:"},
+  Emoji{"\xf0\x9f\x98\x8d", ":heart_eyes:"},
+  Emoji{"\xf0\x9f\x98\x98", ":kissing_heart:"},
+  Emoji{"\xf0\x9f\x98\x97", ":kissing:"},
+  Emoji{"\xf0\x9f\x98\x99", ":kissing_smiling_eyes:"},
+  Emoji{"\xf0\x9f\x98\x9a", ":kissing_closed_eyes:"},
+  Emoji{"\xe2\x98\xba", ":relaxed:"},
+  Emoji{"\xf0\x9f\x99\x82", ":slight_smile:"},
+  Emoji{"\xf0\x9f\xa4\x97", ":hugging:"},
+  Emoji{"\xf0\x9f\xa4\x94", ":thinking:"},
+  Emoji{"\xf0\x9f\x98\x90", ":neutral_face:"},
+  Emoji{"\xf0\x9f\x98\x91", ":expressionless:"},
+  Emoji{"\xf0\x9f\x98\xb6", ":no_mouth:"},
+  Emoji{"\xf0\x9f\x99\x84", ":rolling_eyes:"},
+  Emoji{"\xf0\x9f\x98\x8f", ":smirk:"},
+  Emoji{"\xf0\x9f\x98\xa3", ":persevere:"},
+  Emoji{"\xf0\x9f\x98\xa5", ":disappointed_relieved:"},
+  Emoji{"\xf0\x9f\x98\xae", ":open_mouth:"},
+  Emoji{"\xf0\x9f\xa4\x90", ":zipper_mouth:"},
+  Emoji{"\xf0\x9f\x98\xaf", ":hushed:"},
+  Emoji{"\xf0\x9f\x98\xaa", ":sleepy:"},
+  Emoji{"\xf0\x9f\x98\xab", ":tired_face:"},
+  Emoji{"\xf0\x9f\x98\xb4", ":sleeping:"},
+  Emoji{"\xf0\x9f\x98\x8c", ":relieved:"},
+  Emoji{"\xf0\x9f\xa4\x93", ":nerd:"},
+  Emoji{"\xf0\x9f\x98\x9b", ":stuck_out_tongue:"},
+  Emoji{"\xf0\x9f\x98\x9c", ":stuck_out_tongue_winking_eye:"},
+  Emoji{"\xf0\x9f\x98\x9d", ":stuck_out_tongue_closed_eyes:"},
+  Emoji{"\xf0\x9f\xa4\xa4", ":drooling_face:"},
+  Emoji{"\xf0\x9f\x98\x92", ":unamused:"},
+  Emoji{"\xf0\x9f\x98\x93", ":sweat:"},
+  Emoji{"\xf0\x9f\x98\x94", ":pensive:"},
+  Emoji{"\xf0\x9f\x98\x95", ":confused:"},
+  Emoji{"\xf0\x9f\x99\x83", ":upside_down:"},
+  Emoji{"\xf0\x9f\xa4\x91", ":money_mouth:"},
+  Emoji{"\xf0\x9f\x98\xb2", ":astonished:"},
+  Emoji{"\xe2\x98\xb9", ":frowning2:"},
+  Emoji{"\xf0\x9f\x99\x81", ":slight_frown:"},
+  Emoji{"\xf0\x9f\x98\x96", ":confounded:"},
+  Emoji{"\xf0\x9f\x98\x9e", ":disappointed:"},
+  Emoji{"\xf0\x9f\x98\x9f", ":worried:"},
+  Emoji{"\xf0\x9f\x98\xa4", ":triumph:"},
+  Emoji{"\xf0\x9f\x98\xa2", ":cry:"},
+  Emoji{"\xf0\x9f\x98\xad", ":sob:"},
+  Emoji{"\xf0\x9f\x98\xa6", ":frowning:"},
+  Emoji{"\xf0\x9f\x98\xa7", ":anguished:"},
+  Emoji{"\xf0\x9f\x98\xa8", ":fearful:"},
+  Emoji{"\xf0\x9f\x98\xa9", ":weary:"},
+  Emoji{"\xf0\x9f\x98\xac", ":grimacing:"},
+  Emoji{"\xf0\x9f\x98\xb0", ":cold_sweat:"},
+  Emoji{"\xf0\x9f\x98\xb1", ":scream:"},
+  Emoji{"\xf0\x9f\x98\xb3", ":flushed:"},
+  Emoji{"\xf0\x9f\x98\xb5", ":dizzy_face:"},
+  Emoji{"\xf0\x9f\x98\xa1", ":rage:"},
+  Emoji{"\xf0\x9f\x98\xa0", ":angry:"},
+  Emoji{"\xf0\x9f\x98\x87", ":innocent:"},
+  Emoji{"\xf0\x9f\xa4\xa0", ":cowboy:"},
+  Emoji{"\xf0\x9f\xa4\xa1", ":clown:"},
+  Emoji{"\xf0\x9f\xa4\xa5", ":lying_face:"},
+  Emoji{"\xf0\x9f\x98\xb7", ":mask:"},
+  Emoji{"\xf0\x9f\xa4\x92", ":thermometer_face:"},
+  Emoji{"\xf0\x9f\xa4\x95", ":head_bandage:"},
+  Emoji{"\xf0\x9f\xa4\xa2", ":nauseated_face:"},
+  Emoji{"\xf0\x9f\xa4\xa7", ":sneezing_face:"},
+  Emoji{"\xf0\x9f\x98\x88", ":smiling_imp:"},
+  Emoji{"\xf0\x9f\x91\xbf", ":imp:"},
+  Emoji{"\xf0\x9f\x91\xb9", ":japanese_ogre:"},
+  Emoji{"\xf0\x9f\x91\xba", ":japanese_goblin:"},
+  Emoji{"\xf0\x9f\x92\x80", ":skull:"},
+  Emoji{"\xf0\x9f\x91\xbb", ":ghost:"},
+  Emoji{"\xf0\x9f\x91\xbd", ":alien:"},
+  Emoji{"\xf0\x9f\xa4\x96", ":robot:"},
+  Emoji{"\xf0\x9f\x92\xa9", ":poop:"},
+  Emoji{"\xf0\x9f\x98\xba", ":smiley_cat:"},
+  Emoji{"\xf0\x9f\x98\xb8", ":smile_cat:"},
+  Emoji{"\xf0\x9f\x98\xb9", ":joy_cat:"},
+  Emoji{"\xf0\x9f\x98\xbb", ":heart_eyes_cat:"},
+  Emoji{"\xf0\x9f\x98\xbc", ":smirk_cat:"},
+  Emoji{"\xf0\x9f\x98\xbd", ":kissing_cat:"},
+  Emoji{"\xf0\x9f\x99\x80", ":scream_cat:"},
+  Emoji{"\xf0\x9f\x98\xbf", ":crying_cat_face:"},
+  Emoji{"\xf0\x9f\x98\xbe", ":pouting_cat:"},
+  Emoji{"\xf0\x9f\x91\xa6", ":boy:"},
+  Emoji{"\xf0\x9f\x91\xa7", ":girl:"},
+  Emoji{"\xf0\x9f\x91\xa8", ":man:"},
+  Emoji{"\xf0\x9f\x91\xa9", ":woman:"},
+  Emoji{"\xf0\x9f\x91\xb4", ":older_man:"},
+  Emoji{"\xf0\x9f\x91\xb5", ":older_woman:"},
+  Emoji{"\xf0\x9f\x91\xb6", ":baby:"},
+  Emoji{"\xf0\x9f\x91\xbc", ":angel:"},
+  Emoji{"\xf0\x9f\x91\xae", ":cop:"},
+  Emoji{"\xf0\x9f\x95\xb5", ":spy:"},
+  Emoji{"\xf0\x9f\x92\x82", ":guardsman:"},
+  Emoji{"\xf0\x9f\x91\xb7", ":construction_worker:"},
+  Emoji{"\xf0\x9f\x91\xb3", ":man_with_turban:"},
+  Emoji{"\xf0\x9f\x91\xb1", ":person_with_blond_hair:"},
+  Emoji{"\xf0\x9f\x8e\x85", ":santa:"},
+  Emoji{"\xf0\x9f\xa4\xb6", ":mrs_claus:"},
+  Emoji{"\xf0\x9f\x91\xb8", ":princess:"},
+  Emoji{"\xf0\x9f\xa4\xb4", ":prince:"},
+  Emoji{"\xf0\x9f\x91\xb0", ":bride_with_veil:"},
+  Emoji{"\xf0\x9f\xa4\xb5", ":man_in_tuxedo:"},
+  Emoji{"\xf0\x9f\xa4\xb0", ":pregnant_woman:"},
+  Emoji{"\xf0\x9f\x91\xb2", ":man_with_gua_pi_mao:"},
+  Emoji{"\xf0\x9f\x99\x8d", ":person_frowning:"},
+  Emoji{"\xf0\x9f\x99\x8e", ":person_with_pouting_face:"},
+  Emoji{"\xf0\x9f\x99\x85", ":no_good:"},
+  Emoji{"\xf0\x9f\x99\x86", ":ok_woman:"},
+  Emoji{"\xf0\x9f\x92\x81", ":information_desk_person:"},
+  Emoji{"\xf0\x9f\x99\x8b", ":raising_hand:"},
+  Emoji{"\xf0\x9f\x99\x87", ":bow:"},
+  Emoji{"\xf0\x9f\xa4\xa6", ":face_palm:"},
+  Emoji{"\xf0\x9f\xa4\xb7", ":shrug:"},
+  Emoji{"\xf0\x9f\x92\x86", ":massage:"},
+  Emoji{"\xf0\x9f\x92\x87", ":haircut:"},
+  Emoji{"\xf0\x9f\x9a\xb6", ":walking:"},
+  Emoji{"\xf0\x9f\x8f\x83", ":runner:"},
+  Emoji{"\xf0\x9f\x92\x83", ":dancer:"},
+  Emoji{"\xf0\x9f\x95\xba", ":man_dancing:"},
+  Emoji{"\xf0\x9f\x91\xaf", ":dancers:"},
+  Emoji{"\xf0\x9f\x97\xa3", ":speaking_head:"},
+  Emoji{"\xf0\x9f\x91\xa4", ":bust_in_silhouette:"},
+  Emoji{"\xf0\x9f\x91\xa5", ":busts_in_silhouette:"},
+  Emoji{"\xf0\x9f\x91\xab", ":couple:"},
+  Emoji{"\xf0\x9f\x91\xac", ":two_men_holding_hands:"},
+  Emoji{"\xf0\x9f\x91\xad", ":two_women_holding_hands:"},
+  Emoji{"\xf0\x9f\x92\x8f", ":couplekiss:"},
+  Emoji{"\xf0\x9f\x92\x91", ":couple_with_heart:"},
+  Emoji{"\xf0\x9f\x91\xaa", ":family:"},
+  Emoji{"\xf0\x9f\x92\xaa", ":muscle:"},
+  Emoji{"\xf0\x9f\xa4\xb3", ":selfie:"},
+  Emoji{"\xf0\x9f\x91\x88", ":point_left:"},
+  Emoji{"\xf0\x9f\x91\x89", ":point_right:"},
+  Emoji{"\xe2\x98\x9d", ":point_up:"},
+  Emoji{"\xf0\x9f\x91\x86", ":point_up_2:"},
+  Emoji{"\xf0\x9f\x96\x95", ":middle_finger:"},
+  Emoji{"\xf0\x9f\x91\x87", ":point_down:"},
+  Emoji{"\xe2\x9c\x8c", ":v:"},
+  Emoji{"\xf0\x9f\xa4\x9e", ":fingers_crossed:"},
+  Emoji{"\xf0\x9f\x96\x96", ":vulcan:"},
+  Emoji{"\xf0\x9f\xa4\x98", ":metal:"},
+  Emoji{"\xf0\x9f\xa4\x99", ":call_me:"},
+  Emoji{"\xf0\x9f\x96\x90", ":hand_splayed:"},
+  Emoji{"\xe2\x9c\x8b", ":raised_hand:"},
+  Emoji{"\xf0\x9f\x91\x8c", ":ok_hand:"},
+  Emoji{"\xf0\x9f\x91\x8d", ":thumbsup:"},
+  Emoji{"\xf0\x9f\x91\x8e", ":thumbsdown:"},
+  Emoji{"\xe2\x9c\x8a", ":fist:"},
+  Emoji{"\xf0\x9f\x91\x8a", ":punch:"},
+  Emoji{"\xf0\x9f\xa4\x9b", ":left_facing_fist:"},
+  Emoji{"\xf0\x9f\xa4\x9c", ":right_facing_fist:"},
+  Emoji{"\xf0\x9f\xa4\x9a", ":raised_back_of_hand:"},
+  Emoji{"\xf0\x9f\x91\x8b", ":wave:"},
+  Emoji{"\xf0\x9f\x91\x8f", ":clap:"},
+  Emoji{"\xe2\x9c\x8d", ":writing_hand:"},
+  Emoji{"\xf0\x9f\x91\x90", ":open_hands:"},
+  Emoji{"\xf0\x9f\x99\x8c", ":raised_hands:"},
+  Emoji{"\xf0\x9f\x99\x8f", ":pray:"},
+  Emoji{"\xf0\x9f\xa4\x9d", ":handshake:"},
+  Emoji{"\xf0\x9f\x92\x85", ":nail_care:"},
+  Emoji{"\xf0\x9f\x91\x82", ":ear:"},
+  Emoji{"\xf0\x9f\x91\x83", ":nose:"},
+  Emoji{"\xf0\x9f\x91\xa3", ":footprints:"},
+  Emoji{"\xf0\x9f\x91\x80", ":eyes:"},
+  Emoji{"\xf0\x9f\x91\x81", ":eye:"},
+  Emoji{"\xf0\x9f\x91\x85", ":tongue:"},
+  Emoji{"\xf0\x9f\x91\x84", ":lips:"},
+  Emoji{"\xf0\x9f\x92\x8b", ":kiss:"},
+  Emoji{"\xf0\x9f\x92\xa4", ":zzz:"},
+  Emoji{"\xf0\x9f\x91\x93", ":eyeglasses:"},
+  Emoji{"\xf0\x9f\x95\xb6", ":dark_sunglasses:"},
+  Emoji{"\xf0\x9f\x91\x94", ":necktie:"},
+  Emoji{"\xf0\x9f\x91\x95", ":shirt:"},
+  Emoji{"\xf0\x9f\x91\x96", ":jeans:"},
+  Emoji{"\xf0\x9f\x91\x97", ":dress:"},
+  Emoji{"\xf0\x9f\x91\x98", ":kimono:"},
+  Emoji{"\xf0\x9f\x91\x99", ":bikini:"},
+  Emoji{"\xf0\x9f\x91\x9a", ":womans_clothes:"},
+  Emoji{"\xf0\x9f\x91\x9b", ":purse:"},
+  Emoji{"\xf0\x9f\x91\x9c", ":handbag:"},
+  Emoji{"\xf0\x9f\x91\x9d", ":pouch:"},
+  Emoji{"\xf0\x9f\x8e\x92", ":school_satchel:"},
+  Emoji{"\xf0\x9f\x91\x9e", ":mans_shoe:"},
+  Emoji{"\xf0\x9f\x91\x9f", ":athletic_shoe:"},
+  Emoji{"\xf0\x9f\x91\xa0", ":high_heel:"},
+  Emoji{"\xf0\x9f\x91\xa1", ":sandal:"},
+  Emoji{"\xf0\x9f\x91\xa2", ":boot:"},
+  Emoji{"\xf0\x9f\x91\x91", ":crown:"},
+  Emoji{"\xf0\x9f\x91\x92", ":womans_hat:"},
+  Emoji{"\xf0\x9f\x8e\xa9", ":tophat:"},
+  Emoji{"\xf0\x9f\x8e\x93", ":mortar_board:"},
+  Emoji{"\xe2\x9b\x91", ":helmet_with_cross:"},
+  Emoji{"\xf0\x9f\x92\x84", ":lipstick:"},
+  Emoji{"\xf0\x9f\x92\x8d", ":ring:"},
+  Emoji{"\xf0\x9f\x8c\x82", ":closed_umbrella:"},
+  Emoji{"\xf0\x9f\x92\xbc", ":briefcase:"},
+  Emoji{"\xf0\x9f\x99\x88", ":see_no_evil:"},
+  Emoji{"\xf0\x9f\x99\x89", ":hear_no_evil:"},
+  Emoji{"\xf0\x9f\x99\x8a", ":speak_no_evil:"},
+  Emoji{"\xf0\x9f\x92\xa6", ":sweat_drops:"},
+  Emoji{"\xf0\x9f\x92\xa8", ":dash:"},
+  Emoji{"\xf0\x9f\x90\xb5", ":monkey_face:"},
+  Emoji{"\xf0\x9f\x90\x92", ":monkey:"},
+  Emoji{"\xf0\x9f\xa6\x8d", ":gorilla:"},
+  Emoji{"\xf0\x9f\x90\xb6", ":dog:"},
+  Emoji{"\xf0\x9f\x90\x95", ":dog2:"},
+  Emoji{"\xf0\x9f\x90\xa9", ":poodle:"},
+  Emoji{"\xf0\x9f\x90\xba", ":wolf:"},
+  Emoji{"\xf0\x9f\xa6\x8a", ":fox:"},
+  Emoji{"\xf0\x9f\x90\xb1", ":cat:"},
+  Emoji{"\xf0\x9f\x90\x88", ":cat2:"},
+  Emoji{"\xf0\x9f\xa6\x81", ":lion_face:"},
+  Emoji{"\xf0\x9f\x90\xaf", ":tiger:"},
+  Emoji{"\xf0\x9f\x90\x85", ":tiger2:"},
+  Emoji{"\xf0\x9f\x90\x86", ":leopard:"},
+  Emoji{"\xf0\x9f\x90\xb4", ":horse:"},
+  Emoji{"\xf0\x9f\x90\x8e", ":racehorse:"},
+  Emoji{"\xf0\x9f\xa6\x8c", ":deer:"},
+  Emoji{"\xf0\x9f\xa6\x84", ":unicorn:"},
+  Emoji{"\xf0\x9f\x90\xae", ":cow:"},
+  Emoji{"\xf0\x9f\x90\x82", ":ox:"},
+  Emoji{"\xf0\x9f\x90\x83", ":water_buffalo:"},
+  Emoji{"\xf0\x9f\x90\x84", ":cow2:"},
+  Emoji{"\xf0\x9f\x90\xb7", ":pig:"},
+  Emoji{"\xf0\x9f\x90\x96", ":pig2:"},
+  Emoji{"\xf0\x9f\x90\x97", ":boar:"},
+  Emoji{"\xf0\x9f\x90\xbd", ":pig_nose:"},
+  Emoji{"\xf0\x9f\x90\x8f", ":ram:"},
+  Emoji{"\xf0\x9f\x90\x91", ":sheep:"},
+  Emoji{"\xf0\x9f\x90\x90", ":goat:"},
+  Emoji{"\xf0\x9f\x90\xaa", ":dromedary_camel:"},
+  Emoji{"\xf0\x9f\x90\xab", ":camel:"},
+  Emoji{"\xf0\x9f\x90\x98", ":elephant:"},
+  Emoji{"\xf0\x9f\xa6\x8f", ":rhino:"},
+  Emoji{"\xf0\x9f\x90\xad", ":mouse:"},
+  Emoji{"\xf0\x9f\x90\x81", ":mouse2:"},
+  Emoji{"\xf0\x9f\x90\x80", ":rat:"},
+  Emoji{"\xf0\x9f\x90\xb9", ":hamster:"},
+  Emoji{"\xf0\x9f\x90\xb0", ":rabbit:"},
+  Emoji{"\xf0\x9f\x90\x87", ":rabbit2:"},
+  Emoji{"\xf0\x9f\x90\xbf", ":chipmunk:"},
+  Emoji{"\xf0\x9f\xa6\x87", ":bat:"},
+  Emoji{"\xf0\x9f\x90\xbb", ":bear:"},
+  Emoji{"\xf0\x9f\x90\xa8", ":koala:"},
+  Emoji{"\xf0\x9f\x90\xbc", ":panda_face:"},
+  Emoji{"\xf0\x9f\x90\xbe", ":feet:"},
+  Emoji{"\xf0\x9f\xa6\x83", ":turkey:"},
+  Emoji{"\xf0\x9f\x90\x94", ":chicken:"},
+  Emoji{"\xf0\x9f\x90\x93", ":rooster:"},
+  Emoji{"\xf0\x9f\x90\xa3", ":hatching_chick:"},
+  Emoji{"\xf0\x9f\x90\xa4", ":baby_chick:"},
+  Emoji{"\xf0\x9f\x90\xa5", ":hatched_chick:"},
+  Emoji{"\xf0\x9f\x90\xa6", ":bird:"},
+  Emoji{"\xf0\x9f\x90\xa7", ":penguin:"},
+  Emoji{"\xf0\x9f\x95\x8a", ":dove:"},
+  Emoji{"\xf0\x9f\xa6\x85", ":eagle:"},
+  Emoji{"\xf0\x9f\xa6\x86", ":duck:"},
+  Emoji{"\xf0\x9f\xa6\x89", ":owl:"},
+  Emoji{"\xf0\x9f\x90\xb8", ":frog:"},
+  Emoji{"\xf0\x9f\x90\x8a", ":crocodile:"},
+  Emoji{"\xf0\x9f\x90\xa2", ":turtle:"},
+  Emoji{"\xf0\x9f\xa6\x8e", ":lizard:"},
+  Emoji{"\xf0\x9f\x90\x8d", ":snake:"},
+  Emoji{"\xf0\x9f\x90\xb2", ":dragon_face:"},
+  Emoji{"\xf0\x9f\x90\x89", ":dragon:"},
+  Emoji{"\xf0\x9f\x90\xb3", ":whale:"},
+  Emoji{"\xf0\x9f\x90\x8b", ":whale2:"},
+  Emoji{"\xf0\x9f\x90\xac", ":dolphin:"},
+  Emoji{"\xf0\x9f\x90\x9f", ":fish:"},
+  Emoji{"\xf0\x9f\x90\xa0", ":tropical_fish:"},
+  Emoji{"\xf0\x9f\x90\xa1", ":blowfish:"},
+  Emoji{"\xf0\x9f\xa6\x88", ":shark:"},
+  Emoji{"\xf0\x9f\x90\x99", ":octopus:"},
+  Emoji{"\xf0\x9f\x90\x9a", ":shell:"},
+  Emoji{"\xf0\x9f\xa6\x80", ":crab:"},
+  Emoji{"\xf0\x9f\xa6\x90", ":shrimp:"},
+  Emoji{"\xf0\x9f\xa6\x91", ":squid:"},
+  Emoji{"\xf0\x9f\xa6\x8b", ":butterfly:"},
+  Emoji{"\xf0\x9f\x90\x8c", ":snail:"},
+  Emoji{"\xf0\x9f\x90\x9b", ":bug:"},
+  Emoji{"\xf0\x9f\x90\x9c", ":ant:"},
+  Emoji{"\xf0\x9f\x90\x9d", ":bee:"},
+  Emoji{"\xf0\x9f\x90\x9e", ":beetle:"},
+  Emoji{"\xf0\x9f\x95\xb7", ":spider:"},
+  Emoji{"\xf0\x9f\x95\xb8", ":spider_web:"},
+  Emoji{"\xf0\x9f\xa6\x82", ":scorpion:"},
+  Emoji{"\xf0\x9f\x92\x90", ":bouquet:"},
+  Emoji{"\xf0\x9f\x8c\xb8", ":cherry_blossom:"},
+  Emoji{"\xf0\x9f\x8f\xb5", ":rosette:"},
+  Emoji{"\xf0\x9f\x8c\xb9", ":rose:"},
+  Emoji{"\xf0\x9f\xa5\x80", ":wilted_rose:"},
+  Emoji{"\xf0\x9f\x8c\xba", ":hibiscus:"},
+  Emoji{"\xf0\x9f\x8c\xbb", ":sunflower:"},
+  Emoji{"\xf0\x9f\x8c\xbc", ":blossom:"},
+  Emoji{"\xf0\x9f\x8c\xb7", ":tulip:"},
+  Emoji{"\xf0\x9f\x8c\xb1", ":seedling:"},
+  Emoji{"\xf0\x9f\x8c\xb2", ":evergreen_tree:"},
+  Emoji{"\xf0\x9f\x8c\xb3", ":deciduous_tree:"},
+  Emoji{"\xf0\x9f\x8c\xb4", ":palm_tree:"},
+  Emoji{"\xf0\x9f\x8c\xb5", ":cactus:"},
+  Emoji{"\xf0\x9f\x8c\xbe", ":ear_of_rice:"},
+  Emoji{"\xf0\x9f\x8c\xbf", ":herb:"},
+  Emoji{"\xe2\x98\x98", ":shamrock:"},
+  Emoji{"\xf0\x9f\x8d\x80", ":four_leaf_clover:"},
+  Emoji{"\xf0\x9f\x8d\x81", ":maple_leaf:"},
+  Emoji{"\xf0\x9f\x8d\x82", ":fallen_leaf:"},
+  Emoji{"\xf0\x9f\x8d\x83", ":leaves:"},
+  Emoji{"\xf0\x9f\x8d\x84", ":mushroom:"},
+  Emoji{"\xf0\x9f\x8c\xb0", ":chestnut:"},
+  Emoji{"\xf0\x9f\x8c\x8d", ":earth_africa:"},
+  Emoji{"\xf0\x9f\x8c\x8e", ":earth_americas:"},
+  Emoji{"\xf0\x9f\x8c\x8f", ":earth_asia:"},
+  Emoji{"\xf0\x9f\x8c\x91", ":new_moon:"},
+  Emoji{"\xf0\x9f\x8c\x92", ":waxing_crescent_moon:"},
+  Emoji{"\xf0\x9f\x8c\x93", ":first_quarter_moon:"},
+  Emoji{"\xf0\x9f\x8c\x94", ":waxing_gibbous_moon:"},
+  Emoji{"\xf0\x9f\x8c\x95", ":full_moon:"},
+  Emoji{"\xf0\x9f\x8c\x96", ":waning_gibbous_moon:"},
+  Emoji{"\xf0\x9f\x8c\x97", ":last_quarter_moon:"},
+  Emoji{"\xf0\x9f\x8c\x98", ":waning_crescent_moon:"},
+  Emoji{"\xf0\x9f\x8c\x99", ":crescent_moon:"},
+  Emoji{"\xf0\x9f\x8c\x9a", ":new_moon_with_face:"},
+  Emoji{"\xf0\x9f\x8c\x9b", ":first_quarter_moon_with_face:"},
+  Emoji{"\xf0\x9f\x8c\x9c", ":last_quarter_moon_with_face:"},
+  Emoji{"\xe2\x98\x80", ":sunny:"},
+  Emoji{"\xf0\x9f\x8c\x9d", ":full_moon_with_face:"},
+  Emoji{"\xf0\x9f\x8c\x9e", ":sun_with_face:"},
+  Emoji{"\xe2\xad\x90", ":star:"},
+  Emoji{"\xf0\x9f\x8c\x9f", ":star2:"},
+  Emoji{"\xe2\x98\x81", ":cloud:"},
+  Emoji{"\xe2\x9b\x85", ":partly_sunny:"},
+  Emoji{"\xe2\x9b\x88", ":thunder_cloud_rain:"},
+  Emoji{"\xf0\x9f\x8c\xa4", ":white_sun_small_cloud:"},
+  Emoji{"\xf0\x9f\x8c\xa5", ":white_sun_cloud:"},
+  Emoji{"\xf0\x9f\x8c\xa6", ":white_sun_rain_cloud:"},
+  Emoji{"\xf0\x9f\x8c\xa7", ":cloud_rain:"},
+  Emoji{"\xf0\x9f\x8c\xa8", ":cloud_snow:"},
+  Emoji{"\xf0\x9f\x8c\xa9", ":cloud_lightning:"},
+  Emoji{"\xf0\x9f\x8c\xaa", ":cloud_tornado:"},
+  Emoji{"\xf0\x9f\x8c\xab", ":fog:"},
+  Emoji{"\xf0\x9f\x8c\xac", ":wind_blowing_face:"},
+  Emoji{"\xe2\x98\x82", ":umbrella2:"},
+  Emoji{"\xe2\x98\x94", ":umbrella:"},
+  Emoji{"\xe2\x9a\xa1", ":zap:"},
+  Emoji{"\xe2\x9d\x84", ":snowflake:"},
+  Emoji{"\xe2\x98\x83", ":snowman2:"},
+  Emoji{"\xe2\x9b\x84", ":snowman:"},
+  Emoji{"\xe2\x98\x84", ":comet:"},
+  Emoji{"\xf0\x9f\x94\xa5", ":fire:"},
+  Emoji{"\xf0\x9f\x92\xa7", ":droplet:"},
+  Emoji{"\xf0\x9f\x8c\x8a", ":ocean:"},
+  Emoji{"\xf0\x9f\x8e\x83", ":jack_o_lantern:"},
+  Emoji{"\xf0\x9f\x8e\x84", ":christmas_tree:"},
+  Emoji{"\xe2\x9c\xa8", ":sparkles:"},
+  Emoji{"\xf0\x9f\x8e\x8b", ":tanabata_tree:"},
+  Emoji{"\xf0\x9f\x8e\x8d", ":bamboo:"},
+  Emoji{"\xf0\x9f\x8d\x87", ":grapes:"},
+  Emoji{"\xf0\x9f\x8d\x88", ":melon:"},
+  Emoji{"\xf0\x9f\x8d\x89", ":watermelon:"},
+  Emoji{"\xf0\x9f\x8d\x8a", ":tangerine:"},
+  Emoji{"\xf0\x9f\x8d\x8b", ":lemon:"},
+  Emoji{"\xf0\x9f\x8d\x8c", ":banana:"},
+  Emoji{"\xf0\x9f\x8d\x8d", ":pineapple:"},
+  Emoji{"\xf0\x9f\x8d\x8e", ":apple:"},
+  Emoji{"\xf0\x9f\x8d\x8f", ":green_apple:"},
+  Emoji{"\xf0\x9f\x8d\x90", ":pear:"},
+  Emoji{"\xf0\x9f\x8d\x91", ":peach:"},
+  Emoji{"\xf0\x9f\x8d\x92", ":cherries:"},
+  Emoji{"\xf0\x9f\x8d\x93", ":strawberry:"},
+  Emoji{"\xf0\x9f\xa5\x9d", ":kiwi:"},
+  Emoji{"\xf0\x9f\x8d\x85", ":tomato:"},
+  Emoji{"\xf0\x9f\xa5\x91", ":avocado:"},
+  Emoji{"\xf0\x9f\x8d\x86", ":eggplant:"},
+  Emoji{"\xf0\x9f\xa5\x94", ":potato:"},
+  Emoji{"\xf0\x9f\xa5\x95", ":carrot:"},
+  Emoji{"\xf0\x9f\x8c\xbd", ":corn:"},
+  Emoji{"\xf0\x9f\x8c\xb6", ":hot_pepper:"},
+  Emoji{"\xf0\x9f\xa5\x92", ":cucumber:"},
+  Emoji{"\xf0\x9f\xa5\x9c", ":peanuts:"},
+  Emoji{"\xf0\x9f\x8d\x9e", ":bread:"},
+  Emoji{"\xf0\x9f\xa5\x90", ":croissant:"},
+  Emoji{"\xf0\x9f\xa5\x96", ":french_bread:"},
+  Emoji{"\xf0\x9f\xa5\x9e", ":pancakes:"},
+  Emoji{"\xf0\x9f\xa7\x80", ":cheese:"},
+  Emoji{"\xf0\x9f\x8d\x96", ":meat_on_bone:"},
+  Emoji{"\xf0\x9f\x8d\x97", ":poultry_leg:"},
+  Emoji{"\xf0\x9f\xa5\x93", ":bacon:"},
+  Emoji{"\xf0\x9f\x8d\x94", ":hamburger:"},
+  Emoji{"\xf0\x9f\x8d\x9f", ":fries:"},
+  Emoji{"\xf0\x9f\x8d\x95", ":pizza:"},
+  Emoji{"\xf0\x9f\x8c\xad", ":hotdog:"},
+  Emoji{"\xf0\x9f\x8c\xae", ":taco:"},
+  Emoji{"\xf0\x9f\x8c\xaf", ":burrito:"},
+  Emoji{"\xf0\x9f\xa5\x99", ":stuffed_flatbread:"},
+  Emoji{"\xf0\x9f\xa5\x9a", ":egg:"},
+  Emoji{"\xf0\x9f\x8d\xb3", ":cooking:"},
+  Emoji{"\xf0\x9f\xa5\x98", ":shallow_pan_of_food:"},
+  Emoji{"\xf0\x9f\x8d\xb2", ":stew:"},
+  Emoji{"\xf0\x9f\xa5\x97", ":salad:"},
+  Emoji{"\xf0\x9f\x8d\xbf", ":popcorn:"},
+  Emoji{"\xf0\x9f\x8d\xb1", ":bento:"},
+  Emoji{"\xf0\x9f\x8d\x98", ":rice_cracker:"},
+  Emoji{"\xf0\x9f\x8d\x99", ":rice_ball:"},
+  Emoji{"\xf0\x9f\x8d\x9a", ":rice:"},
+  Emoji{"\xf0\x9f\x8d\x9b", ":curry:"},
+  Emoji{"\xf0\x9f\x8d\x9c", ":ramen:"},
+  Emoji{"\xf0\x9f\x8d\x9d", ":spaghetti:"},
+  Emoji{"\xf0\x9f\x8d\xa0", ":sweet_potato:"},
+  Emoji{"\xf0\x9f\x8d\xa2", ":oden:"},
+  Emoji{"\xf0\x9f\x8d\xa3", ":sushi:"},
+  Emoji{"\xf0\x9f\x8d\xa4", ":fried_shrimp:"},
+  Emoji{"\xf0\x9f\x8d\xa5", ":fish_cake:"},
+  Emoji{"\xf0\x9f\x8d\xa1", ":dango:"},
+  Emoji{"\xf0\x9f\x8d\xa6", ":icecream:"},
+  Emoji{"\xf0\x9f\x8d\xa7", ":shaved_ice:"},
+  Emoji{"\xf0\x9f\x8d\xa8", ":ice_cream:"},
+  Emoji{"\xf0\x9f\x8d\xa9", ":doughnut:"},
+  Emoji{"\xf0\x9f\x8d\xaa", ":cookie:"},
+  Emoji{"\xf0\x9f\x8e\x82", ":birthday:"},
+  Emoji{"\xf0\x9f\x8d\xb0", ":cake:"},
+  Emoji{"\xf0\x9f\x8d\xab", ":chocolate_bar:"},
+  Emoji{"\xf0\x9f\x8d\xac", ":candy:"},
+  Emoji{"\xf0\x9f\x8d\xad", ":lollipop:"},
+  Emoji{"\xf0\x9f\x8d\xae", ":custard:"},
+  Emoji{"\xf0\x9f\x8d\xaf", ":honey_pot:"},
+  Emoji{"\xf0\x9f\x8d\xbc", ":baby_bottle:"},
+  Emoji{"\xf0\x9f\xa5\x9b", ":milk:"},
+  Emoji{"\xe2\x98\x95", ":coffee:"},
+  Emoji{"\xf0\x9f\x8d\xb5", ":tea:"},
+  Emoji{"\xf0\x9f\x8d\xb6", ":sake:"},
+  Emoji{"\xf0\x9f\x8d\xbe", ":champagne:"},
+  Emoji{"\xf0\x9f\x8d\xb7", ":wine_glass:"},
+  Emoji{"\xf0\x9f\x8d\xb8", ":cocktail:"},
+  Emoji{"\xf0\x9f\x8d\xb9", ":tropical_drink:"},
+  Emoji{"\xf0\x9f\x8d\xba", ":beer:"},
+  Emoji{"\xf0\x9f\x8d\xbb", ":beers:"},
+  Emoji{"\xf0\x9f\xa5\x82", ":champagne_glass:"},
+  Emoji{"\xf0\x9f\xa5\x83", ":tumbler_glass:"},
+  Emoji{"\xf0\x9f\x8d\xbd", ":fork_knife_plate:"},
+  Emoji{"\xf0\x9f\x8d\xb4", ":fork_and_knife:"},
+  Emoji{"\xf0\x9f\xa5\x84", ":spoon:"},
+  Emoji{"\xf0\x9f\x91\xbe", ":space_invader:"},
+  Emoji{"\xf0\x9f\x95\xb4", ":levitate:"},
+  Emoji{"\xf0\x9f\xa4\xba", ":fencer:"},
+  Emoji{"\xf0\x9f\x8f\x87", ":horse_racing:"},
+  Emoji{"\xe2\x9b\xb7", ":skier:"},
+  Emoji{"\xf0\x9f\x8f\x82", ":snowboarder:"},
+  Emoji{"\xf0\x9f\x8f\x8c", ":golfer:"},
+  Emoji{"\xf0\x9f\x8f\x84", ":surfer:"},
+  Emoji{"\xf0\x9f\x9a\xa3", ":rowboat:"},
+  Emoji{"\xf0\x9f\x8f\x8a", ":swimmer:"},
+  Emoji{"\xe2\x9b\xb9", ":basketball_player:"},
+  Emoji{"\xf0\x9f\x8f\x8b", ":lifter:"},
+  Emoji{"\xf0\x9f\x9a\xb4", ":bicyclist:"},
+  Emoji{"\xf0\x9f\x9a\xb5", ":mountain_bicyclist:"},
+  Emoji{"\xf0\x9f\xa4\xb8", ":cartwheel:"},
+  Emoji{"\xf0\x9f\xa4\xbc", ":wrestlers:"},
+  Emoji{"\xf0\x9f\xa4\xbd", ":water_polo:"},
+  Emoji{"\xf0\x9f\xa4\xbe", ":handball:"},
+  Emoji{"\xf0\x9f\xa4\xb9", ":juggling:"},
+  Emoji{"\xf0\x9f\x8e\xaa", ":circus_tent:"},
+  Emoji{"\xf0\x9f\x8e\xad", ":performing_arts:"},
+  Emoji{"\xf0\x9f\x8e\xa8", ":art:"},
+  Emoji{"\xf0\x9f\x8e\xb0", ":slot_machine:"},
+  Emoji{"\xf0\x9f\x9b\x80", ":bath:"},
+  Emoji{"\xf0\x9f\x8e\x97", ":reminder_ribbon:"},
+  Emoji{"\xf0\x9f\x8e\x9f", ":tickets:"},
+  Emoji{"\xf0\x9f\x8e\xab", ":ticket:"},
+  Emoji{"\xf0\x9f\x8e\x96", ":military_medal:"},
+  Emoji{"\xf0\x9f\x8f\x86", ":trophy:"},
+  Emoji{"\xf0\x9f\x8f\x85", ":medal:"},
+  Emoji{"\xf0\x9f\xa5\x87", ":first_place:"},
+  Emoji{"\xf0\x9f\xa5\x88", ":second_place:"},
+  Emoji{"\xf0\x9f\xa5\x89", ":third_place:"},
+  Emoji{"\xe2\x9a\xbd", ":soccer:"},
+  Emoji{"\xe2\x9a\xbe", ":baseball:"},
+  Emoji{"\xf0\x9f\x8f\x80", ":basketball:"},
+  Emoji{"\xf0\x9f\x8f\x90", ":volleyball:"},
+  Emoji{"\xf0\x9f\x8f\x88", ":football:"},
+  Emoji{"\xf0\x9f\x8f\x89", ":rugby_football:"},
+  Emoji{"\xf0\x9f\x8e\xbe", ":tennis:"},
+  Emoji{"\xf0\x9f\x8e\xb1", ":8ball:"},
+  Emoji{"\xf0\x9f\x8e\xb3", ":bowling:"},
+  Emoji{"\xf0\x9f\x8f\x8f", ":cricket:"},
+  Emoji{"\xf0\x9f\x8f\x91", ":field_hockey:"},
+  Emoji{"\xf0\x9f\x8f\x92", ":hockey:"},
+  Emoji{"\xf0\x9f\x8f\x93", ":ping_pong:"},
+  Emoji{"\xf0\x9f\x8f\xb8", ":badminton:"},
+  Emoji{"\xf0\x9f\xa5\x8a", ":boxing_glove:"},
+  Emoji{"\xf0\x9f\xa5\x8b", ":martial_arts_uniform:"},
+  Emoji{"\xf0\x9f\xa5\x85", ":goal:"},
+  Emoji{"\xf0\x9f\x8e\xaf", ":dart:"},
+  Emoji{"\xe2\x9b\xb3", ":golf:"},
+  Emoji{"\xe2\x9b\xb8", ":ice_skate:"},
+  Emoji{"\xf0\x9f\x8e\xa3", ":fishing_pole_and_fish:"},
+  Emoji{"\xf0\x9f\x8e\xbd", ":running_shirt_with_sash:"},
+  Emoji{"\xf0\x9f\x8e\xbf", ":ski:"},
+  Emoji{"\xf0\x9f\x8e\xae", ":video_game:"},
+  Emoji{"\xf0\x9f\x8e\xb2", ":game_die:"},
+  Emoji{"\xf0\x9f\x8e\xbc", ":musical_score:"},
+  Emoji{"\xf0\x9f\x8e\xa4", ":microphone:"},
+  Emoji{"\xf0\x9f\x8e\xa7", ":headphones:"},
+  Emoji{"\xf0\x9f\x8e\xb7", ":saxophone:"},
+  Emoji{"\xf0\x9f\x8e\xb8", ":guitar:"},
+  Emoji{"\xf0\x9f\x8e\xb9", ":musical_keyboard:"},
+  Emoji{"\xf0\x9f\x8e\xba", ":trumpet:"},
+  Emoji{"\xf0\x9f\x8e\xbb", ":violin:"},
+  Emoji{"\xf0\x9f\xa5\x81", ":drum:"},
+  Emoji{"\xf0\x9f\x8e\xac", ":clapper:"},
+  Emoji{"\xf0\x9f\x8f\xb9", ":bow_and_arrow:"},
+  Emoji{"\xf0\x9f\x8f\x8e", ":race_car:"},
+  Emoji{"\xf0\x9f\x8f\x8d", ":motorcycle:"},
+  Emoji{"\xf0\x9f\x97\xbe", ":japan:"},
+  Emoji{"\xf0\x9f\x8f\x94", ":mountain_snow:"},
+  Emoji{"\xe2\x9b\xb0", ":mountain:"},
+  Emoji{"\xf0\x9f\x8c\x8b", ":volcano:"},
+  Emoji{"\xf0\x9f\x97\xbb", ":mount_fuji:"},
+  Emoji{"\xf0\x9f\x8f\x95", ":camping:"},
+  Emoji{"\xf0\x9f\x8f\x96", ":beach:"},
+  Emoji{"\xf0\x9f\x8f\x9c", ":desert:"},
+  Emoji{"\xf0\x9f\x8f\x9d", ":island:"},
+  Emoji{"\xf0\x9f\x8f\x9e", ":park:"},
+  Emoji{"\xf0\x9f\x8f\x9f", ":stadium:"},
+  Emoji{"\xf0\x9f\x8f\x9b", ":classical_building:"},
+  Emoji{"\xf0\x9f\x8f\x97", ":construction_site:"},
+  Emoji{"\xf0\x9f\x8f\x98", ":homes:"},
+  Emoji{"\xf0\x9f\x8f\x99", ":cityscape:"},
+  Emoji{"\xf0\x9f\x8f\x9a", ":house_abandoned:"},
+  Emoji{"\xf0\x9f\x8f\xa0", ":house:"},
+  Emoji{"\xf0\x9f\x8f\xa1", ":house_with_garden:"},
+  Emoji{"\xf0\x9f\x8f\xa2", ":office:"},
+  Emoji{"\xf0\x9f\x8f\xa3", ":post_office:"},
+  Emoji{"\xf0\x9f\x8f\xa4", ":european_post_office:"},
+  Emoji{"\xf0\x9f\x8f\xa5", ":hospital:"},
+  Emoji{"\xf0\x9f\x8f\xa6", ":bank:"},
+  Emoji{"\xf0\x9f\x8f\xa8", ":hotel:"},
+  Emoji{"\xf0\x9f\x8f\xa9", ":love_hotel:"},
+  Emoji{"\xf0\x9f\x8f\xaa", ":convenience_store:"},
+  Emoji{"\xf0\x9f\x8f\xab", ":school:"},
+  Emoji{"\xf0\x9f\x8f\xac", ":department_store:"},
+  Emoji{"\xf0\x9f\x8f\xad", ":factory:"},
+  Emoji{"\xf0\x9f\x8f\xaf", ":japanese_castle:"},
+  Emoji{"\xf0\x9f\x8f\xb0", ":european_castle:"},
+  Emoji{"\xf0\x9f\x92\x92", ":wedding:"},
+  Emoji{"\xf0\x9f\x97\xbc", ":tokyo_tower:"},
+  Emoji{"\xf0\x9f\x97\xbd", ":statue_of_liberty:"},
+  Emoji{"\xe2\x9b\xaa", ":church:"},
+  Emoji{"\xf0\x9f\x95\x8c", ":mosque:"},
+  Emoji{"\xf0\x9f\x95\x8d", ":synagogue:"},
+  Emoji{"\xe2\x9b\xa9", ":shinto_shrine:"},
+  Emoji{"\xf0\x9f\x95\x8b", ":kaaba:"},
+  Emoji{"\xe2\x9b\xb2", ":fountain:"},
+  Emoji{"\xe2\x9b\xba", ":tent:"},
+  Emoji{"\xf0\x9f\x8c\x81", ":foggy:"},
+  Emoji{"\xf0\x9f\x8c\x83", ":night_with_stars:"},
+  Emoji{"\xf0\x9f\x8c\x84", ":sunrise_over_mountains:"},
+  Emoji{"\xf0\x9f\x8c\x85", ":sunrise:"},
+  Emoji{"\xf0\x9f\x8c\x86", ":city_dusk:"},
+  Emoji{"\xf0\x9f\x8c\x87", ":city_sunset:"},
+  Emoji{"\xf0\x9f\x8c\x89", ":bridge_at_night:"},
+  Emoji{"\xf0\x9f\x8c\x8c", ":milky_way:"},
+  Emoji{"\xf0\x9f\x8e\xa0", ":carousel_horse:"},
+  Emoji{"\xf0\x9f\x8e\xa1", ":ferris_wheel:"},
+  Emoji{"\xf0\x9f\x8e\xa2", ":roller_coaster:"},
+  Emoji{"\xf0\x9f\x9a\x82", ":steam_locomotive:"},
+  Emoji{"\xf0\x9f\x9a\x83", ":railway_car:"},
+  Emoji{"\xf0\x9f\x9a\x84", ":bullettrain_side:"},
+  Emoji{"\xf0\x9f\x9a\x85", ":bullettrain_front:"},
+  Emoji{"\xf0\x9f\x9a\x86", ":train2:"},
+  Emoji{"\xf0\x9f\x9a\x87", ":metro:"},
+  Emoji{"\xf0\x9f\x9a\x88", ":light_rail:"},
+  Emoji{"\xf0\x9f\x9a\x89", ":station:"},
+  Emoji{"\xf0\x9f\x9a\x8a", ":tram:"},
+  Emoji{"\xf0\x9f\x9a\x9d", ":monorail:"},
+  Emoji{"\xf0\x9f\x9a\x9e", ":mountain_railway:"},
+  Emoji{"\xf0\x9f\x9a\x8b", ":train:"},
+  Emoji{"\xf0\x9f\x9a\x8c", ":bus:"},
+  Emoji{"\xf0\x9f\x9a\x8d", ":oncoming_bus:"},
+  Emoji{"\xf0\x9f\x9a\x8e", ":trolleybus:"},
+  Emoji{"\xf0\x9f\x9a\x90", ":minibus:"},
+  Emoji{"\xf0\x9f\x9a\x91", ":ambulance:"},
+  Emoji{"\xf0\x9f\x9a\x92", ":fire_engine:"},
+  Emoji{"\xf0\x9f\x9a\x93", ":police_car:"},
+  Emoji{"\xf0\x9f\x9a\x94", ":oncoming_police_car:"},
+  Emoji{"\xf0\x9f\x9a\x95", ":taxi:"},
+  Emoji{"\xf0\x9f\x9a\x96", ":oncoming_taxi:"},
+  Emoji{"\xf0\x9f\x9a\x97", ":red_car:"},
+  Emoji{"\xf0\x9f\x9a\x98", ":oncoming_automobile:"},
+  Emoji{"\xf0\x9f\x9a\x99", ":blue_car:"},
+  Emoji{"\xf0\x9f\x9a\x9a", ":truck:"},
+  Emoji{"\xf0\x9f\x9a\x9b", ":articulated_lorry:"},
+  Emoji{"\xf0\x9f\x9a\x9c", ":tractor:"},
+  Emoji{"\xf0\x9f\x9a\xb2", ":bike:"},
+  Emoji{"\xf0\x9f\x9b\xb4", ":scooter:"},
+  Emoji{"\xf0\x9f\x9b\xb5", ":motor_scooter:"},
+  Emoji{"\xf0\x9f\x9a\x8f", ":busstop:"},
+  Emoji{"\xf0\x9f\x9b\xa3", ":motorway:"},
+  Emoji{"\xf0\x9f\x9b\xa4", ":railway_track:"},
+  Emoji{"\xe2\x9b\xbd", ":fuelpump:"},
+  Emoji{"\xf0\x9f\x9a\xa8", ":rotating_light:"},
+  Emoji{"\xf0\x9f\x9a\xa5", ":traffic_light:"},
+  Emoji{"\xf0\x9f\x9a\xa6", ":vertical_traffic_light:"},
+  Emoji{"\xf0\x9f\x9a\xa7", ":construction:"},
+  Emoji{"\xe2\x9a\x93", ":anchor:"},
+  Emoji{"\xe2\x9b\xb5", ":sailboat:"},
+  Emoji{"\xf0\x9f\x9b\xb6", ":canoe:"},
+  Emoji{"\xf0\x9f\x9a\xa4", ":speedboat:"},
+  Emoji{"\xf0\x9f\x9b\xb3", ":cruise_ship:"},
+  Emoji{"\xe2\x9b\xb4", ":ferry:"},
+  Emoji{"\xf0\x9f\x9b\xa5", ":motorboat:"},
+  Emoji{"\xf0\x9f\x9a\xa2", ":ship:"},
+  Emoji{"\xe2\x9c\x88", ":airplane:"},
+  Emoji{"\xf0\x9f\x9b\xa9", ":airplane_small:"},
+  Emoji{"\xf0\x9f\x9b\xab", ":airplane_departure:"},
+  Emoji{"\xf0\x9f\x9b\xac", ":airplane_arriving:"},
+  Emoji{"\xf0\x9f\x92\xba", ":seat:"},
+  Emoji{"\xf0\x9f\x9a\x81", ":helicopter:"},
+  Emoji{"\xf0\x9f\x9a\x9f", ":suspension_railway:"},
+  Emoji{"\xf0\x9f\x9a\xa0", ":mountain_cableway:"},
+  Emoji{"\xf0\x9f\x9a\xa1", ":aerial_tramway:"},
+  Emoji{"\xf0\x9f\x9a\x80", ":rocket:"},
+  Emoji{"\xf0\x9f\x9b\xb0", ":satellite_orbital:"},
+  Emoji{"\xf0\x9f\x8c\xa0", ":stars:"},
+  Emoji{"\xf0\x9f\x8c\x88", ":rainbow:"},
+  Emoji{"\xf0\x9f\x8e\x86", ":fireworks:"},
+  Emoji{"\xf0\x9f\x8e\x87", ":sparkler:"},
+  Emoji{"\xf0\x9f\x8e\x91", ":rice_scene:"},
+  Emoji{"\xf0\x9f\x8f\x81", ":checkered_flag:"},
+  Emoji{"\xe2\x98\xa0", ":skull_crossbones:"},
+  Emoji{"\xf0\x9f\x92\x8c", ":love_letter:"},
+  Emoji{"\xf0\x9f\x92\xa3", ":bomb:"},
+  Emoji{"\xf0\x9f\x95\xb3", ":hole:"},
+  Emoji{"\xf0\x9f\x9b\x8d", ":shopping_bags:"},
+  Emoji{"\xf0\x9f\x93\xbf", ":prayer_beads:"},
+  Emoji{"\xf0\x9f\x92\x8e", ":gem:"},
+  Emoji{"\xf0\x9f\x94\xaa", ":knife:"},
+  Emoji{"\xf0\x9f\x8f\xba", ":amphora:"},
+  Emoji{"\xf0\x9f\x97\xba", ":map:"},
+  Emoji{"\xf0\x9f\x92\x88", ":barber:"},
+  Emoji{"\xf0\x9f\x96\xbc", ":frame_photo:"},
+  Emoji{"\xf0\x9f\x9b\x8e", ":bellhop:"},
+  Emoji{"\xf0\x9f\x9a\xaa", ":door:"},
+  Emoji{"\xf0\x9f\x9b\x8c", ":sleeping_accommodation:"},
+  Emoji{"\xf0\x9f\x9b\x8f", ":bed:"},
+  Emoji{"\xf0\x9f\x9b\x8b", ":couch:"},
+  Emoji{"\xf0\x9f\x9a\xbd", ":toilet:"},
+  Emoji{"\xf0\x9f\x9a\xbf", ":shower:"},
+  Emoji{"\xf0\x9f\x9b\x81", ":bathtub:"},
+  Emoji{"\xe2\x8c\x9b", ":hourglass:"},
+  Emoji{"\xe2\x8f\xb3", ":hourglass_flowing_sand:"},
+  Emoji{"\xe2\x8c\x9a", ":watch:"},
+  Emoji{"\xe2\x8f\xb0", ":alarm_clock:"},
+  Emoji{"\xe2\x8f\xb1", ":stopwatch:"},
+  Emoji{"\xe2\x8f\xb2", ":timer:"},
+  Emoji{"\xf0\x9f\x95\xb0", ":clock:"},
+  Emoji{"\xf0\x9f\x8c\xa1", ":thermometer:"},
+  Emoji{"\xe2\x9b\xb1", ":beach_umbrella:"},
+  Emoji{"\xf0\x9f\x8e\x88", ":balloon:"},
+  Emoji{"\xf0\x9f\x8e\x89", ":tada:"},
+  Emoji{"\xf0\x9f\x8e\x8a", ":confetti_ball:"},
+  Emoji{"\xf0\x9f\x8e\x8e", ":dolls:"},
+  Emoji{"\xf0\x9f\x8e\x8f", ":flags:"},
+  Emoji{"\xf0\x9f\x8e\x90", ":wind_chime:"},
+  Emoji{"\xf0\x9f\x8e\x80", ":ribbon:"},
+  Emoji{"\xf0\x9f\x8e\x81", ":gift:"},
+  Emoji{"\xf0\x9f\x95\xb9", ":joystick:"},
+  Emoji{"\xf0\x9f\x93\xaf", ":postal_horn:"},
+  Emoji{"\xf0\x9f\x8e\x99", ":microphone2:"},
+  Emoji{"\xf0\x9f\x8e\x9a", ":level_slider:"},
+  Emoji{"\xf0\x9f\x8e\x9b", ":control_knobs:"},
+  Emoji{"\xf0\x9f\x93\xbb", ":radio:"},
+  Emoji{"\xf0\x9f\x93\xb1", ":iphone:"},
+  Emoji{"\xf0\x9f\x93\xb2", ":calling:"},
+  Emoji{"\xe2\x98\x8e", ":telephone:"},
+  Emoji{"\xf0\x9f\x93\x9e", ":telephone_receiver:"},
+  Emoji{"\xf0\x9f\x93\x9f", ":pager:"},
+  Emoji{"\xf0\x9f\x93\xa0", ":fax:"},
+  Emoji{"\xf0\x9f\x94\x8b", ":battery:"},
+  Emoji{"\xf0\x9f\x94\x8c", ":electric_plug:"},
+  Emoji{"\xf0\x9f\x92\xbb", ":computer:"},
+  Emoji{"\xf0\x9f\x96\xa5", ":desktop:"},
+  Emoji{"\xf0\x9f\x96\xa8", ":printer:"},
+  Emoji{"\xe2\x8c\xa8", ":keyboard:"},
+  Emoji{"\xf0\x9f\x96\xb1", ":mouse_three_button:"},
+  Emoji{"\xf0\x9f\x96\xb2", ":trackball:"},
+  Emoji{"\xf0\x9f\x92\xbd", ":minidisc:"},
+  Emoji{"\xf0\x9f\x92\xbe", ":floppy_disk:"},
+  Emoji{"\xf0\x9f\x92\xbf", ":cd:"},
+  Emoji{"\xf0\x9f\x93\x80", ":dvd:"},
+  Emoji{"\xf0\x9f\x8e\xa5", ":movie_camera:"},
+  Emoji{"\xf0\x9f\x8e\x9e", ":film_frames:"},
+  Emoji{"\xf0\x9f\x93\xbd", ":projector:"},
+  Emoji{"\xf0\x9f\x93\xba", ":tv:"},
+  Emoji{"\xf0\x9f\x93\xb7", ":camera:"},
+  Emoji{"\xf0\x9f\x93\xb8", ":camera_with_flash:"},
+  Emoji{"\xf0\x9f\x93\xb9", ":video_camera:"},
+  Emoji{"\xf0\x9f\x93\xbc", ":vhs:"},
+  Emoji{"\xf0\x9f\x94\x8d", ":mag:"},
+  Emoji{"\xf0\x9f\x94\x8e", ":mag_right:"},
+  Emoji{"\xf0\x9f\x94\xac", ":microscope:"},
+  Emoji{"\xf0\x9f\x94\xad", ":telescope:"},
+  Emoji{"\xf0\x9f\x93\xa1", ":satellite:"},
+  Emoji{"\xf0\x9f\x95\xaf", ":candle:"},
+  Emoji{"\xf0\x9f\x92\xa1", ":bulb:"},
+  Emoji{"\xf0\x9f\x94\xa6", ":flashlight:"},
+  Emoji{"\xf0\x9f\x8f\xae", ":izakaya_lantern:"},
+  Emoji{"\xf0\x9f\x93\x94", ":notebook_with_decorative_cover:"},
+  Emoji{"\xf0\x9f\x93\x95", ":closed_book:"},
+  Emoji{"\xf0\x9f\x93\x96", ":book:"},
+  Emoji{"\xf0\x9f\x93\x97", ":green_book:"},
+  Emoji{"\xf0\x9f\x93\x98", ":blue_book:"},
+  Emoji{"\xf0\x9f\x93\x99", ":orange_book:"},
+  Emoji{"\xf0\x9f\x93\x9a", ":books:"},
+  Emoji{"\xf0\x9f\x93\x93", ":notebook:"},
+  Emoji{"\xf0\x9f\x93\x92", ":ledger:"},
+  Emoji{"\xf0\x9f\x93\x83", ":page_with_curl:"},
+  Emoji{"\xf0\x9f\x93\x9c", ":scroll:"},
+  Emoji{"\xf0\x9f\x93\x84", ":page_facing_up:"},
+  Emoji{"\xf0\x9f\x93\xb0", ":newspaper:"},
+  Emoji{"\xf0\x9f\x97\x9e", ":newspaper2:"},
+  Emoji{"\xf0\x9f\x93\x91", ":bookmark_tabs:"},
+  Emoji{"\xf0\x9f\x94\x96", ":bookmark:"},
+  Emoji{"\xf0\x9f\x8f\xb7", ":label:"},
+  Emoji{"\xf0\x9f\x92\xb0", ":moneybag:"},
+  Emoji{"\xf0\x9f\x92\xb4", ":yen:"},
+  Emoji{"\xf0\x9f\x92\xb5", ":dollar:"},
+  Emoji{"\xf0\x9f\x92\xb6", ":euro:"},
+  Emoji{"\xf0\x9f\x92\xb7", ":pound:"},
+  Emoji{"\xf0\x9f\x92\xb8", ":money_with_wings:"},
+  Emoji{"\xf0\x9f\x92\xb3", ":credit_card:"},
+  Emoji{"\xe2\x9c\x89", ":envelope:"},
+  Emoji{"\xf0\x9f\x93\xa7", ":e-mail:"},
+  Emoji{"\xf0\x9f\x93\xa8", ":incoming_envelope:"},
+  Emoji{"\xf0\x9f\x93\xa9", ":envelope_with_arrow:"},
+  Emoji{"\xf0\x9f\x93\xa4", ":outbox_tray:"},
+  Emoji{"\xf0\x9f\x93\xa5", ":inbox_tray:"},
+  Emoji{"\xf0\x9f\x93\xa6", ":package:"},
+  Emoji{"\xf0\x9f\x93\xab", ":mailbox:"},
+  Emoji{"\xf0\x9f\x93\xaa", ":mailbox_closed:"},
+  Emoji{"\xf0\x9f\x93\xac", ":mailbox_with_mail:"},
+  Emoji{"\xf0\x9f\x93\xad", ":mailbox_with_no_mail:"},
+  Emoji{"\xf0\x9f\x93\xae", ":postbox:"},
+  Emoji{"\xf0\x9f\x97\xb3", ":ballot_box:"},
+  Emoji{"\xe2\x9c\x8f", ":pencil2:"},
+  Emoji{"\xe2\x9c\x92", ":black_nib:"},
+  Emoji{"\xf0\x9f\x96\x8b", ":pen_fountain:"},
+  Emoji{"\xf0\x9f\x96\x8a", ":pen_ballpoint:"},
+  Emoji{"\xf0\x9f\x96\x8c", ":paintbrush:"},
+  Emoji{"\xf0\x9f\x96\x8d", ":crayon:"},
+  Emoji{"\xf0\x9f\x93\x9d", ":pencil:"},
+  Emoji{"\xf0\x9f\x93\x81", ":file_folder:"},
+  Emoji{"\xf0\x9f\x93\x82", ":open_file_folder:"},
+  Emoji{"\xf0\x9f\x97\x82", ":dividers:"},
+  Emoji{"\xf0\x9f\x93\x85", ":date:"},
+  Emoji{"\xf0\x9f\x93\x86", ":calendar:"},
+  Emoji{"\xf0\x9f\x97\x92", ":notepad_spiral:"},
+  Emoji{"\xf0\x9f\x97\x93", ":calendar_spiral:"},
+  Emoji{"\xf0\x9f\x93\x87", ":card_index:"},
+  Emoji{"\xf0\x9f\x93\x88", ":chart_with_upwards_trend:"},
+  Emoji{"\xf0\x9f\x93\x89", ":chart_with_downwards_trend:"},
+  Emoji{"\xf0\x9f\x93\x8a", ":bar_chart:"},
+  Emoji{"\xf0\x9f\x93\x8b", ":clipboard:"},
+  Emoji{"\xf0\x9f\x93\x8c", ":pushpin:"},
+  Emoji{"\xf0\x9f\x93\x8d", ":round_pushpin:"},
+  Emoji{"\xf0\x9f\x93\x8e", ":paperclip:"},
+  Emoji{"\xf0\x9f\x96\x87", ":paperclips:"},
+  Emoji{"\xf0\x9f\x93\x8f", ":straight_ruler:"},
+  Emoji{"\xf0\x9f\x93\x90", ":triangular_ruler:"},
+  Emoji{"\xe2\x9c\x82", ":scissors:"},
+  Emoji{"\xf0\x9f\x97\x83", ":card_box:"},
+  Emoji{"\xf0\x9f\x97\x84", ":file_cabinet:"},
+  Emoji{"\xf0\x9f\x97\x91", ":wastebasket:"},
+  Emoji{"\xf0\x9f\x94\x92", ":lock:"},
+  Emoji{"\xf0\x9f\x94\x93", ":unlock:"},
+  Emoji{"\xf0\x9f\x94\x8f", ":lock_with_ink_pen:"},
+  Emoji{"\xf0\x9f\x94\x90", ":closed_lock_with_key:"},
+  Emoji{"\xf0\x9f\x94\x91", ":key:"},
+  Emoji{"\xf0\x9f\x97\x9d", ":key2:"},
+  Emoji{"\xf0\x9f\x94\xa8", ":hammer:"},
+  Emoji{"\xe2\x9b\x8f", ":pick:"},
+  Emoji{"\xe2\x9a\x92", ":hammer_pick:"},
+  Emoji{"\xf0\x9f\x9b\xa0", ":tools:"},
+  Emoji{"\xf0\x9f\x97\xa1", ":dagger:"},
+  Emoji{"\xe2\x9a\x94", ":crossed_swords:"},
+  Emoji{"\xf0\x9f\x94\xab", ":gun:"},
+  Emoji{"\xf0\x9f\x9b\xa1", ":shield:"},
+  Emoji{"\xf0\x9f\x94\xa7", ":wrench:"},
+  Emoji{"\xf0\x9f\x94\xa9", ":nut_and_bolt:"},
+  Emoji{"\xe2\x9a\x99", ":gear:"},
+  Emoji{"\xf0\x9f\x97\x9c", ":compression:"},
+  Emoji{"\xe2\x9a\x97", ":alembic:"},
+  Emoji{"\xe2\x9a\x96", ":scales:"},
+  Emoji{"\xf0\x9f\x94\x97", ":link:"},
+  Emoji{"\xe2\x9b\x93", ":chains:"},
+  Emoji{"\xf0\x9f\x92\x89", ":syringe:"},
+  Emoji{"\xf0\x9f\x92\x8a", ":pill:"},
+  Emoji{"\xf0\x9f\x9a\xac", ":smoking:"},
+  Emoji{"\xe2\x9a\xb0", ":coffin:"},
+  Emoji{"\xe2\x9a\xb1", ":urn:"},
+  Emoji{"\xf0\x9f\x97\xbf", ":moyai:"},
+  Emoji{"\xf0\x9f\x9b\xa2", ":oil:"},
+  Emoji{"\xf0\x9f\x94\xae", ":crystal_ball:"},
+  Emoji{"\xf0\x9f\x9b\x92", ":shopping_cart:"},
+  Emoji{"\xf0\x9f\x9a\xa9", ":triangular_flag_on_post:"},
+  Emoji{"\xf0\x9f\x8e\x8c", ":crossed_flags:"},
+  Emoji{"\xf0\x9f\x8f\xb4", ":flag_black:"},
+  Emoji{"\xf0\x9f\x8f\xb3", ":flag_white:"},
+  Emoji{"\xf0\x9f\x8f\xb3\xf0\x9f\x8c\x88", ":rainbow_flag:"},
+  Emoji{"\xf0\x9f\x91\x81\xf0\x9f\x97\xa8", ":eye_in_speech_bubble:"},
+  Emoji{"\xf0\x9f\x92\x98", ":cupid:"},
+  Emoji{"\xe2\x9d\xa4", ":heart:"},
+  Emoji{"\xf0\x9f\x92\x93", ":heartbeat:"},
+  Emoji{"\xf0\x9f\x92\x94", ":broken_heart:"},
+  Emoji{"\xf0\x9f\x92\x95", ":two_hearts:"},
+  Emoji{"\xf0\x9f\x92\x96", ":sparkling_heart:"},
+  Emoji{"\xf0\x9f\x92\x97", ":heartpulse:"},
+  Emoji{"\xf0\x9f\x92\x99", ":blue_heart:"},
+  Emoji{"\xf0\x9f\x92\x9a", ":green_heart:"},
+  Emoji{"\xf0\x9f\x92\x9b", ":yellow_heart:"},
+  Emoji{"\xf0\x9f\x92\x9c", ":purple_heart:"},
+  Emoji{"\xf0\x9f\x96\xa4", ":black_heart:"},
+  Emoji{"\xf0\x9f\x92\x9d", ":gift_heart:"},
+  Emoji{"\xf0\x9f\x92\x9e", ":revolving_hearts:"},
+  Emoji{"\xf0\x9f\x92\x9f", ":heart_decoration:"},
+  Emoji{"\xe2\x9d\xa3", ":heart_exclamation:"},
+  Emoji{"\xf0\x9f\x92\xa2", ":anger:"},
+  Emoji{"\xf0\x9f\x92\xa5", ":boom:"},
+  Emoji{"\xf0\x9f\x92\xab", ":dizzy:"},
+  Emoji{"\xf0\x9f\x92\xac", ":speech_balloon:"},
+  Emoji{"\xf0\x9f\x97\xa8", ":speech_left:"},
+  Emoji{"\xf0\x9f\x97\xaf", ":anger_right:"},
+  Emoji{"\xf0\x9f\x92\xad", ":thought_balloon:"},
+  Emoji{"\xf0\x9f\x92\xae", ":white_flower:"},
+  Emoji{"\xf0\x9f\x8c\x90", ":globe_with_meridians:"},
+  Emoji{"\xe2\x99\xa8", ":hotsprings:"},
+  Emoji{"\xf0\x9f\x9b\x91", ":octagonal_sign:"},
+  Emoji{"\xf0\x9f\x95\x9b", ":clock12:"},
+  Emoji{"\xf0\x9f\x95\xa7", ":clock1230:"},
+  Emoji{"\xf0\x9f\x95\x90", ":clock1:"},
+  Emoji{"\xf0\x9f\x95\x9c", ":clock130:"},
+  Emoji{"\xf0\x9f\x95\x91", ":clock2:"},
+  Emoji{"\xf0\x9f\x95\x9d", ":clock230:"},
+  Emoji{"\xf0\x9f\x95\x92", ":clock3:"},
+  Emoji{"\xf0\x9f\x95\x9e", ":clock330:"},
+  Emoji{"\xf0\x9f\x95\x93", ":clock4:"},
+  Emoji{"\xf0\x9f\x95\x9f", ":clock430:"},
+  Emoji{"\xf0\x9f\x95\x94", ":clock5:"},
+  Emoji{"\xf0\x9f\x95\xa0", ":clock530:"},
+  Emoji{"\xf0\x9f\x95\x95", ":clock6:"},
+  Emoji{"\xf0\x9f\x95\xa1", ":clock630:"},
+  Emoji{"\xf0\x9f\x95\x96", ":clock7:"},
+  Emoji{"\xf0\x9f\x95\xa2", ":clock730:"},
+  Emoji{"\xf0\x9f\x95\x97", ":clock8:"},
+  Emoji{"\xf0\x9f\x95\xa3", ":clock830:"},
+  Emoji{"\xf0\x9f\x95\x98", ":clock9:"},
+  Emoji{"\xf0\x9f\x95\xa4", ":clock930:"},
+  Emoji{"\xf0\x9f\x95\x99", ":clock10:"},
+  Emoji{"\xf0\x9f\x95\xa5", ":clock1030:"},
+  Emoji{"\xf0\x9f\x95\x9a", ":clock11:"},
+  Emoji{"\xf0\x9f\x95\xa6", ":clock1130:"},
+  Emoji{"\xf0\x9f\x8c\x80", ":cyclone:"},
+  Emoji{"\xe2\x99\xa0", ":spades:"},
+  Emoji{"\xe2\x99\xa5", ":hearts:"},
+  Emoji{"\xe2\x99\xa6", ":diamonds:"},
+  Emoji{"\xe2\x99\xa3", ":clubs:"},
+  Emoji{"\xf0\x9f\x83\x8f", ":black_joker:"},
+  Emoji{"\xf0\x9f\x80\x84", ":mahjong:"},
+  Emoji{"\xf0\x9f\x8e\xb4", ":flower_playing_cards:"},
+  Emoji{"\xf0\x9f\x94\x87", ":mute:"},
+  Emoji{"\xf0\x9f\x94\x88", ":speaker:"},
+  Emoji{"\xf0\x9f\x94\x89", ":sound:"},
+  Emoji{"\xf0\x9f\x94\x8a", ":loud_sound:"},
+  Emoji{"\xf0\x9f\x93\xa2", ":loudspeaker:"},
+  Emoji{"\xf0\x9f\x93\xa3", ":mega:"},
+  Emoji{"\xf0\x9f\x94\x94", ":bell:"},
+  Emoji{"\xf0\x9f\x94\x95", ":no_bell:"},
+  Emoji{"\xf0\x9f\x8e\xb5", ":musical_note:"},
+  Emoji{"\xf0\x9f\x8e\xb6", ":notes:"},
+  Emoji{"\xf0\x9f\x92\xb9", ":chart:"},
+  Emoji{"\xf0\x9f\x92\xb1", ":currency_exchange:"},
+  Emoji{"\xf0\x9f\x92\xb2", ":heavy_dollar_sign:"},
+  Emoji{"\xf0\x9f\x8f\xa7", ":atm:"},
+  Emoji{"\xf0\x9f\x9a\xae", ":put_litter_in_its_place:"},
+  Emoji{"\xf0\x9f\x9a\xb0", ":potable_water:"},
+  Emoji{"\xe2\x99\xbf", ":wheelchair:"},
+  Emoji{"\xf0\x9f\x9a\xb9", ":mens:"},
+  Emoji{"\xf0\x9f\x9a\xba", ":womens:"},
+  Emoji{"\xf0\x9f\x9a\xbb", ":restroom:"},
+  Emoji{"\xf0\x9f\x9a\xbc", ":baby_symbol:"},
+  Emoji{"\xf0\x9f\x9a\xbe", ":wc:"},
+  Emoji{"\xf0\x9f\x9b\x82", ":passport_control:"},
+  Emoji{"\xf0\x9f\x9b\x83", ":customs:"},
+  Emoji{"\xf0\x9f\x9b\x84", ":baggage_claim:"},
+  Emoji{"\xf0\x9f\x9b\x85", ":left_luggage:"},
+  Emoji{"\xe2\x9a\xa0", ":warning:"},
+  Emoji{"\xf0\x9f\x9a\xb8", ":children_crossing:"},
+  Emoji{"\xe2\x9b\x94", ":no_entry:"},
+  Emoji{"\xf0\x9f\x9a\xab", ":no_entry_sign:"},
+  Emoji{"\xf0\x9f\x9a\xb3", ":no_bicycles:"},
+  Emoji{"\xf0\x9f\x9a\xad", ":no_smoking:"},
+  Emoji{"\xf0\x9f\x9a\xaf", ":do_not_litter:"},
+  Emoji{"\xf0\x9f\x9a\xb1", ":non-potable_water:"},
+  Emoji{"\xf0\x9f\x9a\xb7", ":no_pedestrians:"},
+  Emoji{"\xf0\x9f\x93\xb5", ":no_mobile_phones:"},
+  Emoji{"\xf0\x9f\x94\x9e", ":underage:"},
+  Emoji{"\xe2\x98\xa2", ":radioactive:"},
+  Emoji{"\xe2\x98\xa3", ":biohazard:"},
+  Emoji{"\xe2\xac\x86", ":arrow_up:"},
+  Emoji{"\xe2\x86\x97", ":arrow_upper_right:"},
+  Emoji{"\xe2\x9e\xa1", ":arrow_right:"},
+  Emoji{"\xe2\x86\x98", ":arrow_lower_right:"},
+  Emoji{"\xe2\xac\x87", ":arrow_down:"},
+  Emoji{"\xe2\x86\x99", ":arrow_lower_left:"},
+  Emoji{"\xe2\xac\x85", ":arrow_left:"},
+  Emoji{"\xe2\x86\x96", ":arrow_upper_left:"},
+  Emoji{"\xe2\x86\x95", ":arrow_up_down:"},
+  Emoji{"\xe2\x86\x94", ":left_right_arrow:"},
+  Emoji{"\xe2\x86\xa9", ":leftwards_arrow_with_hook:"},
+  Emoji{"\xe2\x86\xaa", ":arrow_right_hook:"},
+  Emoji{"\xe2\xa4\xb4", ":arrow_heading_up:"},
+  Emoji{"\xe2\xa4\xb5", ":arrow_heading_down:"},
+  Emoji{"\xf0\x9f\x94\x83", ":arrows_clockwise:"},
+  Emoji{"\xf0\x9f\x94\x84", ":arrows_counterclockwise:"},
+  Emoji{"\xf0\x9f\x94\x99", ":back:"},
+  Emoji{"\xf0\x9f\x94\x9a", ":end:"},
+  Emoji{"\xf0\x9f\x94\x9b", ":on:"},
+  Emoji{"\xf0\x9f\x94\x9c", ":soon:"},
+  Emoji{"\xf0\x9f\x94\x9d", ":top:"},
+  Emoji{"\xf0\x9f\x9b\x90", ":place_of_worship:"},
+  Emoji{"\xe2\x9a\x9b", ":atom:"},
+  Emoji{"\xf0\x9f\x95\x89", ":om_symbol:"},
+  Emoji{"\xe2\x9c\xa1", ":star_of_david:"},
+  Emoji{"\xe2\x98\xb8", ":wheel_of_dharma:"},
+  Emoji{"\xe2\x98\xaf", ":yin_yang:"},
+  Emoji{"\xe2\x9c\x9d", ":cross:"},
+  Emoji{"\xe2\x98\xa6", ":orthodox_cross:"},
+  Emoji{"\xe2\x98\xaa", ":star_and_crescent:"},
+  Emoji{"\xe2\x98\xae", ":peace:"},
+  Emoji{"\xf0\x9f\x95\x8e", ":menorah:"},
+  Emoji{"\xf0\x9f\x94\xaf", ":six_pointed_star:"},
+  Emoji{"\xe2\x99\x88", ":aries:"},
+  Emoji{"\xe2\x99\x89", ":taurus:"},
+  Emoji{"\xe2\x99\x8a", ":gemini:"},
+  Emoji{"\xe2\x99\x8b", ":cancer:"},
+  Emoji{"\xe2\x99\x8c", ":leo:"},
+  Emoji{"\xe2\x99\x8d", ":virgo:"},
+  Emoji{"\xe2\x99\x8e", ":libra:"},
+  Emoji{"\xe2\x99\x8f", ":scorpius:"},
+  Emoji{"\xe2\x99\x90", ":sagittarius:"},
+  Emoji{"\xe2\x99\x91", ":capricorn:"},
+  Emoji{"\xe2\x99\x92", ":aquarius:"},
+  Emoji{"\xe2\x99\x93", ":pisces:"},
+  Emoji{"\xe2\x9b\x8e", ":ophiuchus:"},
+  Emoji{"\xf0\x9f\x94\x80", ":twisted_rightwards_arrows:"},
+  Emoji{"\xf0\x9f\x94\x81", ":repeat:"},
+  Emoji{"\xf0\x9f\x94\x82", ":repeat_one:"},
+  Emoji{"\xe2\x96\xb6", ":arrow_forward:"},
+  Emoji{"\xe2\x8f\xa9", ":fast_forward:"},
+  Emoji{"\xe2\x8f\xad", ":track_next:"},
+  Emoji{"\xe2\x8f\xaf", ":play_pause:"},
+  Emoji{"\xe2\x97\x80", ":arrow_backward:"},
+  Emoji{"\xe2\x8f\xaa", ":rewind:"},
+  Emoji{"\xe2\x8f\xae", ":track_previous:"},
+  Emoji{"\xf0\x9f\x94\xbc", ":arrow_up_small:"},
+  Emoji{"\xe2\x8f\xab", ":arrow_double_up:"},
+  Emoji{"\xf0\x9f\x94\xbd", ":arrow_down_small:"},
+  Emoji{"\xe2\x8f\xac", ":arrow_double_down:"},
+  Emoji{"\xe2\x8f\xb8", ":pause_button:"},
+  Emoji{"\xe2\x8f\xb9", ":stop_button:"},
+  Emoji{"\xe2\x8f\xba", ":record_button:"},
+  Emoji{"\xe2\x8f\x8f", ":eject:"},
+  Emoji{"\xf0\x9f\x8e\xa6", ":cinema:"},
+  Emoji{"\xf0\x9f\x94\x85", ":low_brightness:"},
+  Emoji{"\xf0\x9f\x94\x86", ":high_brightness:"},
+  Emoji{"\xf0\x9f\x93\xb6", ":signal_strength:"},
+  Emoji{"\xf0\x9f\x93\xb3", ":vibration_mode:"},
+  Emoji{"\xf0\x9f\x93\xb4", ":mobile_phone_off:"},
+  Emoji{"\xe2\x99\xbb", ":recycle:"},
+  Emoji{"\xf0\x9f\x93\x9b", ":name_badge:"},
+  Emoji{"\xe2\x9a\x9c", ":fleur-de-lis:"},
+  Emoji{"\xf0\x9f\x94\xb0", ":beginner:"},
+  Emoji{"\xf0\x9f\x94\xb1", ":trident:"},
+  Emoji{"\xe2\xad\x95", ":o:"},
+  Emoji{"\xe2\x9c\x85", ":white_check_mark:"},
+  Emoji{"\xe2\x98\x91", ":ballot_box_with_check:"},
+  Emoji{"\xe2\x9c\x94", ":heavy_check_mark:"},
+  Emoji{"\xe2\x9c\x96", ":heavy_multiplication_x:"},
+  Emoji{"\xe2\x9d\x8c", ":x:"},
+  Emoji{"\xe2\x9d\x8e", ":negative_squared_cross_mark:"},
+  Emoji{"\xe2\x9e\x95", ":heavy_plus_sign:"},
+  Emoji{"\xe2\x9e\x96", ":heavy_minus_sign:"},
+  Emoji{"\xe2\x9e\x97", ":heavy_division_sign:"},
+  Emoji{"\xe2\x9e\xb0", ":curly_loop:"},
+  Emoji{"\xe2\x9e\xbf", ":loop:"},
+  Emoji{"\xe3\x80\xbd", ":part_alternation_mark:"},
+  Emoji{"\xe2\x9c\xb3", ":eight_spoked_asterisk:"},
+  Emoji{"\xe2\x9c\xb4", ":eight_pointed_black_star:"},
+  Emoji{"\xe2\x9d\x87", ":sparkle:"},
+  Emoji{"\xe2\x80\xbc", ":bangbang:"},
+  Emoji{"\xe2\x81\x89", ":interrobang:"},
+  Emoji{"\xe2\x9d\x93", ":question:"},
+  Emoji{"\xe2\x9d\x94", ":grey_question:"},
+  Emoji{"\xe2\x9d\x95", ":grey_exclamation:"},
+  Emoji{"\xe2\x9d\x97", ":exclamation:"},
+  Emoji{"\xe3\x80\xb0", ":wavy_dash:"},
+  Emoji{"\xc2\xa9", ":copyright:"},
+  Emoji{"\xc2\xae", ":registered:"},
+  Emoji{"\xe2\x84\xa2", ":tm:"},
+  Emoji{"\x23\xe2\x83\xa3", ":hash:"},
+  Emoji{"\x2a\xe2\x83\xa3", ":asterisk:"},
+  Emoji{"\x30\xe2\x83\xa3", ":zero:"},
+  Emoji{"\x31\xe2\x83\xa3", ":one:"},
+  Emoji{"\x32\xe2\x83\xa3", ":two:"},
+  Emoji{"\x33\xe2\x83\xa3", ":three:"},
+  Emoji{"\x34\xe2\x83\xa3", ":four:"},
+  Emoji{"\x35\xe2\x83\xa3", ":five:"},
+  Emoji{"\x36\xe2\x83\xa3", ":six:"},
+  Emoji{"\x37\xe2\x83\xa3", ":seven:"},
+  Emoji{"\x38\xe2\x83\xa3", ":eight:"},
+  Emoji{"\x39\xe2\x83\xa3", ":nine:"},
+  Emoji{"\xf0\x9f\x94\x9f", ":keycap_ten:"},
+  Emoji{"\xf0\x9f\x92\xaf", ":100:"},
+  Emoji{"\xf0\x9f\x94\xa0", ":capital_abcd:"},
+  Emoji{"\xf0\x9f\x94\xa1", ":abcd:"},
+  Emoji{"\xf0\x9f\x94\xa2", ":1234:"},
+  Emoji{"\xf0\x9f\x94\xa3", ":symbols:"},
+  Emoji{"\xf0\x9f\x94\xa4", ":abc:"},
+  Emoji{"\xf0\x9f\x85\xb0", ":a:"},
+  Emoji{"\xf0\x9f\x86\x8e", ":ab:"},
+  Emoji{"\xf0\x9f\x85\xb1", ":b:"},
+  Emoji{"\xf0\x9f\x86\x91", ":cl:"},
+  Emoji{"\xf0\x9f\x86\x92", ":cool:"},
+  Emoji{"\xf0\x9f\x86\x93", ":free:"},
+  Emoji{"\xe2\x84\xb9", ":information_source:"},
+  Emoji{"\xf0\x9f\x86\x94", ":id:"},
+  Emoji{"\xe2\x93\x82", ":m:"},
+  Emoji{"\xf0\x9f\x86\x95", ":new:"},
+  Emoji{"\xf0\x9f\x86\x96", ":ng:"},
+  Emoji{"\xf0\x9f\x85\xbe", ":o2:"},
+  Emoji{"\xf0\x9f\x86\x97", ":ok:"},
+  Emoji{"\xf0\x9f\x85\xbf", ":parking:"},
+  Emoji{"\xf0\x9f\x86\x98", ":sos:"},
+  Emoji{"\xf0\x9f\x86\x99", ":up:"},
+  Emoji{"\xf0\x9f\x86\x9a", ":vs:"},
+  Emoji{"\xf0\x9f\x88\x81", ":koko:"},
+  Emoji{"\xf0\x9f\x88\x82", ":sa:"},
+  Emoji{"\xf0\x9f\x88\xb7", ":u6708:"},
+  Emoji{"\xf0\x9f\x88\xb6", ":u6709:"},
+  Emoji{"\xf0\x9f\x88\xaf", ":u6307:"},
+  Emoji{"\xf0\x9f\x89\x90", ":ideograph_advantage:"},
+  Emoji{"\xf0\x9f\x88\xb9", ":u5272:"},
+  Emoji{"\xf0\x9f\x88\x9a", ":u7121:"},
+  Emoji{"\xf0\x9f\x88\xb2", ":u7981:"},
+  Emoji{"\xf0\x9f\x89\x91", ":accept:"},
+  Emoji{"\xf0\x9f\x88\xb8", ":u7533:"},
+  Emoji{"\xf0\x9f\x88\xb4", ":u5408:"},
+  Emoji{"\xf0\x9f\x88\xb3", ":u7a7a:"},
+  Emoji{"\xe3\x8a\x97", ":congratulations:"},
+  Emoji{"\xe3\x8a\x99", ":secret:"},
+  Emoji{"\xf0\x9f\x88\xba", ":u55b6:"},
+  Emoji{"\xf0\x9f\x88\xb5", ":u6e80:"},
+  Emoji{"\xe2\x96\xaa", ":black_small_square:"},
+  Emoji{"\xe2\x96\xab", ":white_small_square:"},
+  Emoji{"\xe2\x97\xbb", ":white_medium_square:"},
+  Emoji{"\xe2\x97\xbc", ":black_medium_square:"},
+  Emoji{"\xe2\x97\xbd", ":white_medium_small_square:"},
+  Emoji{"\xe2\x97\xbe", ":black_medium_small_square:"},
+  Emoji{"\xe2\xac\x9b", ":black_large_square:"},
+  Emoji{"\xe2\xac\x9c", ":white_large_square:"},
+  Emoji{"\xf0\x9f\x94\xb6", ":large_orange_diamond:"},
+  Emoji{"\xf0\x9f\x94\xb7", ":large_blue_diamond:"},
+  Emoji{"\xf0\x9f\x94\xb8", ":small_orange_diamond:"},
+  Emoji{"\xf0\x9f\x94\xb9", ":small_blue_diamond:"},
+  Emoji{"\xf0\x9f\x94\xba", ":small_red_triangle:"},
+  Emoji{"\xf0\x9f\x94\xbb", ":small_red_triangle_down:"},
+  Emoji{"\xf0\x9f\x92\xa0", ":diamond_shape_with_a_dot_inside:"},
+  Emoji{"\xf0\x9f\x94\x98", ":radio_button:"},
+  Emoji{"\xf0\x9f\x94\xb2", ":black_square_button:"},
+  Emoji{"\xf0\x9f\x94\xb3", ":white_square_button:"},
+  Emoji{"\xe2\x9a\xaa", ":white_circle:"},
+  Emoji{"\xe2\x9a\xab", ":black_circle:"},
+  Emoji{"\xf0\x9f\x94\xb4", ":red_circle:"},
+  Emoji{"\xf0\x9f\x94\xb5", ":blue_circle:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xa8", ":flag_ac:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xa9", ":flag_ad:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xaa", ":flag_ae:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xab", ":flag_af:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xac", ":flag_ag:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xae", ":flag_ai:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb1", ":flag_al:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb2", ":flag_am:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb4", ":flag_ao:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb6", ":flag_aq:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb7", ":flag_ar:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb8", ":flag_as:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xb9", ":flag_at:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xba", ":flag_au:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xbc", ":flag_aw:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xbd", ":flag_ax:"},
+  Emoji{"\xf0\x9f\x87\xa6\xf0\x9f\x87\xbf", ":flag_az:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xa6", ":flag_ba:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xa7", ":flag_bb:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xa9", ":flag_bd:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xaa", ":flag_be:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xab", ":flag_bf:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xac", ":flag_bg:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xad", ":flag_bh:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xae", ":flag_bi:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xaf", ":flag_bj:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb1", ":flag_bl:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb2", ":flag_bm:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb3", ":flag_bn:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb4", ":flag_bo:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb6", ":flag_bq:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb7", ":flag_br:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb8", ":flag_bs:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xb9", ":flag_bt:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xbb", ":flag_bv:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xbc", ":flag_bw:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xbe", ":flag_by:"},
+  Emoji{"\xf0\x9f\x87\xa7\xf0\x9f\x87\xbf", ":flag_bz:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xa6", ":flag_ca:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xa8", ":flag_cc:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xa9", ":flag_cd:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xab", ":flag_cf:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xac", ":flag_cg:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xad", ":flag_ch:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xae", ":flag_ci:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb0", ":flag_ck:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb1", ":flag_cl:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb2", ":flag_cm:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb3", ":flag_cn:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb4", ":flag_co:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb5", ":flag_cp:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xb7", ":flag_cr:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xba", ":flag_cu:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xbb", ":flag_cv:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xbc", ":flag_cw:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xbd", ":flag_cx:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xbe", ":flag_cy:"},
+  Emoji{"\xf0\x9f\x87\xa8\xf0\x9f\x87\xbf", ":flag_cz:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xaa", ":flag_de:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xac", ":flag_dg:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xaf", ":flag_dj:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xb0", ":flag_dk:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xb2", ":flag_dm:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xb4", ":flag_do:"},
+  Emoji{"\xf0\x9f\x87\xa9\xf0\x9f\x87\xbf", ":flag_dz:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xa6", ":flag_ea:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xa8", ":flag_ec:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xaa", ":flag_ee:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xac", ":flag_eg:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xad", ":flag_eh:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xb7", ":flag_er:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xb8", ":flag_es:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xb9", ":flag_et:"},
+  Emoji{"\xf0\x9f\x87\xaa\xf0\x9f\x87\xba", ":flag_eu:"},
+  Emoji{"\xf0\x9f\x87\xab\xf0\x9f\x87\xae", ":flag_fi:"},
+  Emoji{"\xf0\x9f\x87\xab\xf0\x9f\x87\xaf", ":flag_fj:"},
+  Emoji{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb0", ":flag_fk:"},
+  Emoji{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb2", ":flag_fm:"},
+  Emoji{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb4", ":flag_fo:"},
+  Emoji{"\xf0\x9f\x87\xab\xf0\x9f\x87\xb7", ":flag_fr:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xa6", ":flag_ga:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xa7", ":flag_gb:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xa9", ":flag_gd:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xaa", ":flag_ge:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xab", ":flag_gf:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xac", ":flag_gg:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xad", ":flag_gh:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xae", ":flag_gi:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb1", ":flag_gl:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb2", ":flag_gm:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb3", ":flag_gn:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb5", ":flag_gp:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb6", ":flag_gq:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb7", ":flag_gr:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb8", ":flag_gs:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xb9", ":flag_gt:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xba", ":flag_gu:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xbc", ":flag_gw:"},
+  Emoji{"\xf0\x9f\x87\xac\xf0\x9f\x87\xbe", ":flag_gy:"},
+  Emoji{"\xf0\x9f\x87\xad\xf0\x9f\x87\xb0", ":flag_hk:"},
+  Emoji{"\xf0\x9f\x87\xad\xf0\x9f\x87\xb2", ":flag_hm:"},
+  Emoji{"\xf0\x9f\x87\xad\xf0\x9f\x87\xb3", ":flag_hn:"},
+  Emoji{"\xf0\x9f\x87\xad\xf0\x9f\x87\xb7", ":flag_hr:"},
+  Emoji{"\xf0\x9f\x87\xad\xf0\x9f\x87\xb9", ":flag_ht:"},
+  Emoji{"\xf0\x9f\x87\xad\xf0\x9f\x87\xba", ":flag_hu:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xa8", ":flag_ic:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xa9", ":flag_id:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xaa", ":flag_ie:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb1", ":flag_il:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb2", ":flag_im:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb3", ":flag_in:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb4", ":flag_io:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb6", ":flag_iq:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb7", ":flag_ir:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb8", ":flag_is:"},
+  Emoji{"\xf0\x9f\x87\xae\xf0\x9f\x87\xb9", ":flag_it:"},
+  Emoji{"\xf0\x9f\x87\xaf\xf0\x9f\x87\xaa", ":flag_je:"},
+  Emoji{"\xf0\x9f\x87\xaf\xf0\x9f\x87\xb2", ":flag_jm:"},
+  Emoji{"\xf0\x9f\x87\xaf\xf0\x9f\x87\xb4", ":flag_jo:"},
+  Emoji{"\xf0\x9f\x87\xaf\xf0\x9f\x87\xb5", ":flag_jp:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xaa", ":flag_ke:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xac", ":flag_kg:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xad", ":flag_kh:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xae", ":flag_ki:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xb2", ":flag_km:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xb3", ":flag_kn:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xb5", ":flag_kp:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xb7", ":flag_kr:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xbc", ":flag_kw:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xbe", ":flag_ky:"},
+  Emoji{"\xf0\x9f\x87\xb0\xf0\x9f\x87\xbf", ":flag_kz:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xa6", ":flag_la:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xa7", ":flag_lb:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xa8", ":flag_lc:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xae", ":flag_li:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xb0", ":flag_lk:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xb7", ":flag_lr:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xb8", ":flag_ls:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xb9", ":flag_lt:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xba", ":flag_lu:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xbb", ":flag_lv:"},
+  Emoji{"\xf0\x9f\x87\xb1\xf0\x9f\x87\xbe", ":flag_ly:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xa6", ":flag_ma:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xa8", ":flag_mc:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xa9", ":flag_md:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xaa", ":flag_me:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xab", ":flag_mf:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xac", ":flag_mg:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xad", ":flag_mh:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb0", ":flag_mk:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb1", ":flag_ml:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb2", ":flag_mm:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb3", ":flag_mn:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb4", ":flag_mo:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb5", ":flag_mp:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb6", ":flag_mq:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb7", ":flag_mr:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb8", ":flag_ms:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xb9", ":flag_mt:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xba", ":flag_mu:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xbb", ":flag_mv:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xbc", ":flag_mw:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xbd", ":flag_mx:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xbe", ":flag_my:"},
+  Emoji{"\xf0\x9f\x87\xb2\xf0\x9f\x87\xbf", ":flag_mz:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xa6", ":flag_na:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xa8", ":flag_nc:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xaa", ":flag_ne:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xab", ":flag_nf:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xac", ":flag_ng:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xae", ":flag_ni:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xb1", ":flag_nl:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xb4", ":flag_no:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xb5", ":flag_np:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xb7", ":flag_nr:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xba", ":flag_nu:"},
+  Emoji{"\xf0\x9f\x87\xb3\xf0\x9f\x87\xbf", ":flag_nz:"},
+  Emoji{"\xf0\x9f\x87\xb4\xf0\x9f\x87\xb2", ":flag_om:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xa6", ":flag_pa:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xaa", ":flag_pe:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xab", ":flag_pf:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xac", ":flag_pg:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xad", ":flag_ph:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb0", ":flag_pk:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb1", ":flag_pl:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb2", ":flag_pm:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb3", ":flag_pn:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb7", ":flag_pr:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb8", ":flag_ps:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xb9", ":flag_pt:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xbc", ":flag_pw:"},
+  Emoji{"\xf0\x9f\x87\xb5\xf0\x9f\x87\xbe", ":flag_py:"},
+  Emoji{"\xf0\x9f\x87\xb6\xf0\x9f\x87\xa6", ":flag_qa:"},
+  Emoji{"\xf0\x9f\x87\xb7\xf0\x9f\x87\xaa", ":flag_re:"},
+  Emoji{"\xf0\x9f\x87\xb7\xf0\x9f\x87\xb4", ":flag_ro:"},
+  Emoji{"\xf0\x9f\x87\xb7\xf0\x9f\x87\xb8", ":flag_rs:"},
+  Emoji{"\xf0\x9f\x87\xb7\xf0\x9f\x87\xba", ":flag_ru:"},
+  Emoji{"\xf0\x9f\x87\xb7\xf0\x9f\x87\xbc", ":flag_rw:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xa6", ":flag_sa:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xa7", ":flag_sb:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xa8", ":flag_sc:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xa9", ":flag_sd:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xaa", ":flag_se:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xac", ":flag_sg:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xad", ":flag_sh:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xae", ":flag_si:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xaf", ":flag_sj:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb0", ":flag_sk:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb1", ":flag_sl:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb2", ":flag_sm:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb3", ":flag_sn:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb4", ":flag_so:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb7", ":flag_sr:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb8", ":flag_ss:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xb9", ":flag_st:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xbb", ":flag_sv:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xbd", ":flag_sx:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xbe", ":flag_sy:"},
+  Emoji{"\xf0\x9f\x87\xb8\xf0\x9f\x87\xbf", ":flag_sz:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xa6", ":flag_ta:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xa8", ":flag_tc:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xa9", ":flag_td:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xab", ":flag_tf:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xac", ":flag_tg:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xad", ":flag_th:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xaf", ":flag_tj:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb0", ":flag_tk:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb1", ":flag_tl:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb2", ":flag_tm:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb3", ":flag_tn:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb4", ":flag_to:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb7", ":flag_tr:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xb9", ":flag_tt:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xbb", ":flag_tv:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xbc", ":flag_tw:"},
+  Emoji{"\xf0\x9f\x87\xb9\xf0\x9f\x87\xbf", ":flag_tz:"},
+  Emoji{"\xf0\x9f\x87\xba\xf0\x9f\x87\xa6", ":flag_ua:"},
+  Emoji{"\xf0\x9f\x87\xba\xf0\x9f\x87\xac", ":flag_ug:"},
+  Emoji{"\xf0\x9f\x87\xba\xf0\x9f\x87\xb2", ":flag_um:"},
+  Emoji{"\xf0\x9f\x87\xba\xf0\x9f\x87\xb8", ":flag_us:"},
+  Emoji{"\xf0\x9f\x87\xba\xf0\x9f\x87\xbe", ":flag_uy:"},
+  Emoji{"\xf0\x9f\x87\xba\xf0\x9f\x87\xbf", ":flag_uz:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xa6", ":flag_va:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xa8", ":flag_vc:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xaa", ":flag_ve:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xac", ":flag_vg:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xae", ":flag_vi:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xb3", ":flag_vn:"},
+  Emoji{"\xf0\x9f\x87\xbb\xf0\x9f\x87\xba", ":flag_vu:"},
+  Emoji{"\xf0\x9f\x87\xbc\xf0\x9f\x87\xab", ":flag_wf:"},
+  Emoji{"\xf0\x9f\x87\xbc\xf0\x9f\x87\xb8", ":flag_ws:"},
+  Emoji{"\xf0\x9f\x87\xbd\xf0\x9f\x87\xb0", ":flag_xk:"},
+  Emoji{"\xf0\x9f\x87\xbe\xf0\x9f\x87\xaa", ":flag_ye:"},
+  Emoji{"\xf0\x9f\x87\xbe\xf0\x9f\x87\xb9", ":flag_yt:"},
+  Emoji{"\xf0\x9f\x87\xbf\xf0\x9f\x87\xa6", ":flag_za:"},
+  Emoji{"\xf0\x9f\x87\xbf\xf0\x9f\x87\xb2", ":flag_zm:"},
+  Emoji{"\xf0\x9f\x87\xbf\xf0\x9f\x87\xbc", ":flag_zw:"},
+};
+}
+
+const EmojiRange Provider::people   = {emojis + 0, emojis + 207};
+const EmojiRange Provider::nature   = {emojis + 207, emojis + 367};
+const EmojiRange Provider::food     = {emojis + 367, emojis + 452};
+const EmojiRange Provider::activity = {emojis + 452, emojis + 521};
+const EmojiRange Provider::travel   = {emojis + 521, emojis + 639};
+const EmojiRange Provider::objects  = {emojis + 639, emojis + 819};
+const EmojiRange Provider::symbols  = {emojis + 819, emojis + 1094};
+const EmojiRange Provider::flags    = {emojis + 1094, emojis + 1351};
+
+const EmojiRange Provider::all = {emojis, emojis + 1351};
+
+const std::uint16_t Provider::shortnameIndex[] = {
+  1032, 1035, 492, 1038, 1039, 1037, 1034, 1064, 630, 622, 625, 624,
+  623, 662, 801, 81, 591, 647, 614, 100, 836, 841, 65, 56,
+  291, 374, 961, 951, 971, 977, 975, 922, 976, 967, 931, 930,
+  924, 923, 921, 920, 929, 918, 926, 974, 925, 919, 932, 933,
+  473, 601, 1020, 46, 194, 892, 940, 382, 1040, 99, 436, 261,
+  899, 934, 397, 498, 903, 668, 753, 995, 366, 372, 1009, 545,
+  771, 649, 486, 487, 462, 252, 475, 658, 688, 529, 667, 253,
+  654, 292, 445, 446, 293, 991, 885, 651, 411, 464, 603, 187,
+  917, 263, 429, 1091, 831, 876, 1078, 1077, 1075, 755, 1072, 1088,
+  304, 281, 721, 599, 1093, 827, 9, 236, 641, 719, 732, 731,
+  723, 837, 197, 297, 121, 520, 493, 499, 93, 390, 111, 570,
+  206, 823, 290, 714, 578, 577, 403, 587, 606, 132, 133, 288,
+  310, 430, 765, 767, 152, 683, 242, 704, 705, 528, 954, 713,
+  432, 616, 1033, 960, 780, 768, 572, 385, 466, 221, 220, 698,
+  804, 441, 447, 889, 770, 769, 638, 394, 378, 298, 319, 258,
+  906, 251, 431, 363, 557, 982, 471, 568, 569, 537, 1041, 164,
+  519, 534, 772, 868, 867, 870, 869, 848, 847, 850, 849, 852,
+  851, 854, 853, 856, 855, 858, 857, 860, 859, 862, 861, 864,
+  863, 866, 865, 665, 718, 786, 205, 340, 348, 346, 347, 349,
+  68, 875, 443, 438, 808, 60, 358, 800, 690, 670, 49, 43,
+  1068, 613, 535, 104, 680, 548, 428, 406, 1042, 101, 1016, 386,
+  655, 134, 138, 137, 233, 230, 67, 285, 759, 740, 331, 494,
+  270, 391, 945, 815, 794, 198, 618, 53, 91, 812, 388, 820,
+  1003, 890, 415, 434, 902, 871, 793, 128, 130, 423, 181, 502,
+  211, 764, 308, 228, 550, 530, 691, 1086, 874, 50, 27, 763,
+  838, 63, 911, 216, 215, 736, 671, 278, 652, 427, 265, 275,
+  274, 185, 241, 39, 360, 518, 267, 699, 742, 266, 171, 311,
+  320, 321, 322, 405, 383, 1029, 1007, 1006, 981, 689, 243, 935,
+  741, 744, 737, 553, 543, 307, 1014, 22, 175, 819, 180, 174,
+  122, 551, 316, 139, 968, 687, 57, 256, 454, 573, 619, 495,
+  781, 761, 701, 149, 359, 592, 635, 482, 325, 333, 279, 422,
+  505, 158, 1026, 1094, 1095, 1096, 1097, 1098, 1099, 1100, 1101, 1102,
+  1103, 1104, 1105, 1106, 1107, 1108, 1109, 1110, 1111, 1112, 1113, 1114,
+  1115, 1116, 1117, 1118, 1119, 1120, 816, 1121, 1122, 1123, 1124, 1125,
+  1126, 1127, 1128, 1129, 1130, 1131, 1132, 1133, 1134, 1135, 1136, 1137,
+  1138, 1139, 1140, 1141, 1142, 1143, 1144, 1145, 1146, 1147, 1148, 1149,
+  1150, 1151, 1152, 1153, 1154, 1155, 1156, 1157, 1158, 1159, 1160, 1161,
+  1162, 1163, 1164, 1165, 1166, 1167, 1168, 1169, 1170, 1171, 1172, 1173,
+  1174, 1175, 1176, 1177, 1178, 1179, 1180, 1181, 1182, 1183, 1184, 1185,
+  1186, 1187, 1188, 1189, 1190, 1191, 1192, 1193, 1194, 1195, 1196, 1197,
+  1198, 1199, 1200, 1201, 1202, 1203, 1204, 1205, 1206, 1207, 1208, 1209,
+  1210, 1211, 1212, 1213, 1214, 1215, 1216, 1217, 1218, 1219, 1220, 1221,
+  1222, 1223, 1224, 1225, 1226, 1227, 1228, 1229, 1230, 1231, 1232, 1233,
+  1234, 1235, 1236, 1237, 1238, 1239, 1240, 1241, 1242, 1243, 1244, 1245,
+  1246, 1247, 1248, 1249, 1250, 1251, 1252, 1253, 1254, 1255, 1256, 1257,
+  1258, 1259, 1260, 1261, 1262, 1263, 1264, 1265, 1266, 1267, 1268, 1269,
+  1270, 1271, 1272, 1273, 1274, 1275, 1276, 1277, 1278, 1279, 1280, 1281,
+  1282, 1283, 1284, 1285, 1286, 1287, 1288, 1289, 1290, 1291, 1292, 1293,
+  1294, 1295, 1296, 1297, 1298, 1299, 1300, 1301, 1302, 1303, 1304, 1305,
+  1306, 1307, 1308, 1309, 1310, 1311, 1312, 1313, 1314, 1315, 1316, 1317,
+  1318, 1319, 1320, 1321, 1322, 1323, 1324, 1325, 1326, 1327, 1328, 1329,
+  1330, 1331, 1332, 1333, 1334, 1335, 1336, 1337, 1338, 1339, 1340, 1341,
+  1342, 1343, 817, 1344, 1345, 1346, 1347, 1348, 1349, 1350, 672, 715,
+  990, 697, 878, 62, 350, 564, 489, 173, 450, 449, 562, 1025,
+  314, 219, 650, 1043, 392, 421, 399, 269, 47, 55, 609, 327,
+  336, 509, 799, 645, 953, 80, 675, 832, 94, 844, 501, 240,
+  503, 458, 214, 367, 375, 720, 828, 1013, 1012, 59, 1, 0,
+  103, 514, 795, 125, 398, 789, 791, 248, 153, 190, 469, 169,
+  1019, 262, 260, 72, 512, 208, 821, 834, 835, 12, 87, 822,
+  826, 873, 996, 1002, 891, 1001, 997, 1000, 627, 202, 312, 302,
+  984, 195, 496, 642, 536, 435, 226, 455, 544, 387, 401, 546,
+  845, 659, 660, 539, 538, 540, 19, 30, 426, 504, 424, 1045,
+  1060, 76, 746, 743, 119, 1044, 66, 1010, 682, 531, 716, 362,
+  523, 552, 78, 77, 184, 2, 86, 676, 470, 561, 788, 787,
+  693, 1031, 186, 178, 14, 89, 16, 13, 15, 380, 646, 254,
+  1055, 733, 1081, 1080, 329, 334, 7, 317, 725, 160, 904, 927,
+  928, 371, 955, 225, 679, 453, 957, 463, 581, 803, 222, 177,
+  203, 272, 783, 785, 433, 1004, 882, 883, 547, 640, 983, 69,
+  1046, 708, 709, 877, 748, 749, 750, 751, 95, 129, 112, 114,
+  105, 193, 648, 315, 500, 70, 124, 395, 481, 884, 368, 949,
+  896, 151, 580, 678, 511, 710, 146, 479, 437, 571, 590, 696,
+  987, 45, 739, 734, 213, 212, 584, 201, 558, 605, 620, 522,
+  607, 527, 525, 465, 629, 585, 524, 246, 245, 694, 700, 810,
+  108, 140, 318, 515, 887, 510, 879, 170, 989, 73, 182, 999,
+  35, 21, 1047, 323, 332, 730, 729, 1048, 565, 1030, 886, 909,
+  907, 908, 117, 914, 23, 913, 910, 912, 172, 724, 717, 766,
+  888, 798, 1049, 993, 361, 846, 283, 419, 541, 811, 1050, 155,
+  118, 97, 98, 941, 936, 598, 588, 594, 596, 1022, 762, 166,
+  28, 963, 722, 946, 745, 268, 231, 747, 728, 726, 686, 758,
+  309, 393, 255, 775, 776, 532, 1051, 1005, 341, 901, 978, 948,
+  377, 389, 376, 757, 756, 754, 760, 264, 42, 472, 26, 115,
+  106, 116, 790, 235, 234, 237, 806, 373, 497, 962, 400, 939,
+  970, 147, 142, 143, 144, 145, 593, 217, 83, 410, 542, 677,
+  752, 894, 384, 191, 396, 738, 92, 168, 644, 113, 110, 109,
+  692, 702, 159, 830, 189, 773, 893, 1011, 250, 249, 521, 227,
+  681, 1087, 916, 64, 576, 608, 634, 818, 162, 154, 167, 120,
+  238, 416, 247, 980, 988, 597, 1092, 1017, 17, 34, 476, 965,
+  966, 898, 833, 972, 244, 674, 414, 413, 412, 637, 161, 204,
+  82, 631, 3, 574, 24, 259, 300, 299, 610, 774, 460, 490,
+  127, 506, 1056, 959, 615, 440, 409, 196, 107, 712, 632, 513,
+  802, 549, 192, 779, 604, 296, 958, 61, 90, 727, 626, 483,
+  1069, 207, 306, 141, 1028, 407, 313, 282, 425, 239, 284, 796,
+  560, 621, 183, 643, 813, 657, 286, 123, 985, 1027, 950, 507,
+  456, 79, 639, 33, 653, 31, 48, 18, 474, 1083, 1082, 1084,
+  1085, 5, 85, 4, 84, 75, 25, 88, 807, 289, 273, 74,
+  457, 355, 356, 357, 54, 485, 937, 1052, 881, 452, 872, 417,
+  1008, 636, 364, 825, 209, 880, 131, 839, 840, 617, 294, 295,
+  451, 102, 287, 533, 339, 338, 947, 942, 633, 582, 556, 575,
+  408, 979, 663, 777, 379, 36, 38, 37, 404, 337, 303, 11,
+  335, 567, 566, 459, 420, 628, 41, 210, 6, 418, 461, 1036,
+  559, 805, 402, 669, 365, 370, 952, 595, 439, 684, 685, 711,
+  491, 563, 666, 71, 20, 484, 842, 1024, 157, 156, 342, 478,
+  477, 224, 223, 664, 32, 1018, 656, 555, 381, 176, 792, 938,
+  200, 969, 973, 695, 602, 611, 579, 586, 583, 814, 778, 992,
+  52, 589, 480, 444, 280, 600, 516, 305, 448, 257, 271, 703,
+  964, 1023, 824, 135, 136, 1061, 1066, 1070, 1059, 1057, 1058, 1071,
+  1062, 1065, 1063, 1067, 352, 353, 40, 915, 229, 784, 1053, 44,
+  809, 148, 612, 707, 986, 706, 508, 517, 956, 526, 488, 1054,
+  150, 126, 330, 328, 905, 782, 661, 232, 468, 369, 163, 1015,
+  324, 326, 900, 58, 554, 277, 276, 943, 895, 994, 1090, 843,
+  1079, 1076, 1074, 1073, 1089, 344, 345, 343, 301, 351, 673, 442,
+  8, 218, 96, 188, 199, 897, 51, 797, 467, 165, 998, 829,
+  735, 944, 10, 354, 1021, 29, 179,
+};
+
+const std::size_t Provider::shortnameIndexSize =
+  sizeof(shortnameIndex) / sizeof(shortnameIndex[0]);
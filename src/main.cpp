@@ -34,6 +34,7 @@
 #include "MainWindow.h"
 #include "MatrixClient.h"
 #include "RunGuard.h"
+#include "StartupProfile.h"
 #include "Utils.h"
 #include "config/nheko.h"
 
@@ -125,8 +126,16 @@ main(int argc, char *argv[])
         QCommandLineParser parser;
         parser.addHelpOption();
         parser.addVersionOption();
+
+        QCommandLineOption startupProfile(
+          "startup-profile",
+          QCoreApplication::tr("Print how long each stage of the startup took."));
+        parser.addOption(startupProfile);
+
         parser.process(app);
 
+        startup::init(parser.isSet(startupProfile));
+
         app.setWindowIcon(QIcon(":/logos/nheko.png"));
 
         http::init();
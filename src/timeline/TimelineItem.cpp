@@ -432,7 +432,7 @@ TimelineItem::TimelineItem(const mtx::events::RoomEvent<mtx::events::msg::Notice
         const auto sender    = QString::fromStdString(event.sender);
         const auto timestamp = QDateTime::fromMSecsSinceEpoch(event.origin_server_ts);
 
-        auto formatted_body = utils::linkifyMessage(utils::getMessageBody(event).trimmed());
+        auto formatted_body = utils::formatMessageBody(event);
         auto body           = QString::fromStdString(event.content.body).trimmed().toHtmlEscaped();
 
         descriptionMsg_ = {event_id_,
@@ -478,7 +478,7 @@ TimelineItem::TimelineItem(const mtx::events::RoomEvent<mtx::events::msg::Emote>
         event_id_         = QString::fromStdString(event.event_id);
         const auto sender = QString::fromStdString(event.sender);
 
-        auto formatted_body = utils::linkifyMessage(utils::getMessageBody(event).trimmed());
+        auto formatted_body = utils::formatMessageBody(event);
         auto body           = QString::fromStdString(event.content.body).trimmed().toHtmlEscaped();
 
         auto timestamp   = QDateTime::fromMSecsSinceEpoch(event.origin_server_ts);
@@ -526,7 +526,7 @@ TimelineItem::TimelineItem(const mtx::events::RoomEvent<mtx::events::msg::Text>
         event_id_         = QString::fromStdString(event.event_id);
         const auto sender = QString::fromStdString(event.sender);
 
-        auto formatted_body = utils::linkifyMessage(utils::getMessageBody(event).trimmed());
+        auto formatted_body = utils::formatMessageBody(event);
         auto body           = QString::fromStdString(event.content.body).trimmed().toHtmlEscaped();
 
         auto timestamp   = QDateTime::fromMSecsSinceEpoch(event.origin_server_ts);
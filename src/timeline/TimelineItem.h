@@ -216,6 +216,8 @@ public:
 
         //! Add a user avatar for this event.
         void addAvatar();
+        //! Whether the sender is displayed along with the event.
+        bool hasAvatar() const { return userAvatar_ != nullptr; }
         void addKeyRequestAction();
 
 signals:
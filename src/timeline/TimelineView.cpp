@@ -17,11 +17,15 @@
 
 #include <boost/variant.hpp>
 
+#include <memory>
+#include <set>
+
 #include <QApplication>
 #include <QFileInfo>
 #include <QTimer>
 #include <QtConcurrent>
 
+#include "AsyncCache.h"
 #include "Cache.h"
 #include "ChatPage.h"
 #include "Config.h"
@@ -43,6 +47,28 @@ using TimelineEvent = mtx::events::collections::TimelineEvents;
 //! Maximum number of widgets to keep in the timeline layout.
 constexpr int MAX_RETAINED_WIDGETS = 100;
 constexpr int MIN_SCROLLBAR_HANDLE = 60;
+//! Number of stored events added to the top of the timeline on each pagination.
+constexpr std::size_t HISTORY_PAGE_SIZE = 30;
+//! Number of fetched events turned into widgets at once.
+constexpr std::size_t HISTORY_RENDER_BATCH = 30;
+//! Screens of older events kept fetched above the scroll position.
+constexpr int PREFETCH_SCREENS = 3;
+//! Time a page of history takes to arrive. Fast scrolling prefetches this much further.
+constexpr int PREFETCH_HORIZON_MS = 1000;
+//! Scroll events further apart don't count towards the scroll velocity.
+constexpr qint64 SCROLL_VELOCITY_WINDOW_MS = 250;
+//! Height assumed for the events until some are rendered.
+constexpr int ESTIMATED_ITEM_HEIGHT = 40;
+//! Screens of widgets kept on each side of the viewport. The rest waits in the buffers.
+constexpr int RENDERED_SCREENS = 3;
+//! Widgets kept after leaving the rendered window, to be reused when scrolling back.
+constexpr int RECYCLED_WIDGETS = 64;
+//! How long the scrolling has to pause before the timeline is trimmed.
+constexpr int TRIM_DELAY_MS = 300;
+//! Time spent creating widgets before the event loop gets to lay out and paint them.
+constexpr qint64 RENDER_BUDGET_US = 4000;
+//! Duration of a frame at 60 Hz. Longer pauses between two chunks drop frames.
+constexpr qint64 FRAME_US = 16667;
 
 //! Retrieve the timestamp of the event represented by the given widget.
 QDateTime
@@ -59,6 +85,13 @@ getDate(QWidget *widget)
         return QDateTime();
 }
 
+//! The key the event is stored under in the cache.
+static std::string
+messageKey(const TimelineEvent &event)
+{
+        return message_key(utils::event_timestamp(event), utils::event_id(event));
+}
+
 TimelineView::TimelineView(const mtx::responses::Timeline &timeline,
                            const QString &room_id,
                            QWidget *parent)
@@ -74,6 +107,9 @@ TimelineView::TimelineView(const QString &room_id, QWidget *parent)
   , room_id_{room_id}
 {
         init();
+
+        // The first page is on its way, a fetch or prefetch right after waits for it.
+        isPaginationInProgress_ = true;
         getMessages();
 }
 
@@ -82,6 +118,13 @@ TimelineView::sliderRangeChanged(int min, int max)
 {
         Q_UNUSED(min);
 
+        // Widgets outside of the viewport were removed. Keep the visible ones in place.
+        if (pendingScrollValue_ >= 0) {
+                scroll_area_->verticalScrollBar()->setValue(pendingScrollValue_);
+                pendingScrollValue_ = -1;
+                return;
+        }
+
         if (!scroll_area_->verticalScrollBar()->isVisible()) {
                 scroll_area_->verticalScrollBar()->setValue(max);
                 return;
@@ -109,12 +152,17 @@ TimelineView::sliderRangeChanged(int min, int max)
 void
 TimelineView::fetchHistory()
 {
-        if (!isScrollbarActivated() && !isTimelineFinished) {
+        if (!isScrollbarActivated() && (!isTimelineFinished || !topMessages_.empty())) {
                 if (!isVisible())
                         return;
 
-                isPaginationInProgress_ = true;
-                getMessages();
+                if (!topMessages_.empty()) {
+                        renderBufferedHistory();
+                } else if (!isPaginationInProgress_) {
+                        isPaginationInProgress_ = true;
+                        getMessages();
+                }
+
                 paginationTimer_->start(2000);
 
                 return;
@@ -123,6 +171,302 @@ TimelineView::fetchHistory()
         paginationTimer_->stop();
 }
 
+void
+TimelineView::prefetch()
+{
+        // The first page is enough for the room to open without waiting.
+        if (hasLoaded() || !topMessages_.empty() || isPaginationInProgress_)
+                return;
+
+        isPaginationInProgress_ = true;
+        getMessages();
+}
+
+void
+TimelineView::cancelPrefetch()
+{
+        if (isVisible())
+                return;
+
+        // Answers that are still on their way are dropped. They are stored in the cache anyway.
+        if (isPaginationInProgress_) {
+                historyRequest_ += 1;
+                isPaginationInProgress_ = false;
+        }
+
+        if (scroll_layout_->count() > 0 || topMessages_.empty())
+                return;
+
+        topMessages_.clear();
+        historyStart_ = bottomMessages_.empty() ? "" : messageKey(bottomMessages_.front());
+}
+
+void
+TimelineView::prefetchHistory()
+{
+        if (isTimelineFinished || isPaginationInProgress_)
+                return;
+
+        const int items         = scroll_layout_->count();
+        const double itemHeight = items > 0 ? (double)scroll_widget_->height() / items
+                                            : (double)ESTIMATED_ITEM_HEIGHT;
+        const int screen        = std::max(scroll_area_->viewport()->height(), 1);
+
+        // Look further ahead while the user is moving fast towards the top.
+        const double wanted =
+          PREFETCH_SCREENS * screen + scrollVelocity_ * PREFETCH_HORIZON_MS / 1000.0;
+        const double ahead =
+          scroll_area_->verticalScrollBar()->value() + topMessages_.size() * itemHeight;
+
+        if (ahead >= wanted)
+                return;
+
+        isPaginationInProgress_ = true;
+        getMessages();
+}
+
+void
+TimelineView::renderBufferedHistory()
+{
+        // The previous batch is still being rendered.
+        if (!topRenderQueue_.empty())
+                return;
+
+        const auto count = std::min(topMessages_.size(), HISTORY_RENDER_BATCH);
+
+        std::vector<TimelineEvent> events(
+          std::make_move_iterator(topMessages_.begin()),
+          std::make_move_iterator(topMessages_.begin() + count));
+        topMessages_.erase(topMessages_.begin(), topMessages_.begin() + count);
+
+        renderTopEvents(events);
+}
+
+void
+TimelineView::renderNewerEvents()
+{
+        if (!bottomRenderQueue_.empty())
+                return;
+
+        const auto count = std::min(bottomMessages_.size(), HISTORY_RENDER_BATCH);
+
+        std::vector<TimelineEvent> events(
+          std::make_move_iterator(bottomMessages_.begin()),
+          std::make_move_iterator(bottomMessages_.begin() + count));
+        bottomMessages_.erase(bottomMessages_.begin(), bottomMessages_.begin() + count);
+
+        renderBottomEvents(events);
+
+        isDetached_ = !bottomMessages_.empty();
+}
+
+void
+TimelineView::trimTimeline()
+{
+        // The queued events belong next to the widgets at the edges.
+        if (!isVisible() || !topRenderQueue_.empty() || !bottomRenderQueue_.empty())
+                return;
+
+        const int value  = scroll_area_->verticalScrollBar()->value();
+        const int screen = std::max(scroll_area_->viewport()->height(), 1);
+        const int margin = RENDERED_SCREENS * screen;
+
+        // Widgets below the window go back to the events waiting to be rendered at the bottom.
+        // A separator left at either end goes along, it's added again with the next event.
+        std::vector<TimelineEvent> newer;
+        while (scroll_layout_->count() > 0) {
+                auto widget = scroll_layout_->itemAt(scroll_layout_->count() - 1)->widget();
+                if (!widget)
+                        break;
+
+                if (qobject_cast<DateSeparator *>(widget) == nullptr) {
+                        auto rendered = renderedEvents_.find(widget);
+
+                        // Pending messages stay.
+                        if (widget->y() < value + screen + margin ||
+                            rendered == renderedEvents_.end())
+                                break;
+
+                        newer.push_back(rendered->second);
+                }
+
+                releaseWidget(widget);
+        }
+
+        // Widgets above the window go back ahead of the prefetched history.
+        int removedHeight = 0;
+        std::vector<TimelineEvent> older;
+        while (scroll_layout_->count() > 0) {
+                auto widget = scroll_layout_->itemAt(0)->widget();
+                if (!widget)
+                        break;
+
+                if (qobject_cast<DateSeparator *>(widget) == nullptr) {
+                        auto rendered = renderedEvents_.find(widget);
+
+                        if (widget->y() + widget->height() > value - margin ||
+                            rendered == renderedEvents_.end())
+                                break;
+
+                        older.push_back(rendered->second);
+                }
+
+                removedHeight += widget->height();
+                releaseWidget(widget);
+        }
+
+        if (newer.empty() && older.empty())
+                return;
+
+        if (!newer.empty()) {
+                bottomMessages_.insert(bottomMessages_.begin(),
+                                       std::make_move_iterator(newer.rbegin()),
+                                       std::make_move_iterator(newer.rend()));
+                isDetached_ = true;
+
+                lastSender_.clear();
+                lastMsgTimestamp_ = QDateTime();
+
+                const auto last = scroll_layout_->itemAt(scroll_layout_->count() - 1);
+                if (auto item = qobject_cast<TimelineItem *>(last ? last->widget() : nullptr))
+                        saveLastMessageInfo(item->descriptionMessage().userid,
+                                            item->descriptionMessage().datetime);
+        }
+
+        if (!older.empty()) {
+                topMessages_.insert(topMessages_.begin(),
+                                    std::make_move_iterator(older.rbegin()),
+                                    std::make_move_iterator(older.rend()));
+
+                firstSender_.clear();
+                firstMsgTimestamp_ = QDateTime();
+
+                const auto first = scroll_layout_->itemAt(0);
+                if (auto item = qobject_cast<TimelineItem *>(first ? first->widget() : nullptr))
+                        saveFirstMessageInfo(item->descriptionMessage().userid,
+                                             item->descriptionMessage().datetime);
+        }
+
+        pendingScrollValue_ = std::max(value - removedHeight, 0);
+
+        nhlog::ui()->debug("[{}] trimmed timeline: {} widgets kept, {} released",
+                           room_id_.toStdString(),
+                           scroll_layout_->count(),
+                           newer.size() + older.size());
+}
+
+void
+TimelineView::releaseWidget(QWidget *widget)
+{
+        scroll_layout_->removeWidget(widget);
+        widget->hide();
+
+        auto rendered = renderedEvents_.find(widget);
+        if (rendered == renderedEvents_.end()) {
+                widget->deleteLater();
+                return;
+        }
+
+        const auto event_id = QString::fromStdString(utils::event_id(rendered->second));
+        renderedEvents_.erase(rendered);
+        eventIds_.remove(event_id);
+
+        // Undecrypted events are parsed again to retry their decryption.
+        if (undecryptedEvents_.remove(event_id) > 0) {
+                widget->deleteLater();
+                return;
+        }
+
+        recycledWidgets_[event_id] = widget;
+        recycleOrder_.enqueue(event_id);
+
+        while (recycleOrder_.size() > RECYCLED_WIDGETS) {
+                auto recycled = recycledWidgets_.take(recycleOrder_.dequeue());
+                if (recycled)
+                        recycled->deleteLater();
+        }
+}
+
+QWidget *
+TimelineView::createWidget(const TimelineEvent &event, TimelineDirection direction)
+{
+        const auto event_id = QString::fromStdString(utils::event_id(event));
+
+        auto widget = recycledWidgets_.take(event_id);
+        if (widget == nullptr)
+                return parseMessageEvent(event, direction);
+
+        recycleOrder_.removeOne(event_id);
+
+        const auto sender    = QString::fromStdString(utils::event_sender(event));
+        const auto timestamp = utils::event_timestamp(event);
+
+        auto item = qobject_cast<TimelineItem *>(widget);
+        if (item == nullptr) {
+                saveMessageInfo("", timestamp, direction);
+                eventIds_[event_id] = widget;
+
+                return widget;
+        }
+
+        const bool withSender = isSenderRendered(sender, timestamp, direction);
+
+        // The sender can be added but not removed from an existing widget.
+        if (!withSender && item->hasAvatar()) {
+                widget->deleteLater();
+                return parseMessageEvent(event, direction);
+        }
+
+        if (withSender)
+                item->addAvatar();
+
+        saveMessageInfo(sender, timestamp, direction);
+        eventIds_[event_id] = widget;
+
+        return widget;
+}
+
+void
+TimelineView::trackRenderedEvent(QWidget *widget, const TimelineEvent &event)
+{
+        // An event without a new widget can still be the sync of a local echo.
+        if (widget == nullptr)
+                widget = eventIds_.value(QString::fromStdString(utils::event_id(event)));
+
+        if (widget != nullptr)
+                renderedEvents_.emplace(widget, event);
+}
+
+bool
+TimelineView::discardEvent(const QString &event_id)
+{
+        const auto id      = event_id.toStdString();
+        const auto matches = [&id](const TimelineEvent &e) { return utils::event_id(e) == id; };
+
+        const auto top    = topMessages_.size() + topRenderQueue_.size();
+        const auto bottom = bottomMessages_.size() + bottomRenderQueue_.size();
+
+        topMessages_.erase(std::remove_if(topMessages_.begin(), topMessages_.end(), matches),
+                           topMessages_.end());
+        bottomMessages_.erase(
+          std::remove_if(bottomMessages_.begin(), bottomMessages_.end(), matches),
+          bottomMessages_.end());
+        topRenderQueue_.erase(
+          std::remove_if(topRenderQueue_.begin(), topRenderQueue_.end(), matches),
+          topRenderQueue_.end());
+        bottomRenderQueue_.erase(
+          std::remove_if(bottomRenderQueue_.begin(), bottomRenderQueue_.end(), matches),
+          bottomRenderQueue_.end());
+
+        if (auto recycled = recycledWidgets_.take(event_id)) {
+                recycleOrder_.removeOne(event_id);
+                recycled->deleteLater();
+        }
+
+        return top != topMessages_.size() + topRenderQueue_.size() ||
+               bottom != bottomMessages_.size() + bottomRenderQueue_.size();
+}
+
 void
 TimelineView::scrollDown()
 {
@@ -150,20 +494,28 @@ TimelineView::sliderMoved(int position)
 
         toggleScrollDownButton();
 
-        // The scrollbar is high enough so we can start retrieving old events.
-        if (position < SCROLL_BAR_GAP) {
-                if (isTimelineFinished)
-                        return;
+        // Follow how fast the user is moving towards the top.
+        const auto elapsed = scrollClock_.restart();
+        if (elapsed > 0 && elapsed < SCROLL_VELOCITY_WINDOW_MS) {
+                const double velocity = 1000.0 * (lastScrollPosition_ - position) / elapsed;
+                scrollVelocity_       = 0.7 * scrollVelocity_ + 0.3 * std::max(velocity, 0.0);
+        } else {
+                scrollVelocity_ = 0;
+        }
+        lastScrollPosition_ = position;
 
-                // Prevent user from moving up when there is pagination in
-                // progress.
-                if (isPaginationInProgress_)
-                        return;
+        // The scrollbar is high enough so we can show the events fetched ahead.
+        if (position < SCROLL_BAR_GAP && !topMessages_.empty())
+                renderBufferedHistory();
 
-                isPaginationInProgress_ = true;
+        // The bottom of the rendered window is reached before the newest events.
+        const int max = scroll_area_->verticalScrollBar()->maximum();
+        if (isDetached_ && max - position < SCROLL_BAR_GAP)
+                renderNewerEvents();
 
-                getMessages();
-        }
+        prefetchHistory();
+
+        trimTimer_->start();
 }
 
 bool
@@ -185,6 +537,9 @@ TimelineView::addBackwardsEvents(const mtx::responses::Messages &msgs)
 
         isTimelineFinished = false;
 
+        if (!msgs.chunk.empty())
+                historyStart_ = messageKey(msgs.chunk.back());
+
         // Queue incoming messages to be rendered later.
         topMessages_.insert(topMessages_.end(),
                             std::make_move_iterator(msgs.chunk.begin()),
@@ -196,11 +551,9 @@ TimelineView::addBackwardsEvents(const mtx::responses::Messages &msgs)
         if (!topMessages_.empty() && scroll_layout_->count() == 0)
                 notifyForLastEvent(findFirstViewableEvent(topMessages_));
 
-        if (isVisible()) {
-                renderTopEvents(topMessages_);
-
-                // Free up space for new messages.
-                topMessages_.clear();
+        // Only the events the user is about to reach are turned into widgets.
+        if (isVisible() && scroll_area_->verticalScrollBar()->value() < SCROLL_BAR_GAP) {
+                renderBufferedHistory();
 
                 // Send a read receipt for the last event.
                 if (isActiveWindow())
@@ -209,6 +562,9 @@ TimelineView::addBackwardsEvents(const mtx::responses::Messages &msgs)
 
         prev_batch_token_       = QString::fromStdString(msgs.end);
         isPaginationInProgress_ = false;
+
+        if (isVisible())
+                prefetchHistory();
 }
 
 QWidget *
@@ -232,6 +588,8 @@ TimelineView::parseMessageEvent(const mtx::events::collections::TimelineEvents &
                 QTimer::singleShot(0, this, [event_id, this]() {
                         if (eventIds_.contains(event_id))
                                 removeEvent(event_id);
+                        else
+                                discardEvent(event_id);
                 });
 
                 return nullptr;
@@ -275,7 +633,9 @@ TimelineView::parseMessageEvent(const mtx::events::collections::TimelineEvents &
                 return processMessageEvent<Sticker, StickerItem>(boost::get<Sticker>(event),
                                                                  direction);
         } else if (boost::get<EncryptedEvent<msg::Encrypted>>(&event) != nullptr) {
-                auto res = parseEncryptedEvent(boost::get<EncryptedEvent<msg::Encrypted>>(event));
+                const auto encrypted = boost::get<EncryptedEvent<msg::Encrypted>>(event);
+
+                auto res    = parseEncryptedEvent(encrypted);
                 auto widget = parseMessageEvent(res.event, direction);
 
                 if (widget == nullptr)
@@ -288,6 +648,10 @@ TimelineView::parseMessageEvent(const mtx::events::collections::TimelineEvents &
                 else if (item && !res.isDecrypted)
                         item->addKeyRequestAction();
 
+                // Keep the event around until its session arrives.
+                if (!res.isDecrypted)
+                        undecryptedEvents_[QString::fromStdString(encrypted.event_id)] = encrypted;
+
                 return widget;
         }
 
@@ -372,8 +736,12 @@ TimelineView::parseEncryptedEvent(const mtx::events::EncryptedEvent<mtx::events:
 void
 TimelineView::displayReadReceipts(std::vector<TimelineEvent> events)
 {
-        QtConcurrent::run(
-          [events = std::move(events), room_id = room_id_, local_user = local_user_, this]() {
+        pendingCallbacks_ += 1;
+
+        cache::read(
+          this,
+          [events = std::move(events), room_id = room_id_, local_user = local_user_](
+            Cache *cache) {
                   std::vector<QString> event_ids;
 
                   for (const auto &e : events) {
@@ -382,8 +750,10 @@ TimelineView::displayReadReceipts(std::vector<TimelineEvent> events)
                                     QString::fromStdString(utils::event_id(e)));
                   }
 
-                  auto readEvents =
-                    cache::client()->filterReadEvents(room_id, event_ids, local_user.toStdString());
+                  return cache->filterReadEvents(room_id, event_ids, local_user.toStdString());
+          },
+          [this](const std::vector<QString> &readEvents) {
+                  pendingCallbacks_ -= 1;
 
                   if (!readEvents.empty())
                           emit markReadEvents(readEvents);
@@ -393,31 +763,122 @@ TimelineView::displayReadReceipts(std::vector<TimelineEvent> events)
 void
 TimelineView::renderBottomEvents(const std::vector<TimelineEvent> &events)
 {
-        int counter = 0;
+        auto first = events.cbegin();
+
+        // Only the newest events are visible in an empty timeline. The older ones wait
+        // with the fetched history until the user scrolls to them.
+        if (scroll_layout_->count() == 0 && topRenderQueue_.empty() &&
+            bottomRenderQueue_.empty() && events.size() > HISTORY_RENDER_BATCH) {
+                first = events.cend() - HISTORY_RENDER_BATCH;
+                topMessages_.insert(topMessages_.begin(),
+                                    std::vector<TimelineEvent>::const_reverse_iterator(first),
+                                    events.crend());
+        }
+
+        bottomRenderQueue_.insert(bottomRenderQueue_.end(), first, events.cend());
+
+        if (!renderTimer_->isActive())
+                renderTimer_->start();
+}
+
+void
+TimelineView::renderTopEvents(const std::vector<TimelineEvent> &events)
+{
+        topRenderQueue_.insert(topRenderQueue_.end(), events.cbegin(), events.cend());
+
+        if (!renderTimer_->isActive())
+                renderTimer_->start();
+}
+
+void
+TimelineView::processRenderQueue()
+{
+        if (topRenderQueue_.empty() && bottomRenderQueue_.empty())
+                return;
+
+        // Every frame the event loop couldn't paint since the previous chunk is dropped.
+        if (renderStats_.chunks == 0)
+                renderStats_.clock.start();
+
+        const auto now = renderStats_.clock.nsecsElapsed() / 1000;
+        if (renderStats_.chunks > 0)
+                renderStats_.droppedFrames +=
+                  static_cast<int>((now - renderStats_.lastChunk) / FRAME_US);
+        renderStats_.lastChunk = now;
+
+        // Fill the side of the timeline the user is looking at first.
+        const bool nearTop = scroll_area_->verticalScrollBar()->value() < SCROLL_BAR_GAP;
+        const bool fromTop = !topRenderQueue_.empty() && (nearTop || bottomRenderQueue_.empty());
 
+        auto &queue = fromTop ? topRenderQueue_ : bottomRenderQueue_;
+        // The chunk is sized after the time the previous widgets took to create.
+        const auto budget = std::max(RENDER_BUDGET_US / renderCost_, 1.0);
+        const auto count  = std::min(queue.size(), static_cast<std::size_t>(budget));
+
+        std::vector<TimelineEvent> events(std::make_move_iterator(queue.begin()),
+                                          std::make_move_iterator(queue.begin() + count));
+        queue.erase(queue.begin(), queue.begin() + count);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // The widgets are laid out and painted once for the whole chunk.
+        setUpdatesEnabled(false);
+
+        if (fromTop)
+                renderTopChunk(events);
+        else
+                renderBottomChunk(events);
+
+        scroll_layout_->invalidate();
+        setUpdatesEnabled(true);
+
+        const double cost = timer.nsecsElapsed() / 1000.0 / count;
+        renderCost_       = 0.7 * renderCost_ + 0.3 * cost;
+
+        renderStats_.chunks += 1;
+        renderStats_.events += static_cast<int>(count);
+        renderStats_.bottom |= !fromTop;
+
+        if (!topRenderQueue_.empty() || !bottomRenderQueue_.empty()) {
+                renderTimer_->start();
+                return;
+        }
+
+        nhlog::ui()->debug("[{}] rendered {} events in {} chunks over {} ms, {} dropped frames",
+                           room_id_.toStdString(),
+                           renderStats_.events,
+                           renderStats_.chunks,
+                           renderStats_.clock.elapsed(),
+                           renderStats_.droppedFrames);
+
+        // Send a read receipt for the last event.
+        if (renderStats_.bottom && isVisible() && isActiveWindow())
+                readLastEvent();
+
+        renderStats_ = RenderStats();
+
+        trimTimer_->start();
+}
+
+void
+TimelineView::renderBottomChunk(const std::vector<TimelineEvent> &events)
+{
         for (const auto &event : events) {
-                QWidget *item = parseMessageEvent(event, TimelineDirection::Bottom);
+                QWidget *item = createWidget(event, TimelineDirection::Bottom);
+                trackRenderedEvent(item, event);
 
-                if (item != nullptr) {
+                if (item != nullptr)
                         addTimelineItem(item, TimelineDirection::Bottom);
-                        counter++;
-
-                        // Prevent blocking of the event-loop
-                        // by calling processEvents every 10 items we render.
-                        if (counter % 4 == 0)
-                                QApplication::processEvents();
-                }
         }
 
         lastMessageDirection_ = TimelineDirection::Bottom;
 
         displayReadReceipts(events);
-
-        QApplication::processEvents();
 }
 
 void
-TimelineView::renderTopEvents(const std::vector<TimelineEvent> &events)
+TimelineView::renderTopChunk(const std::vector<TimelineEvent> &events)
 {
         std::vector<QWidget *> items;
 
@@ -428,7 +889,8 @@ TimelineView::renderTopEvents(const std::vector<TimelineEvent> &events)
 
         // Parse in reverse order to determine where we should not show sender's name.
         for (auto it = events.rbegin(); it != events.rend(); ++it) {
-                auto item = parseMessageEvent(*it, TimelineDirection::Top);
+                auto item = createWidget(*it, TimelineDirection::Top);
+                trackRenderedEvent(item, *it);
 
                 if (item != nullptr)
                         items.push_back(item);
@@ -445,8 +907,6 @@ TimelineView::renderTopEvents(const std::vector<TimelineEvent> &events)
 
         lastMessageDirection_ = TimelineDirection::Top;
 
-        QApplication::processEvents();
-
         displayReadReceipts(events);
 
         // If this batch is the first being rendered (i.e the first and the last
@@ -471,6 +931,9 @@ TimelineView::addEvents(const mtx::responses::Timeline &timeline)
                 isInitialSync     = false;
         }
 
+        if (historyStart_.empty() && !timeline.events.empty())
+                historyStart_ = messageKey(timeline.events.front());
+
         bottomMessages_.insert(bottomMessages_.end(),
                                std::make_move_iterator(timeline.events.begin()),
                                std::make_move_iterator(timeline.events.end()));
@@ -479,15 +942,13 @@ TimelineView::addEvents(const mtx::responses::Timeline &timeline)
                 notifyForLastEvent(findLastViewableEvent(bottomMessages_));
 
         // If the current timeline is open and there are messages to be rendered.
-        if (isVisible() && !bottomMessages_.empty()) {
+        // A timeline scrolled away from its newest events renders them once they're reached.
+        if (isVisible() && !isDetached_ && !bottomMessages_.empty()) {
                 renderBottomEvents(bottomMessages_);
 
                 // Free up space for new messages.
+                // The read receipt is sent once the events are rendered.
                 bottomMessages_.clear();
-
-                // Send a read receipt for the last event.
-                if (isActiveWindow())
-                        readLastEvent();
         }
 }
 
@@ -502,6 +963,12 @@ TimelineView::init()
         scrollDownBtn_->hide();
 
         connect(scrollDownBtn_, &QPushButton::clicked, this, [this]() {
+                // Start again from the newest events instead of rendering everything between.
+                if (isDetached_) {
+                        reattach();
+                        return;
+                }
+
                 const int max = scroll_area_->verticalScrollBar()->maximum();
                 scroll_area_->verticalScrollBar()->setValue(max);
         });
@@ -536,7 +1003,33 @@ TimelineView::init()
         paginationTimer_ = new QTimer(this);
         connect(paginationTimer_, &QTimer::timeout, this, &TimelineView::fetchHistory);
 
-        connect(this, &TimelineView::messagesRetrieved, this, &TimelineView::addBackwardsEvents);
+        trimTimer_ = new QTimer(this);
+        trimTimer_->setSingleShot(true);
+        trimTimer_->setInterval(TRIM_DELAY_MS);
+        connect(trimTimer_, &QTimer::timeout, this, &TimelineView::trimTimeline);
+
+        renderTimer_ = new QTimer(this);
+        renderTimer_->setSingleShot(true);
+        renderTimer_->setInterval(0);
+        connect(renderTimer_, &QTimer::timeout, this, &TimelineView::processRenderQueue);
+
+        connect(this,
+                &TimelineView::messagesRetrieved,
+                this,
+                [this](const mtx::responses::Messages &msgs, int request) {
+                        historyFetches_ -= 1;
+
+                        if (request == historyRequest_)
+                                addBackwardsEvents(msgs);
+                });
+        connect(this, &TimelineView::messagesFailed, this, [this](int request) {
+                historyFetches_ -= 1;
+
+                if (request == historyRequest_)
+                        isPaginationInProgress_ = false;
+        });
+
+        scrollClock_.start();
 
         connect(this, &TimelineView::messageFailed, this, &TimelineView::handleFailedMessage);
         connect(this, &TimelineView::messageSent, this, &TimelineView::updatePendingMessage);
@@ -570,22 +1063,74 @@ TimelineView::init()
 
 void
 TimelineView::getMessages()
+{
+        const auto room_id = room_id_.toStdString();
+        const auto before  = historyStart_;
+        const auto request = historyRequest_;
+
+        cache::read(this,
+                    [room_id, before](Cache *cache) {
+                            return cache->readHistory(room_id, before, HISTORY_PAGE_SIZE);
+                    },
+                    [this, request](const HistoryPage &page) {
+                            if (request != historyRequest_)
+                                    return;
+
+                            if (!page.prev_batch.empty())
+                                    prev_batch_token_ = QString::fromStdString(page.prev_batch);
+
+                            if (!page.events.empty()) {
+                                    mtx::responses::Messages msgs;
+                                    msgs.chunk = page.events;
+                                    msgs.end   = prev_batch_token_.toStdString();
+
+                                    addBackwardsEvents(msgs);
+                                    isTimelineFinished = page.complete;
+                            } else if (page.complete) {
+                                    isTimelineFinished      = true;
+                                    isPaginationInProgress_ = false;
+                            } else {
+                                    fetchMessages(request);
+                            }
+                    });
+}
+
+void
+TimelineView::fetchMessages(int request)
 {
         mtx::http::MessagesOpts opts;
         opts.room_id = room_id_.toStdString();
         opts.from    = prev_batch_token_.toStdString();
 
+        const auto anchor = historyStart_;
+
+        historyFetches_ += 1;
+
         http::client()->messages(
-          opts, [this, opts](const mtx::responses::Messages &res, mtx::http::RequestErr err) {
+          opts,
+          [this, opts, anchor, request](const mtx::responses::Messages &res,
+                                        mtx::http::RequestErr err) {
                   if (err) {
                           nhlog::net()->error("failed to call /messages ({}): {} - {}",
                                               opts.room_id,
                                               mtx::errors::to_string(err->matrix_error.errcode),
                                               err->matrix_error.error);
+                          emit messagesFailed(request);
                           return;
                   }
 
-                  emit messagesRetrieved(std::move(res));
+                  // Keep the page so the next visit can be served from the cache.
+                  try {
+                          cache::client()->saveHistory(opts.room_id, anchor, res);
+                  } catch (const lmdb::error &e) {
+                          nhlog::db()->warn(
+                            "failed to save the history of {}: {}", opts.room_id, e.what());
+                  } catch (const json::exception &e) {
+                          nhlog::db()->warn(
+                            "failed to save the history of {}: {}", opts.room_id, e.what());
+                  }
+
+                  emit messagesRetrieved(std::move(res), request);
           });
 }
 
@@ -692,6 +1237,10 @@ TimelineView::updatePendingMessage(const std::string &txn_id, const QString &eve
 void
 TimelineView::addUserMessage(mtx::events::MessageType ty, const QString &body)
 {
+        // The echo belongs below the newest events, not below older ones scrolled back to.
+        if (isDetached_)
+                reattach();
+
         auto with_sender = (lastSender_ != local_user_) || isDateDifference(lastMsgTimestamp_);
 
         TimelineItem *view_item =
@@ -937,17 +1486,19 @@ TimelineView::readLastEvent() const
 
         const auto eventId = getLastEventId();
 
-        if (!eventId.isEmpty())
-                http::client()->read_event(room_id_.toStdString(),
-                                           eventId.toStdString(),
-                                           [this, eventId](mtx::http::RequestErr err) {
-                                                   if (err) {
-                                                           nhlog::net()->warn(
-                                                             "failed to read event ({}, {})",
-                                                             room_id_.toStdString(),
-                                                             eventId.toStdString());
-                                                   }
-                                           });
+        if (eventId.isEmpty())
+                return;
+
+        // The callback doesn't refer to the view, which might be gone by then.
+        http::client()->read_event(
+          room_id_.toStdString(),
+          eventId.toStdString(),
+          [room_id = room_id_.toStdString(), eventId](mtx::http::RequestErr err) {
+                  if (err) {
+                          nhlog::net()->warn(
+                            "failed to read event ({}, {})", room_id, eventId.toStdString());
+                  }
+          });
 }
 
 QString
@@ -972,10 +1523,8 @@ TimelineView::getLastEventId() const
 void
 TimelineView::showEvent(QShowEvent *event)
 {
-        if (!topMessages_.empty()) {
-                renderTopEvents(topMessages_);
-                topMessages_.clear();
-        }
+        if (!topMessages_.empty())
+                renderBufferedHistory();
 
         if (!bottomMessages_.empty()) {
                 renderBottomEvents(bottomMessages_);
@@ -997,7 +1546,9 @@ TimelineView::hideEvent(QHideEvent *event)
         const auto widgetsNum   = scroll_layout_->count();
 
         // Remove widgets from the timeline to reduce the memory footprint.
-        if (handleHeight < MIN_SCROLLBAR_HANDLE && widgetsNum > MAX_RETAINED_WIDGETS)
+        // A timeline away from its newest events is opened again from them.
+        if ((handleHeight < MIN_SCROLLBAR_HANDLE && widgetsNum > MAX_RETAINED_WIDGETS) ||
+            isDetached_)
                 clearTimeline();
 
         QWidget::hideEvent(event);
@@ -1015,16 +1566,47 @@ TimelineView::event(QEvent *event)
 void
 TimelineView::clearTimeline()
 {
-        // Delete all widgets.
+        std::set<QWidget *> pending;
+        for (const auto &msg : pending_msgs_)
+                pending.insert(msg.widget.data());
+        for (const auto &msg : pending_sent_msgs_)
+                pending.insert(msg.widget.data());
+
+        // Delete all widgets, except for the local echoes still waiting for the server.
+        std::vector<QWidget *> echoes;
         QLayoutItem *item;
         while ((item = scroll_layout_->takeAt(0)) != nullptr) {
-                delete item->widget();
+                if (pending.count(item->widget()) != 0)
+                        echoes.push_back(item->widget());
+                else
+                        delete item->widget();
                 delete item;
         }
 
+        for (auto widget : recycledWidgets_)
+                delete widget;
+
+        renderTimer_->stop();
+        topRenderQueue_.clear();
+        bottomRenderQueue_.clear();
+        renderStats_ = RenderStats();
+
+        recycledWidgets_.clear();
+        recycleOrder_.clear();
+        renderedEvents_.clear();
+
+        isDetached_         = false;
+        pendingScrollValue_ = -1;
+
         // The next call to /messages will be without a prev token.
         prev_batch_token_.clear();
+        historyStart_.clear();
+
+        // Pagination requests in flight belong to the removed events.
+        historyRequest_ += 1;
+        isPaginationInProgress_ = false;
         eventIds_.clear();
+        undecryptedEvents_.clear();
 
         // Clear queues with pending messages to be rendered.
         bottomMessages_.clear();
@@ -1032,6 +1614,23 @@ TimelineView::clearTimeline()
 
         firstSender_.clear();
         lastSender_.clear();
+
+        // The history is fetched again above the echoes.
+        for (auto widget : echoes)
+                pushTimelineItem(widget, TimelineDirection::Bottom);
+
+        // The server already knows about these, the history mustn't show them twice.
+        for (const auto &msg : pending_sent_msgs_) {
+                if (msg.widget && !msg.event_id.isEmpty())
+                        eventIds_[msg.event_id] = msg.widget;
+        }
+}
+
+void
+TimelineView::reattach()
+{
+        clearTimeline();
+        fetchHistory();
 }
 
 void
@@ -1052,12 +1651,17 @@ void
 TimelineView::removeEvent(const QString &event_id)
 {
         if (!eventIds_.contains(event_id)) {
+                // The event might wait outside of the rendered window.
+                if (discardEvent(event_id))
+                        return;
+
                 nhlog::ui()->warn("cannot remove widget with unknown event_id: {}",
                                   event_id.toStdString());
                 return;
         }
 
         auto removedItem = eventIds_[event_id];
+        renderedEvents_.erase(removedItem);
 
         // Find the next and the previous widgets in the timeline
         auto prevWidget = relativeWidget(removedItem, -1);
@@ -1104,12 +1708,83 @@ TimelineView::removeEvent(const QString &event_id)
         // Finally remove the event.
         removedItem->deleteLater();
         eventIds_.remove(event_id);
+        undecryptedEvents_.remove(event_id);
 
         // Update the room list with a view of the last message after
         // all events have been processed.
         QTimer::singleShot(0, this, [this]() { notifyForLastEvent(); });
 }
 
+void
+TimelineView::retryDecryption(const std::vector<std::string> &session_ids)
+{
+        const std::set<std::string> sessions(session_ids.begin(), session_ids.end());
+
+        for (auto it = undecryptedEvents_.begin(); it != undecryptedEvents_.end();) {
+                // The widget was removed in the meantime.
+                if (!eventIds_.contains(it.key())) {
+                        it = undecryptedEvents_.erase(it);
+                        continue;
+                }
+
+                if (sessions.find(it.value().content.session_id) == sessions.end()) {
+                        ++it;
+                        continue;
+                }
+
+                auto res = parseEncryptedEvent(it.value());
+                if (!res.isDecrypted) {
+                        ++it;
+                        continue;
+                }
+
+                replaceEvent(it.key(), res.event);
+                it = undecryptedEvents_.erase(it);
+        }
+}
+
+void
+TimelineView::replaceEvent(const QString &event_id, const TimelineEvent &event)
+{
+        auto oldItem    = eventIds_[event_id];
+        const int index = scroll_layout_->indexOf(oldItem);
+
+        if (index == -1)
+                return;
+
+        // Decide about the sender's name based on the widget that precedes the replaced one.
+        const auto lastSender       = lastSender_;
+        const auto lastMsgTimestamp = lastMsgTimestamp_;
+
+        auto prevItem     = qobject_cast<TimelineItem *>(relativeWidget(oldItem, -1));
+        lastSender_       = prevItem ? prevItem->descriptionMessage().userid : QString();
+        lastMsgTimestamp_ = prevItem ? prevItem->descriptionMessage().datetime : QDateTime();
+
+        eventIds_.remove(event_id);
+        auto widget = parseMessageEvent(event, TimelineDirection::Bottom);
+
+        lastSender_       = lastSender;
+        lastMsgTimestamp_ = lastMsgTimestamp;
+
+        if (widget == nullptr) {
+                eventIds_[event_id] = oldItem;
+                return;
+        }
+
+        if (auto item = qobject_cast<TimelineItem *>(widget))
+                item->markReceived(true);
+
+        // The original event is kept, the widget is decrypted again if it's released.
+        auto rendered = renderedEvents_.find(oldItem);
+        if (rendered != renderedEvents_.end()) {
+                renderedEvents_.emplace(widget, rendered->second);
+                renderedEvents_.erase(rendered);
+        }
+
+        scroll_layout_->insertWidget(index, widget);
+        oldItem->deleteLater();
+}
+
 QWidget *
 TimelineView::relativeWidget(QWidget *item, int dt) const
 {
@@ -1276,7 +1951,6 @@ TimelineView::prepareEncryptedMessage(const PendingMessage &msg)
         const auto room_id = room_id_.toStdString();
 
         using namespace mtx::events;
-        using namespace mtx::identifiers;
 
         json content;
 
@@ -1312,272 +1986,58 @@ TimelineView::prepareEncryptedMessage(const PendingMessage &msg)
 
         json doc{{"type", "m.room.message"}, {"content", content}, {"room_id", room_id}};
 
-        try {
-                // Check if we have already an outbound megolm session then we can use.
-                if (cache::client()->outboundMegolmSessionExists(room_id)) {
+        // The key is shared and the message sent off the GUI thread, where the view can't be
+        // touched. The outcome is queued back to it and dropped if it's gone by then.
+        auto proxy = std::make_shared<EncryptedMessageProxy>();
+        connect(proxy.get(),
+                &EncryptedMessageProxy::messageSent,
+                this,
+                [this, txn_id = msg.txn_id](const QString &event_id) {
+                        emit messageSent(txn_id, event_id);
+                });
+        connect(proxy.get(),
+                &EncryptedMessageProxy::messageFailed,
+                this,
+                [this, txn_id = msg.txn_id]() { emit messageFailed(txn_id); });
+
+        olm::share_megolm_session(room_id, [room_id, doc, txn_id = msg.txn_id, proxy](bool shared) {
+                // The message is retried like any other that failed to send.
+                if (!shared) {
+                        emit proxy->messageFailed();
+                        return;
+                }
+
+                try {
                         auto data = olm::encrypt_group_message(
                           room_id, http::client()->device_id(), doc.dump());
 
                         http::client()->send_room_message<msg::Encrypted, EventType::RoomEncrypted>(
                           room_id,
-                          msg.txn_id,
+                          txn_id,
                           data,
-                          std::bind(&TimelineView::sendRoomMessageHandler,
-                                    this,
-                                    msg.txn_id,
-                                    std::placeholders::_1,
-                                    std::placeholders::_2));
-                        return;
-                }
-
-                nhlog::ui()->debug("creating new outbound megolm session");
-
-                // Create a new outbound megolm session.
-                auto outbound_session  = olm::client()->init_outbound_group_session();
-                const auto session_id  = mtx::crypto::session_id(outbound_session.get());
-                const auto session_key = mtx::crypto::session_key(outbound_session.get());
-
-                // TODO: needs to be moved in the lib.
-                auto megolm_payload = json{{"algorithm", "m.megolm.v1.aes-sha2"},
-                                           {"room_id", room_id},
-                                           {"session_id", session_id},
-                                           {"session_key", session_key}};
-
-                // Saving the new megolm session.
-                // TODO: Maybe it's too early to save.
-                OutboundGroupSessionData session_data;
-                session_data.session_id    = session_id;
-                session_data.session_key   = session_key;
-                session_data.message_index = 0; // TODO Update me
-                cache::client()->saveOutboundMegolmSession(
-                  room_id, session_data, std::move(outbound_session));
-
-                const auto members = cache::client()->roomMembers(room_id);
-                nhlog::ui()->info("retrieved {} members for {}", members.size(), room_id);
-
-                auto keeper = std::make_shared<StateKeeper>(
-                  [megolm_payload, room_id, doc, txn_id = msg.txn_id, this]() {
-                          try {
-                                  auto data = olm::encrypt_group_message(
-                                    room_id, http::client()->device_id(), doc.dump());
-
-                                  http::client()
-                                    ->send_room_message<msg::Encrypted, EventType::RoomEncrypted>(
-                                      room_id,
-                                      txn_id,
-                                      data,
-                                      std::bind(&TimelineView::sendRoomMessageHandler,
-                                                this,
-                                                txn_id,
-                                                std::placeholders::_1,
-                                                std::placeholders::_2));
-
-                          } catch (const lmdb::error &e) {
-                                  nhlog::db()->critical(
-                                    "failed to save megolm outbound session: {}", e.what());
-                          }
-                  });
-
-                mtx::requests::QueryKeys req;
-                for (const auto &member : members)
-                        req.device_keys[member] = {};
-
-                http::client()->query_keys(
-                  req,
-                  [keeper = std::move(keeper), megolm_payload, this](
-                    const mtx::responses::QueryKeys &res, mtx::http::RequestErr err) {
-                          if (err) {
-                                  nhlog::net()->warn("failed to query device keys: {} {}",
-                                                     err->matrix_error.error,
-                                                     static_cast<int>(err->status_code));
-                                  // TODO: Mark the event as failed. Communicate with the UI.
-                                  return;
-                          }
-
-                          for (const auto &user : res.device_keys) {
-                                  // Mapping from a device_id with valid identity keys to the
-                                  // generated room_key event used for sharing the megolm session.
-                                  std::map<std::string, std::string> room_key_msgs;
-                                  std::map<std::string, DevicePublicKeys> deviceKeys;
-
-                                  room_key_msgs.clear();
-                                  deviceKeys.clear();
-
-                                  for (const auto &dev : user.second) {
-                                          const auto user_id   = UserId(dev.second.user_id);
-                                          const auto device_id = DeviceId(dev.second.device_id);
-
-                                          const auto device_keys = dev.second.keys;
-                                          const auto curveKey    = "curve25519:" + device_id.get();
-                                          const auto edKey       = "ed25519:" + device_id.get();
-
-                                          if ((device_keys.find(curveKey) == device_keys.end()) ||
-                                              (device_keys.find(edKey) == device_keys.end())) {
-                                                  nhlog::net()->debug(
-                                                    "ignoring malformed keys for device {}",
-                                                    device_id.get());
-                                                  continue;
-                                          }
-
-                                          DevicePublicKeys pks;
-                                          pks.ed25519    = device_keys.at(edKey);
-                                          pks.curve25519 = device_keys.at(curveKey);
-
-                                          try {
-                                                  if (!mtx::crypto::verify_identity_signature(
-                                                        json(dev.second), device_id, user_id)) {
-                                                          nhlog::crypto()->warn(
-                                                            "failed to verify identity keys: {}",
-                                                            json(dev.second).dump(2));
-                                                          continue;
-                                                  }
-                                          } catch (const json::exception &e) {
-                                                  nhlog::crypto()->warn(
-                                                    "failed to parse device key json: {}",
-                                                    e.what());
-                                                  continue;
-                                          } catch (const mtx::crypto::olm_exception &e) {
-                                                  nhlog::crypto()->warn(
-                                                    "failed to verify device key json: {}",
-                                                    e.what());
-                                                  continue;
-                                          }
-
-                                          auto room_key = olm::client()
-                                                            ->create_room_key_event(
-                                                              user_id, pks.ed25519, megolm_payload)
-                                                            .dump();
-
-                                          room_key_msgs.emplace(device_id, room_key);
-                                          deviceKeys.emplace(device_id, pks);
-                                  }
-
-                                  std::vector<std::string> valid_devices;
-                                  valid_devices.reserve(room_key_msgs.size());
-                                  for (auto const &d : room_key_msgs) {
-                                          valid_devices.push_back(d.first);
-
-                                          nhlog::net()->info("{}", d.first);
-                                          nhlog::net()->info("  curve25519 {}",
-                                                             deviceKeys.at(d.first).curve25519);
-                                          nhlog::net()->info("  ed25519 {}",
-                                                             deviceKeys.at(d.first).ed25519);
+                          [proxy, txn_id](const mtx::responses::EventId &res,
+                                          mtx::http::RequestErr err) {
+                                  if (err) {
+                                          nhlog::net()->warn(
+                                            "[{}] failed to send message: {} {}",
+                                            txn_id,
+                                            err->matrix_error.error,
+                                            static_cast<int>(err->status_code));
+                                          emit proxy->messageFailed();
+                                          return;
                                   }
 
-                                  nhlog::net()->info(
-                                    "sending claim request for user {} with {} devices",
-                                    user.first,
-                                    valid_devices.size());
-
-                                  http::client()->claim_keys(
-                                    user.first,
-                                    valid_devices,
-                                    std::bind(&TimelineView::handleClaimedKeys,
-                                              this,
-                                              keeper,
-                                              room_key_msgs,
-                                              deviceKeys,
-                                              user.first,
-                                              std::placeholders::_1,
-                                              std::placeholders::_2));
-
-                                  // TODO: Wait before sending the next batch of requests.
-                                  std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                          }
-                  });
-
-                // TODO: Let the user know about the errors.
-        } catch (const lmdb::error &e) {
-                nhlog::db()->critical(
-                  "failed to open outbound megolm session ({}): {}", room_id, e.what());
-        } catch (const mtx::crypto::olm_exception &e) {
-                nhlog::crypto()->critical(
-                  "failed to open outbound megolm session ({}): {}", room_id, e.what());
-        }
-}
-
-void
-TimelineView::handleClaimedKeys(std::shared_ptr<StateKeeper> keeper,
-                                const std::map<std::string, std::string> &room_keys,
-                                const std::map<std::string, DevicePublicKeys> &pks,
-                                const std::string &user_id,
-                                const mtx::responses::ClaimKeys &res,
-                                mtx::http::RequestErr err)
-{
-        if (err) {
-                nhlog::net()->warn("claim keys error: {} {} {}",
-                                   err->matrix_error.error,
-                                   err->parse_error,
-                                   static_cast<int>(err->status_code));
-                return;
-        }
-
-        nhlog::net()->debug("claimed keys for {}", user_id);
-
-        if (res.one_time_keys.size() == 0) {
-                nhlog::net()->debug("no one-time keys found for user_id: {}", user_id);
-                return;
-        }
-
-        if (res.one_time_keys.find(user_id) == res.one_time_keys.end()) {
-                nhlog::net()->debug("no one-time keys found for user_id: {}", user_id);
-                return;
-        }
-
-        auto retrieved_devices = res.one_time_keys.at(user_id);
-
-        // Payload with all the to_device message to be sent.
-        json body;
-        body["messages"][user_id] = json::object();
-
-        for (const auto &rd : retrieved_devices) {
-                const auto device_id = rd.first;
-                nhlog::net()->debug("{} : \n {}", device_id, rd.second.dump(2));
-
-                // TODO: Verify signatures
-                auto otk = rd.second.begin()->at("key");
-
-                if (pks.find(device_id) == pks.end()) {
-                        nhlog::net()->critical("couldn't find public key for device: {}",
-                                               device_id);
-                        continue;
-                }
-
-                auto id_key = pks.at(device_id).curve25519;
-                auto s      = olm::client()->create_outbound_session(id_key, otk);
-
-                if (room_keys.find(device_id) == room_keys.end()) {
-                        nhlog::net()->critical("couldn't find m.room_key for device: {}",
-                                               device_id);
-                        continue;
-                }
-
-                auto device_msg = olm::client()->create_olm_encrypted_content(
-                  s.get(), room_keys.at(device_id), pks.at(device_id).curve25519);
-
-                try {
-                        cache::client()->saveOlmSession(id_key, std::move(s));
+                                  emit proxy->messageSent(
+                                    QString::fromStdString(res.event_id.to_string()));
+                          });
                 } catch (const lmdb::error &e) {
-                        nhlog::db()->critical("failed to save outbound olm session: {}", e.what());
+                        nhlog::db()->critical(
+                          "failed to save megolm outbound session: {}", e.what());
+                        emit proxy->messageFailed();
                 } catch (const mtx::crypto::olm_exception &e) {
-                        nhlog::crypto()->critical("failed to pickle outbound olm session: {}",
-                                                  e.what());
+                        nhlog::crypto()->critical(
+                          "failed to encrypt message ({}): {}", room_id, e.what());
+                        emit proxy->messageFailed();
                 }
-
-                body["messages"][user_id][device_id] = device_msg;
-        }
-
-        nhlog::net()->info("send_to_device: {}", user_id);
-
-        http::client()->send_to_device(
-          "m.room.encrypted", body, [keeper](mtx::http::RequestErr err) {
-                  if (err) {
-                          nhlog::net()->warn("failed to send "
-                                             "send_to_device "
-                                             "message: {}",
-                                             err->matrix_error.error);
-                  }
-
-                  (void)keeper;
-          });
+        });
 }
@@ -17,9 +17,13 @@
 
 #pragma once
 
+#include <deque>
+
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QLayout>
 #include <QList>
+#include <QPointer>
 #include <QQueue>
 #include <QScrollArea>
 #include <QScrollBar>
@@ -33,19 +37,6 @@
 #include "MatrixClient.h"
 #include "timeline/TimelineItem.h"
 
-class StateKeeper
-{
-public:
-        StateKeeper(std::function<void()> &&fn)
-          : fn_(std::move(fn))
-        {}
-
-        ~StateKeeper() { fn_(); }
-
-private:
-        std::function<void()> fn_;
-};
-
 struct DecryptionResult
 {
         //! The decrypted content as a normal plaintext event.
@@ -68,7 +59,7 @@ struct PendingMessage
         QString mime;
         uint64_t media_size;
         QString event_id;
-        TimelineItem *widget;
+        QPointer<TimelineItem> widget;
         QSize dimensions;
         bool is_encrypted = false;
 };
@@ -101,6 +92,17 @@ template<>
 mtx::events::msg::Video
 toRoomMessage<mtx::events::msg::Video>(const PendingMessage &m);
 
+//! Carries the outcome of an encrypted message from the threads that share the room key
+//! and send it back to the thread of its view, which may be gone by then.
+class EncryptedMessageProxy : public QObject
+{
+        Q_OBJECT
+
+signals:
+        void messageSent(const QString &event_id);
+        void messageFailed();
+};
+
 // In which place new TimelineItems should be inserted.
 enum class TimelineDirection
 {
@@ -133,7 +135,13 @@ public:
 
         //! Remove an item from the timeline with the given Event ID.
         void removeEvent(const QString &event_id);
+        //! Decrypt again the events that were waiting on the given megolm sessions.
+        void retryDecryption(const std::vector<std::string> &session_ids);
         void setPrevBatchToken(const QString &token) { prev_batch_token_ = token; }
+        //! Fetch the first page of history before the room is opened.
+        void prefetch();
+        //! Drop the history fetched ahead if the room wasn't opened in the meantime.
+        void cancelPrefetch();
 
 public slots:
         void sliderRangeChanged(int min, int max);
@@ -145,6 +153,14 @@ public slots:
 
         // Whether or not the initial batch has been loaded.
         bool hasLoaded() { return scroll_layout_->count() > 0 || isTimelineFinished; }
+        //! Number of widgets currently in the timeline.
+        int renderedItems() const { return scroll_layout_->count(); }
+        //! Whether there are server requests or cache reads that will call back into the view.
+        bool hasPendingRequests() const
+        {
+                return historyFetches_ > 0 || pendingCallbacks_ > 0 || !pending_msgs_.isEmpty() ||
+                       !pending_sent_msgs_.isEmpty();
+        }
 
         void handleFailedMessage(const std::string &txn_id);
 
@@ -153,7 +169,8 @@ private slots:
 
 signals:
         void updateLastTimelineMessage(const QString &user, const DescInfo &info);
-        void messagesRetrieved(const mtx::responses::Messages &res);
+        void messagesRetrieved(const mtx::responses::Messages &res, int request);
+        void messagesFailed(int request);
         void messageFailed(const std::string &txn_id);
         void messageSent(const std::string &txn_id, const QString &event_id);
         void markReadEvents(const std::vector<QString> &event_ids);
@@ -173,42 +190,53 @@ private:
         bool isStartOfTimeline(const mtx::responses::Messages &msgs);
 
         QWidget *relativeWidget(QWidget *item, int dt) const;
+        //! Replace the widget of the given event in place.
+        void replaceEvent(const QString &event_id, const TimelineEvent &event);
 
         DecryptionResult parseEncryptedEvent(
           const mtx::events::EncryptedEvent<mtx::events::msg::Encrypted> &e);
 
-        void handleClaimedKeys(std::shared_ptr<StateKeeper> keeper,
-                               const std::map<std::string, std::string> &room_key,
-                               const std::map<std::string, DevicePublicKeys> &pks,
-                               const std::string &user_id,
-                               const mtx::responses::ClaimKeys &res,
-                               mtx::http::RequestErr err);
-
         //! Callback for all message sending.
         void sendRoomMessageHandler(const std::string &txn_id,
                                     const mtx::responses::EventId &res,
                                     mtx::http::RequestErr err);
         void prepareEncryptedMessage(const PendingMessage &msg);
 
-        //! Call the /messages endpoint to fill the timeline.
+        //! Fill the timeline with older events, from the cache when they are stored.
         void getMessages();
-        //! HACK: Fixing layout flickering when adding to the bottom
-        //! of the timeline.
+        //! Call the /messages endpoint to fill the timeline.
+        void fetchMessages(int request);
+        //! Keep enough older events fetched to cover the next screens the user scrolls to.
+        void prefetchHistory();
+        //! Turn the next batch of fetched older events into widgets.
+        void renderBufferedHistory();
+        //! Turn the next batch of the events below the rendered window into widgets.
+        void renderNewerEvents();
+        //! Move the widgets far from the viewport back into the event buffers.
+        void trimTimeline();
+        //! Take a widget out of the timeline, keeping it for reuse if it represents an event.
+        void releaseWidget(QWidget *widget);
+        //! Create the widget of an event, reusing a released one when possible.
+        QWidget *createWidget(const TimelineEvent &event, TimelineDirection direction);
+        //! Remember the event of a rendered widget, or of the local echo that represents it.
+        void trackRenderedEvent(QWidget *widget, const TimelineEvent &event);
+        //! Drop an event that waits outside of the rendered window.
+        bool discardEvent(const QString &event_id);
+        //! Turn the next queued events into widgets, within the time budget of a frame.
+        void processRenderQueue();
+        //! Add widgets for the given events to the top of the timeline.
+        void renderTopChunk(const std::vector<TimelineEvent> &events);
+        //! Add widgets for the given events to the bottom of the timeline.
+        void renderBottomChunk(const std::vector<TimelineEvent> &events);
+        //! Insert a widget at either end of the timeline. Released widgets are hidden.
         void pushTimelineItem(QWidget *item, TimelineDirection dir)
         {
-                setUpdatesEnabled(false);
-                item->hide();
-
                 if (dir == TimelineDirection::Top)
                         scroll_layout_->insertWidget(0, item);
                 else
                         scroll_layout_->addWidget(item);
 
-                QTimer::singleShot(0, this, [item, this]() {
-                        item->show();
-                        item->adjustSize();
-                        setUpdatesEnabled(true);
-                });
+                item->show();
         }
 
         //! Decides whether or not to show or hide the scroll down button.
@@ -284,8 +312,11 @@ private:
 
         //! Store the event id associated with the given widget.
         void saveEventId(QWidget *widget);
-        //! Remove all widgets from the timeline layout.
+        //! Remove all widgets from the timeline layout. The local echoes of the messages
+        //! still being sent stay at the bottom.
         void clearTimeline();
+        //! Open the timeline again from its newest events.
+        void reattach();
 
         QVBoxLayout *top_layout_;
         QVBoxLayout *scroll_layout_;
@@ -302,6 +333,20 @@ private:
         QString prev_batch_token_;
         QString local_user_;
 
+        //! Message key of the oldest event in the timeline. Pagination continues from it.
+        std::string historyStart_;
+        //! Identifies the pagination requests. Answers to older requests are dropped.
+        int historyRequest_ = 0;
+        //! Number of /messages requests still running, including the dropped ones.
+        int historyFetches_ = 0;
+        //! Number of cache reads whose results will be delivered to the view.
+        int pendingCallbacks_ = 0;
+
+        //! Speed of the scrolling towards the top of the timeline in pixels per second.
+        double scrollVelocity_  = 0;
+        int lastScrollPosition_ = 0;
+        QElapsedTimer scrollClock_;
+
         bool isPaginationInProgress_ = false;
 
         // Keeps track whether or not the user has visited the view.
@@ -316,6 +361,13 @@ private:
         int scroll_height_       = 0;
         int previous_max_height_ = 0;
 
+        //! Scroll position that keeps the viewport in place once the layout catches up
+        //! with the widgets removed by a trim.
+        int pendingScrollValue_ = -1;
+        //! Whether newer events than the rendered ones wait in bottomMessages_.
+        bool isDetached_ = false;
+        QTimer *trimTimer_;
+
         int oldPosition_;
         int oldHeight_;
 
@@ -325,16 +377,45 @@ private:
 
         //! Messages received by sync not added to the timeline.
         std::vector<TimelineEvent> bottomMessages_;
-        //! Messages received by /messages not added to the timeline.
+        //! Messages received by /messages not added to the timeline, from the newest to the
+        //! oldest. They are kept ahead of the scroll position.
         std::vector<TimelineEvent> topMessages_;
 
-        //! Render the given timeline events to the bottom of the timeline.
+        //! Queue the given timeline events to be rendered to the bottom of the timeline.
         void renderBottomEvents(const std::vector<TimelineEvent> &events);
-        //! Render the given timeline events to the top of the timeline.
+        //! Queue the given timeline events to be rendered to the top of the timeline.
         void renderTopEvents(const std::vector<TimelineEvent> &events);
 
+        //! Events waiting to become widgets at the top, from the newest to the oldest.
+        std::deque<TimelineEvent> topRenderQueue_;
+        //! Events waiting to become widgets at the bottom, from the oldest to the newest.
+        std::deque<TimelineEvent> bottomRenderQueue_;
+        //! Runs a chunk of the render queues on each pass of the event loop.
+        QTimer *renderTimer_;
+        //! Average time it takes to create the widget of an event, in microseconds.
+        double renderCost_ = 500;
+
+        //! Measurements of the rendering since the render queues were last empty.
+        struct RenderStats
+        {
+                QElapsedTimer clock;
+                qint64 lastChunk  = 0;
+                int chunks        = 0;
+                int events        = 0;
+                int droppedFrames = 0;
+                bool bottom       = false;
+        } renderStats_;
+
         // The events currently rendered. Used for duplicate detection.
         QMap<QString, QWidget *> eventIds_;
+        //! The events of the rendered widgets, moved back to the buffers by the trims.
+        std::map<QWidget *, TimelineEvent> renderedEvents_;
+        //! Widgets of the events that recently left the rendered window, by event id.
+        QMap<QString, QWidget *> recycledWidgets_;
+        //! Order in which the widgets were recycled, the oldest first.
+        QQueue<QString> recycleOrder_;
+        //! Rendered events that couldn't be decrypted yet.
+        QMap<QString, mtx::events::EncryptedEvent<mtx::events::msg::Encrypted>> undecryptedEvents_;
         QQueue<PendingMessage> pending_msgs_;
         QList<PendingMessage> pending_sent_msgs_;
 };
@@ -347,6 +428,10 @@ TimelineView::addUserMessage(const QString &url,
                              uint64_t size,
                              const QSize &dimensions)
 {
+        // The echo belongs below the newest events, not below older ones scrolled back to.
+        if (isDetached_)
+                reattach();
+
         auto with_sender = (lastSender_ != local_user_) || isDateDifference(lastMsgTimestamp_);
         auto trimmed     = QFileInfo{filename}.fileName(); // Trim file path.
 
@@ -23,6 +23,8 @@
 
 #include "Cache.h"
 #include "Logging.h"
+#include "StartupProfile.h"
+#include "Utils.h"
 #include "timeline/TimelineView.h"
 #include "timeline/TimelineViewManager.h"
 #include "timeline/widgets/AudioItem.h"
@@ -39,7 +41,7 @@ TimelineViewManager::updateReadReceipts(const QString &room_id,
                                         const std::vector<QString> &event_ids)
 {
         if (timelineViewExists(room_id)) {
-                auto view = views_[room_id];
+                auto view = views_.at(room_id);
                 if (view)
                         emit view->markReadEvents(event_ids);
         }
@@ -48,10 +50,18 @@ TimelineViewManager::updateReadReceipts(const QString &room_id,
 void
 TimelineViewManager::removeTimelineEvent(const QString &room_id, const QString &event_id)
 {
-        auto view = views_[room_id];
+        if (timelineViewExists(room_id))
+                views_.at(room_id)->removeEvent(event_id);
+}
+
+void
+TimelineViewManager::retryDecryption(const QString &room_id,
+                                     const std::vector<std::string> &session_ids)
+{
+        if (!timelineViewExists(room_id))
+                return;
 
-        if (view)
-                view->removeEvent(event_id);
+        views_.at(room_id)->retryDecryption(session_ids);
 }
 
 void
@@ -61,7 +71,7 @@ TimelineViewManager::queueTextMessage(const QString &msg)
                 return;
 
         auto room_id = active_room_;
-        auto view    = views_[room_id];
+        auto view    = loadView(room_id);
 
         view->addUserMessage(mtx::events::MessageType::Text, msg);
 }
@@ -73,7 +83,7 @@ TimelineViewManager::queueEmoteMessage(const QString &msg)
                 return;
 
         auto room_id = active_room_;
-        auto view    = views_[room_id];
+        auto view    = loadView(room_id);
 
         view->addUserMessage(mtx::events::MessageType::Emote, msg);
 }
@@ -86,12 +96,12 @@ TimelineViewManager::queueImageMessage(const QString &roomid,
                                        uint64_t size,
                                        const QSize &dimensions)
 {
-        if (!timelineViewExists(roomid)) {
+        if (!roomExists(roomid)) {
                 nhlog::ui()->warn("Cannot send m.image message to a non-managed view");
                 return;
         }
 
-        auto view = views_[roomid];
+        auto view = loadView(roomid);
 
         view->addUserMessage<ImageItem, mtx::events::MessageType::Image>(
           url, filename, mime, size, dimensions);
@@ -104,12 +114,12 @@ TimelineViewManager::queueFileMessage(const QString &roomid,
                                       const QString &mime,
                                       uint64_t size)
 {
-        if (!timelineViewExists(roomid)) {
+        if (!roomExists(roomid)) {
                 nhlog::ui()->warn("cannot send m.file message to a non-managed view");
                 return;
         }
 
-        auto view = views_[roomid];
+        auto view = loadView(roomid);
 
         view->addUserMessage<FileItem, mtx::events::MessageType::File>(url, filename, mime, size);
 }
@@ -121,12 +131,12 @@ TimelineViewManager::queueAudioMessage(const QString &roomid,
                                        const QString &mime,
                                        uint64_t size)
 {
-        if (!timelineViewExists(roomid)) {
+        if (!roomExists(roomid)) {
                 nhlog::ui()->warn("cannot send m.audio message to a non-managed view");
                 return;
         }
 
-        auto view = views_[roomid];
+        auto view = loadView(roomid);
 
         view->addUserMessage<AudioItem, mtx::events::MessageType::Audio>(url, filename, mime, size);
 }
@@ -138,12 +148,12 @@ TimelineViewManager::queueVideoMessage(const QString &roomid,
                                        const QString &mime,
                                        uint64_t size)
 {
-        if (!timelineViewExists(roomid)) {
+        if (!roomExists(roomid)) {
                 nhlog::ui()->warn("cannot send m.video message to a non-managed view");
                 return;
         }
 
-        auto view = views_[roomid];
+        auto view = loadView(roomid);
 
         view->addUserMessage<VideoItem, mtx::events::MessageType::Video>(url, filename, mime, size);
 }
@@ -161,21 +171,12 @@ TimelineViewManager::initialize(const mtx::responses::Rooms &rooms)
 void
 TimelineViewManager::initWithMessages(const std::map<QString, mtx::responses::Timeline> &msgs)
 {
-        for (auto it = msgs.cbegin(); it != msgs.cend(); ++it) {
-                if (timelineViewExists(it->first))
-                        return;
-
-                // Create a history view with the room events.
-                TimelineView *view = new TimelineView(it->second, it->first);
-                views_.emplace(it->first, QSharedPointer<TimelineView>(view));
-
-                connect(view,
-                        &TimelineView::updateLastTimelineMessage,
-                        this,
-                        &TimelineViewManager::updateRoomsLastMessage);
+        startup::Span span("timeline registration");
 
-                // Add the view in the widget stack.
-                addWidget(view);
+        // The views are created when the rooms are opened. Their events are in the cache.
+        for (auto it = msgs.cbegin(); it != msgs.cend(); ++it) {
+                rooms_.insert(it->first);
+                updateLastMessage(it->first, it->second.events);
         }
 }
 
@@ -189,39 +190,16 @@ TimelineViewManager::initialize(const std::vector<std::string> &rooms)
 void
 TimelineViewManager::addRoom(const mtx::responses::JoinedRoom &room, const QString &room_id)
 {
-        if (timelineViewExists(room_id))
-                return;
-
-        // Create a history view with the room events.
-        TimelineView *view = new TimelineView(room.timeline, room_id);
-        views_.emplace(room_id, QSharedPointer<TimelineView>(view));
-
-        connect(view,
-                &TimelineView::updateLastTimelineMessage,
-                this,
-                &TimelineViewManager::updateRoomsLastMessage);
+        Q_UNUSED(room);
 
-        // Add the view in the widget stack.
-        addWidget(view);
+        // The timeline is stored along with the sync response and rendered on demand.
+        rooms_.insert(room_id);
 }
 
 void
 TimelineViewManager::addRoom(const QString &room_id)
 {
-        if (timelineViewExists(room_id))
-                return;
-
-        // Create a history view without any events.
-        TimelineView *view = new TimelineView(room_id);
-        views_.emplace(room_id, QSharedPointer<TimelineView>(view));
-
-        connect(view,
-                &TimelineView::updateLastTimelineMessage,
-                this,
-                &TimelineViewManager::updateRoomsLastMessage);
-
-        // Add the view in the widget stack.
-        addWidget(view);
+        rooms_.insert(room_id);
 }
 
 void
@@ -230,34 +208,143 @@ TimelineViewManager::sync(const mtx::responses::Rooms &rooms)
         for (const auto &room : rooms.join) {
                 auto roomid = QString::fromStdString(room.first);
 
-                if (!timelineViewExists(roomid)) {
+                if (!roomExists(roomid)) {
                         nhlog::ui()->warn("ignoring event from unknown room: {}",
                                           roomid.toStdString());
                         continue;
                 }
 
-                auto view = views_.at(roomid);
+                if (timelineViewExists(roomid)) {
+                        views_.at(roomid)->addEvents(room.second.timeline);
+                        continue;
+                }
 
-                view->addEvents(room.second.timeline);
+                // Rooms without a view only need their entry in the room list updated.
+                updateLastMessage(roomid, room.second.timeline.events);
         }
 }
 
 void
 TimelineViewManager::setHistoryView(const QString &room_id)
 {
-        if (!timelineViewExists(room_id)) {
+        if (!roomExists(room_id)) {
                 nhlog::ui()->warn("room from RoomList is not present in ViewManager: {}",
                                   room_id.toStdString());
                 return;
         }
 
         active_room_ = room_id;
-        auto view    = views_.at(room_id);
+        auto view    = loadView(room_id);
+
+        visited_.remove(room_id);
+        visited_.push_front(room_id);
 
         setCurrentWidget(view.data());
 
         view->fetchHistory();
         view->scrollDown();
+
+        unloadViews();
+}
+
+void
+TimelineViewManager::prefetchHistory(const QString &room_id)
+{
+        if (!roomExists(room_id) || room_id == active_room_)
+                return;
+
+        // Hovering over many rooms would otherwise keep a view for each of them. The views
+        // prefetched before are the first to go.
+        if (!timelineViewExists(room_id))
+                unloadViews();
+
+        loadView(room_id)->prefetch();
+}
+
+void
+TimelineViewManager::cancelPrefetch(const QString &room_id)
+{
+        if (!timelineViewExists(room_id) || room_id == active_room_)
+                return;
+
+        views_.at(room_id)->cancelPrefetch();
+}
+
+QSharedPointer<TimelineView>
+TimelineViewManager::loadView(const QString &room_id)
+{
+        if (timelineViewExists(room_id))
+                return views_.at(room_id);
+
+        // The view starts from the stored events.
+        auto view = QSharedPointer<TimelineView>(new TimelineView(room_id));
+        views_.emplace(room_id, view);
+
+        connect(view.data(),
+                &TimelineView::updateLastTimelineMessage,
+                this,
+                &TimelineViewManager::updateRoomsLastMessage);
+
+        // Add the view in the widget stack.
+        addWidget(view.data());
+
+        // Views that weren't opened are the first to go.
+        visited_.push_back(room_id);
+
+        nhlog::ui()->debug(
+          "[{}] loaded timeline ({} in memory)", room_id.toStdString(), views_.size());
+
+        return view;
+}
+
+void
+TimelineViewManager::unloadViews()
+{
+        std::size_t index   = 0;
+        std::size_t widgets = 0;
+
+        for (auto it = visited_.begin(); it != visited_.end(); ++index) {
+                const auto room_id = *it;
+                const auto view    = views_.at(room_id);
+
+                widgets += static_cast<std::size_t>(view->renderedItems());
+
+                const bool withinBudget =
+                  index < MAX_LOADED_TIMELINES && widgets <= MAX_LOADED_WIDGETS;
+
+                // Views waiting on the server are kept until their requests complete.
+                if (withinBudget || room_id == active_room_ || view->hasPendingRequests()) {
+                        ++it;
+                        continue;
+                }
+
+                it = visited_.erase(it);
+
+                removeWidget(view.data());
+                views_.erase(room_id);
+
+                nhlog::ui()->debug("[{}] unloaded timeline", room_id.toStdString());
+        }
+}
+
+void
+TimelineViewManager::updateLastMessage(
+  const QString &room_id,
+  const std::vector<mtx::events::collections::TimelineEvents> &events)
+{
+        if (events.empty())
+                return;
+
+        auto it = std::find_if(events.rbegin(), events.rend(), [](const auto &event) {
+                return (mtx::events::EventType::RoomMessage == utils::event_type(event)) ||
+                       (mtx::events::EventType::RoomEncrypted == utils::event_type(event));
+        });
+
+        const auto &event = (it == events.rend()) ? events.back() : *it;
+        const auto info   = utils::getMessageDescription(event, utils::localUser(), room_id);
+
+        if (!info.timestamp.isEmpty())
+                emit updateRoomsLastMessage(room_id, info);
 }
 
 QString
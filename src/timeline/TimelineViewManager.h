@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <list>
+#include <set>
+
 #include <QSharedPointer>
 #include <QStackedWidget>
 
@@ -45,7 +48,12 @@ public:
         void addRoom(const QString &room_id);
 
         void sync(const mtx::responses::Rooms &rooms);
-        void clearAll() { views_.clear(); }
+        void clearAll()
+        {
+                views_.clear();
+                rooms_.clear();
+                visited_.clear();
+        }
 
         // Check if all the timelines have been loaded.
         bool hasLoaded() const;
@@ -59,9 +67,15 @@ signals:
 public slots:
         void updateReadReceipts(const QString &room_id, const std::vector<QString> &event_ids);
         void removeTimelineEvent(const QString &room_id, const QString &event_id);
+        //! Decrypt again the events of the room that were waiting on the given sessions.
+        void retryDecryption(const QString &room_id, const std::vector<std::string> &session_ids);
         void initWithMessages(const std::map<QString, mtx::responses::Timeline> &msgs);
 
         void setHistoryView(const QString &room_id);
+        //! Fetch the first history page of a room the user is about to open.
+        void prefetchHistory(const QString &room_id);
+        //! Drop the history requested ahead for a room the user didn't open.
+        void cancelPrefetch(const QString &room_id);
         void queueTextMessage(const QString &msg);
         void queueEmoteMessage(const QString &msg);
         void queueImageMessage(const QString &roomid,
@@ -89,7 +103,26 @@ public slots:
 private:
         //! Check if the given room id is managed by a TimelineView.
         bool timelineViewExists(const QString &id) { return views_.find(id) != views_.end(); }
+        //! Check if the given room id is one of the joined rooms.
+        bool roomExists(const QString &id) { return rooms_.find(id) != rooms_.end(); }
+
+        //! Return the view of the room, creating it from the cache if needed.
+        QSharedPointer<TimelineView> loadView(const QString &room_id);
+        //! Release the least recently opened views that exceed the memory budget.
+        void unloadViews();
+        //! Update the room list preview of a room without a loaded view.
+        void updateLastMessage(const QString &room_id,
+                               const std::vector<mtx::events::collections::TimelineEvents> &events);
+
+        //! Maximum number of views kept alive.
+        static constexpr std::size_t MAX_LOADED_TIMELINES = 8;
+        //! Maximum number of timeline widgets kept alive across all the views.
+        static constexpr std::size_t MAX_LOADED_WIDGETS = 2000;
 
         QString active_room_;
         std::map<QString, QSharedPointer<TimelineView>> views_;
+        //! The joined rooms, whether their view is loaded or not.
+        std::set<QString> rooms_;
+        //! Loaded rooms ordered from the most recently opened.
+        std::list<QString> visited_;
 };
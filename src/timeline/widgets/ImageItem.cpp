@@ -21,6 +21,7 @@
 #include <QFileInfo>
 #include <QPainter>
 #include <QPixmap>
+#include <QPixmapCache>
 #include <QUuid>
 
 #include "Config.h"
@@ -127,8 +128,18 @@ ImageItem::sizeHint() const
 void
 ImageItem::setImage(const QPixmap &image)
 {
-        image_        = image;
-        scaled_image_ = utils::scaleDown(max_width_, max_height_, image_);
+        image_ = image;
+
+        // Items created again for the same image reuse its scaled copy.
+        const auto key =
+          QString("%1@%2x%3").arg(url_.toString()).arg(max_width_).arg(max_height_);
+
+        if (url_.isEmpty() || !QPixmapCache::find(key, &scaled_image_)) {
+                scaled_image_ = utils::scaleDown(max_width_, max_height_, image_);
+
+                if (!url_.isEmpty())
+                        QPixmapCache::insert(key, scaled_image_);
+        }
 
         width_  = scaled_image_.width();
         height_ = scaled_image_.height();
@@ -161,20 +172,6 @@ ImageItem::mousePressEvent(QMouseEvent *event)
         }
 }
 
-void
-ImageItem::resizeEvent(QResizeEvent *event)
-{
-        if (!image_)
-                return QWidget::resizeEvent(event);
-
-        scaled_image_ = utils::scaleDown(max_width_, max_height_, image_);
-
-        width_  = scaled_image_.width();
-        height_ = scaled_image_.height();
-
-        setFixedSize(width_, height_);
-}
-
 void
 ImageItem::paintEvent(QPaintEvent *event)
 {
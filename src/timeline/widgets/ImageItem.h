@@ -51,7 +51,6 @@ public slots:
 protected:
         void paintEvent(QPaintEvent *event) override;
         void mousePressEvent(QMouseEvent *event) override;
-        void resizeEvent(QResizeEvent *event) override;
 
         //! Whether the user can interact with the displayed image.
         bool isInteractive_ = true;
@@ -3,10 +3,17 @@
 #include <QAbstractTextDocumentLayout>
 #include <QDesktopServices>
 #include <QEvent>
+#include <QPaintEvent>
+#include <QResizeEvent>
 #include <QWheelEvent>
 
 #include "Utils.h"
 
+//! The text is wrapped at multiples of this width, so small resizes don't lay it out again.
+constexpr int WIDTH_BUCKET = 8;
+//! Wrapping width until the label gets its geometry.
+constexpr int INITIAL_WIDTH = 1000;
+
 bool
 ContextMenuFilter::eventFilter(QObject *obj, QEvent *event)
 {
@@ -27,6 +34,10 @@ TextLabel::TextLabel(const QString &text, QWidget *parent)
 {
         document()->setDefaultStyleSheet(QString("a {color: %1; }").arg(utils::linkColor()));
 
+        // Wrap at a fixed width that follows the widget in steps.
+        setLineWrapMode(QTextEdit::FixedPixelWidth);
+        setLineWrapColumnOrWidth(INITIAL_WIDTH);
+
         setText(text);
         setOpenExternalLinks(true);
 
@@ -38,7 +49,6 @@ TextLabel::TextLabel(const QString &text, QWidget *parent)
         setPalette(pal);
 
         // Wrap anywhere but prefer words, adjust minimum height on the fly.
-        setLineWrapMode(QTextEdit::WidgetWidth);
         setWordWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
         connect(document()->documentLayout(),
                 &QAbstractTextDocumentLayout::documentSizeChanged,
@@ -58,6 +68,65 @@ TextLabel::TextLabel(const QString &text, QWidget *parent)
         });
 }
 
+void
+TextLabel::adjustHeight(const QSizeF &size)
+{
+        if (layoutWidth_ != -1)
+                heights_[layoutWidth_] = size.height();
+
+        setFixedHeight(size.height());
+}
+
+void
+TextLabel::relayout(int width)
+{
+        layoutWidth_   = width;
+        pendingLayout_ = false;
+
+        setLineWrapColumnOrWidth(width);
+}
+
+void
+TextLabel::resizeEvent(QResizeEvent *e)
+{
+        QTextBrowser::resizeEvent(e);
+
+        // Only the width affects the layout of the text.
+        if (e->size().width() == e->oldSize().width())
+                return;
+
+        const int width = std::max(e->size().width() - e->size().width() % WIDTH_BUCKET, 1);
+
+        if (width == layoutWidth_) {
+                pendingLayout_ = false;
+                return;
+        }
+
+        // The first geometry replaces the initial width right away, so the height is right
+        // from the start. Later changes of labels out of sight wait until they are painted.
+        // Their height is kept right if they were already laid out at the new width.
+        if (layoutWidth_ != -1 && visibleRegion().isEmpty()) {
+                pendingLayout_ = true;
+
+                auto height = heights_.constFind(width);
+                if (height != heights_.constEnd())
+                        setFixedHeight(height.value());
+
+                return;
+        }
+
+        relayout(width);
+}
+
+void
+TextLabel::paintEvent(QPaintEvent *e)
+{
+        if (pendingLayout_)
+                relayout(std::max(width() - width() % WIDTH_BUCKET, 1));
+
+        QTextBrowser::paintEvent(e);
+}
+
 void
 TextLabel::focusOutEvent(QFocusEvent *e)
 {
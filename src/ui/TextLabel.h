@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include <QSize>
 #include <QString>
 #include <QTextBrowser>
@@ -7,6 +8,8 @@
 
 class QMouseEvent;
 class QFocusEvent;
+class QPaintEvent;
+class QResizeEvent;
 class QWheelEvent;
 
 class ContextMenuFilter : public QObject
@@ -40,9 +43,11 @@ protected:
         void mousePressEvent(QMouseEvent *e) override;
         void mouseReleaseEvent(QMouseEvent *e) override;
         void focusOutEvent(QFocusEvent *e) override;
+        void resizeEvent(QResizeEvent *e) override;
+        void paintEvent(QPaintEvent *e) override;
 
 private slots:
-        void adjustHeight(const QSizeF &size) { setFixedHeight(size.height()); }
+        void adjustHeight(const QSizeF &size);
         void handleLinkActivation(const QUrl &link);
 
 signals:
@@ -50,6 +55,16 @@ signals:
         void linkActivated(const QUrl &link);
 
 private:
+        //! Lay the text out again for the given wrapping width.
+        void relayout(int width);
+
         QString link_;
         bool contextMenuRequested_ = false;
+
+        //! Width the text is wrapped at, rounded down to a multiple of the width bucket.
+        int layoutWidth_ = -1;
+        //! The width changed while the label was out of sight.
+        bool pendingLayout_ = false;
+        //! Height of the text for each wrapping width it was laid out at.
+        QHash<int, int> heights_;
 };